@@ -14,9 +14,12 @@
 // Key behaviors:
 //  - Web “manual setpoint” is separate from Modbus SP registers
 //  - PID parameters EN/KP/KI/KD mirror Modbus writes into runtime config
-//  - PID mode (direct/reverse), LED sources, button actions are Web-only + persisted
+//  - PID mode (direct/reverse), setpoint weight, D filter, feed-forward,
+//    LED sources, button actions are Web-only + persisted
 //  - Cascade: PID outputs can feed other PID setpoints
 //  - RTD configuration + diagnostics are Web-only (no Modbus map changes)
+//  - PID: fixed-period executor on core1 (owns the control DAC writes)
+//  - AI: non-blocking ADS1115 scan, per-channel data rate + oversampling (Web-only, persisted)
 //  - Web traffic is throttled so Modbus stays responsive
 // ------------------------------------------------------------
 
@@ -33,6 +36,10 @@
 #include <utility>
 #include <math.h>
 #include "hardware/watchdog.h"
+#include "hardware/sync.h"
+#include "pico/time.h"
+#include "pico/mutex.h"
+#include "src/pid_law.h"   // PID types + control law (host-tested)
 
 // ================== UART2 (RS-485 / Modbus) ==================
 #define TX2   4
@@ -71,11 +78,49 @@ bool ads_ok     = false;
 bool dac_ok[2]  = {false, false};
 bool rtd_ok[2]  = {false, false};
 
+// Wire1 (ADS1115 + both MCP4725) is used from core0 (AI scan, manual AO) and
+// core1 (PID outputs); every transaction holds wire1Mtx.
+mutex_t wire1Mtx;
+struct Wire1Lock {
+  Wire1Lock()  { mutex_enter_blocking(&wire1Mtx); }
+  ~Wire1Lock() { mutex_exit(&wire1Mtx); }
+};
+
 // ================== ADC field scaling ==================
 #define ADC_FIELD_SCALE_NUM 30303
 #define ADC_FIELD_SCALE_DEN 10000
 #define ADC_FIELD_SCALE ((float)ADC_FIELD_SCALE_NUM / (float)ADC_FIELD_SCALE_DEN)
 
+// ================== ADS1115 acquisition (non-blocking) ==================
+// One conversion in flight: requestADC() -> wait for OS bit (or ALERT/RDY) -> getValue().
+// Channels are scanned round-robin; a channel publishes after aiOsr[ch] conversions.
+#define ADS_ALERT_PIN  -1                      // GPIO wired to ALERT/RDY, -1 = poll config register
+
+static const uint8_t  AI_RATE_DEFAULT = 7;     // ADS1115 DR index 0..7
+static const uint8_t  AI_OSR_DEFAULT  = 4;
+static const uint8_t  AI_OSR_MAX      = 16;
+static const uint8_t  AI_RING_SIZE    = 32;    // recent published samples per input (power of two)
+static const uint16_t ADS_SPS[8] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+
+uint8_t  aiRate[4] = { AI_RATE_DEFAULT, AI_RATE_DEFAULT, AI_RATE_DEFAULT, AI_RATE_DEFAULT };
+uint8_t  aiOsr[4]  = { AI_OSR_DEFAULT,  AI_OSR_DEFAULT,  AI_OSR_DEFAULT,  AI_OSR_DEFAULT  };
+
+uint16_t aiRing[4][AI_RING_SIZE];
+uint8_t  aiRingHead[4]  = {0,0,0,0};
+uint8_t  aiRingCount[4] = {0,0,0,0};
+uint32_t aiSampleCnt[4] = {0,0,0,0};           // published samples (for rate stats)
+
+uint8_t  adsCh       = 0;
+bool     adsBusy     = false;
+uint32_t adsStartUs  = 0;
+int32_t  adsAcc      = 0;
+uint8_t  adsAccN     = 0;
+uint32_t adsTimeouts = 0;
+#if ADS_ALERT_PIN >= 0
+volatile bool adsRdy = false;
+void adsRdyIsr() { adsRdy = true; }
+#endif
+
 // ================== Runtime state ==================
 bool buttonState[NUM_BTN] = {false,false,false,false};
 bool buttonPrev[NUM_BTN]  = {false,false,false,false};
@@ -93,6 +138,19 @@ float    rtdRatio[2]     = {0, 0};     // ratio rtd/rref (approx)
 float    rtdOhms[2]      = {0, 0};     // computed RTD resistance
 float    rtdTempC[2]     = {0, 0};     // computed temperature in °C
 
+// ===== RTD engine (auto-convert) =====
+// Both MAX31865 run continuously (VBIAS on, auto-convert, ~20 ms/conversion).
+// One burst read of registers 0x00..0x07 per cycle feeds temperature AND
+// diagnostics, so nothing ever waits for a one-shot conversion.
+#define RTD_FILTER_50HZ  1                     // 1 = 50 Hz mains rejection, 0 = 60 Hz
+static const uint8_t MAX31865_CFG_BIAS   = 0x80;
+static const uint8_t MAX31865_CFG_AUTO   = 0x40;
+static const uint8_t MAX31865_CFG_3WIRE  = 0x10;
+static const uint8_t MAX31865_CFG_FCLEAR = 0x02;
+static const uint8_t MAX31865_CFG_50HZ   = 0x01;
+uint8_t  rtdCfgReg[2]    = {0, 0};     // config byte we expect to read back
+uint8_t  rtdRegs[2][8];                // last register snapshot per RTD
+
 // ===== RTD configuration (Web-only, persisted) =====
 uint8_t  rtdWiresCfg[2]    = {2, 2};
 uint16_t rtdRnominalCfg[2] = {100, 100};
@@ -100,6 +158,18 @@ uint16_t rtdRrefCfg[2]     = {200, 200};
 
 uint16_t dacRaw[2] = {0,0};
 
+// ===== AO output stage (core1) =====
+// writeDac() only posts a target; dacService() on core1 applies the optional slew
+// limit and sends a 2-byte MCP4725 fast-write only when the code changes, so
+// several updates within a cycle collapse into one bus transaction.
+static const uint8_t  DAC_ADDR[2]     = { 0x60, 0x61 };
+static const uint32_t DAC_SERVICE_US  = 2000;          // slew stepping interval
+volatile uint16_t dacTarget[2]  = {0, 0};
+volatile uint16_t dacSlew[2]    = {0, 0};              // codes/s, 0 = immediate (Web-only, persisted)
+volatile uint32_t dacWrites[2]  = {0, 0};              // bus transactions actually sent
+float    dacPos[2]     = {0, 0};                       // slewed position (core1)
+uint16_t dacWritten[2] = {0xFFFF, 0xFFFF};             // last code on the wire (core1)
+
 // ================== Web Serial ==================
 SimpleWebSerial WebSerial;
 JSONVar modbusStatus;
@@ -112,8 +182,11 @@ const unsigned long sendInterval   = 1000;
 unsigned long lastSensorRead = 0;
 const unsigned long sensorInterval = 200;
 
-unsigned long lastPidUpdateMs = 0;
-const unsigned long pidIntervalMs = 200;
+// PID executor period (Web-only, persisted)
+static const uint16_t PID_PERIOD_MS_DEFAULT = 200;
+static const uint16_t PID_PERIOD_MS_MIN     = 10;
+static const uint16_t PID_PERIOD_MS_MAX     = 1000;
+volatile uint16_t pidPeriodMs = PID_PERIOD_MS_DEFAULT;
 
 // FIX B: RTD full info only every 2 seconds
 unsigned long lastRtdInfoSend = 0;
@@ -145,43 +218,78 @@ enum : uint16_t {
   HREG_PID_PVVAL_BASE = 390,
   HREG_PID_ERR_BASE   = 400,
 
-  HREG_MBPV_BASE      = 410   // 410..413 = MBPV1..MBPV4
-};
+  HREG_MBPV_BASE      = 410,  // 410..413 = MBPV1..MBPV4
 
-// ================== PID state ==================
-struct PIDState {
-  bool    enabled;
-  uint8_t pvSource;     // 0 none, 1..4 AI1..4(mV), 5 RTD1, 6 RTD2, 7..10 MBPV1..MBPV4
-  uint8_t spSource;     // 0 manual (Web), 1..4 SP1..SP4(Modbus), 5..8 PID1..PID4 OUT
-  uint8_t outTarget;    // 0 none, 1 AO1, 2 AO2, 3 virtual-only
-  uint8_t mode;         // 0 direct, 1 reverse (Web-only persisted)
-
-  float   Kp;
-  float   Ki;
-  float   Kd;
-
-  float   integral;
-  float   prevError;
-  float   output;       // RAW output (0..4095)
-
-  float   pvMin;
-  float   pvMax;
-  float   outMin;
-  float   outMax;
-
-  float   pvPct;
-  float   spPct;
-  float   outPct;
+  // PID executor timing (read-only)
+  HREG_PID_PERIOD_MS   = 420,
+  HREG_PID_JITTER_US   = 421,  // start lateness of the last cycle
+  HREG_PID_JITTER_MAX  = 422,
+  HREG_PID_EXEC_MAX_US = 423,
+  HREG_PID_OVERRUNS    = 424   // cycles that started a full period late
 };
 
+// ================== PID state ==================
+// PIDState (config, core0) and PidRt (runtime, core1) are in src/pid_law.h.
 PIDState pid[4];
+PidRt    pidRt[4];
 
+// core0 view of the last cycle (mirrored from pidOut)
 float pidVirtRaw[4] = {0,0,0,0};
 float pidVirtPct[4] = {0,0,0,0};
+float pidPvPct[4]   = {0,0,0,0};
+float pidSpPct[4]   = {0,0,0,0};
+float pidOutPct[4]  = {0,0,0,0};
 
 // ===== Manual setpoints (Web only), per PID (NOT Modbus) =====
 int16_t pidManualSp[4] = {0,0,0,0};
 
+// ===== core0 <-> core1 exchange (seqlock: writer bumps seq to odd, copies, bumps to even) =====
+template <class T> struct SeqSnap {
+  volatile uint32_t seq = 0;
+  T v;
+  void put(const T& x) { seq = seq + 1; __dmb(); v = x; __dmb(); seq = seq + 1; }
+  void get(T& x) {
+    uint32_t s0;
+    do { do { s0 = seq; } while (s0 & 1); __dmb(); x = v; __dmb(); } while (seq != s0);
+  }
+};
+
+struct PidInputs {            // published by core0 every loop pass
+  uint16_t aiMv[4];
+  int16_t  rtdX10[2];
+  uint16_t mbpv[4];
+  int16_t  mbSp[4];
+  int16_t  manualSp[4];
+  uint16_t dacRaw[2];         // applied AO codes, for the bumpless start
+};
+struct PidOutputs {           // published by core1 every cycle
+  uint32_t cycle;
+  bool     active[4];
+  float    pvRaw[4];
+  float    errPct[4];
+  float    outRaw[4];
+  float    pvPct[4];
+  float    spPct[4];
+  float    outPct[4];
+  float    virtRaw[4];
+  float    virtPct[4];
+};
+struct PidCfgSet {            // published by core0 every loop pass, copied once per cycle by core1
+  PIDState p[4];
+};
+SeqSnap<PidInputs>  pidIn;
+SeqSnap<PidOutputs> pidOut;
+SeqSnap<PidCfgSet>  pidCfg;
+
+// Integrator reset: core0 bumps pidResetReq[i], core1 clears the loop state when
+// it sees a value different from pidRt[i].resetSeen. One writer per word.
+volatile uint32_t pidResetReq[4] = {0,0,0,0};
+
+volatile bool     pidExecRun      = false;   // set at the end of setup()
+volatile bool     pidStatsResetReq = false;
+volatile uint32_t pidCycles = 0, pidOverruns = 0;
+volatile uint32_t pidJitterUs = 0, pidJitterMaxUs = 0, pidExecMaxUs = 0;
+
 // ================== LED source selection (Web-only, persisted) ==================
 enum : uint8_t {
   LEDSRC_MANUAL = 0,
@@ -248,11 +356,23 @@ struct PersistConfig {
   uint16_t rtd_rnominal[2];
   uint16_t rtd_rref[2];
 
+  uint8_t  ai_rate[4];
+  uint8_t  ai_osr[4];
+
+  uint16_t pid_period_ms;
+
+  uint16_t dac_slew[2];
+
+  uint16_t pid_beta_x100[4];     // same units as the Web "pid" message
+  uint16_t pid_dtf_ms[4];
+  uint8_t  pid_ff_src[4];
+  int16_t  pid_ff_gain_x100[4];
+
   uint32_t crc32;
 } __attribute__((packed));
 
 static const uint32_t CFG_MAGIC   = 0x314F4941UL;
-static const uint16_t CFG_VERSION = 0x0007;
+static const uint16_t CFG_VERSION = 0x000B;
 static const char*    CFG_PATH    = "/cfg.bin";
 
 volatile bool  cfgDirty        = false;
@@ -319,6 +439,17 @@ static void sanitizeRtdCfg() {
   }
 }
 
+static void aiCfgDefaults() {
+  for (int i=0;i<4;i++) { aiRate[i] = AI_RATE_DEFAULT; aiOsr[i] = AI_OSR_DEFAULT; }
+}
+
+static void sanitizeAiCfg() {
+  for (int i=0;i<4;i++) {
+    if (aiRate[i] > 7) aiRate[i] = AI_RATE_DEFAULT;
+    if (aiOsr[i] < 1 || aiOsr[i] > AI_OSR_MAX) aiOsr[i] = AI_OSR_DEFAULT;
+  }
+}
+
 bool getLedAutoState(uint8_t src) {
   if (src >= LEDSRC_PID1_EN && src <= LEDSRC_PID4_EN) {
     uint8_t i = src - LEDSRC_PID1_EN;
@@ -364,6 +495,9 @@ void setDefaults() {
   rtdRrefCfg[0]     = 200;
   rtdRrefCfg[1]     = 200;
   sanitizeRtdCfg();
+  aiCfgDefaults();
+  pidPeriodMs = PID_PERIOD_MS_DEFAULT;
+  dacSlew[0] = dacSlew[1] = 0;
 
   rtdFault[0] = rtdFault[1] = 0;
   rtdError[0] = rtdError[1] = "";
@@ -398,6 +532,21 @@ void captureToPersist(PersistConfig &pc) {
   pc.rtd_rref[0]     = rtdRrefCfg[0];
   pc.rtd_rref[1]     = rtdRrefCfg[1];
 
+  for (int i=0;i<4;i++) {
+    pc.ai_rate[i] = aiRate[i];
+    pc.ai_osr[i]  = aiOsr[i];
+  }
+  pc.pid_period_ms = pidPeriodMs;
+  pc.dac_slew[0]   = dacSlew[0];
+  pc.dac_slew[1]   = dacSlew[1];
+
+  for (int i=0;i<4;i++) {
+    pc.pid_beta_x100[i]    = (uint16_t)lroundf(pid[i].beta * 100.0f);
+    pc.pid_dtf_ms[i]       = (uint16_t)lroundf(pid[i].dTf * 1000.0f);
+    pc.pid_ff_src[i]       = pid[i].ffSource;
+    pc.pid_ff_gain_x100[i] = (int16_t)constrain(lroundf(pid[i].ffGain * 100.0f), -32768L, 32767L);
+  }
+
   pc.crc32 = 0;
   pc.crc32 = crc32_update(0, (const uint8_t*)&pc, sizeof(PersistConfig));
 }
@@ -433,6 +582,9 @@ bool applyFromPersist_v2(const uint8_t* buf, size_t len) {
   rtdRnominalCfg[0]=100; rtdRnominalCfg[1]=100;
   rtdRrefCfg[0]=200; rtdRrefCfg[1]=200;
   sanitizeRtdCfg();
+  aiCfgDefaults();
+  pidPeriodMs = PID_PERIOD_MS_DEFAULT;
+  dacSlew[0] = dacSlew[1] = 0;
   return true;
 }
 
@@ -466,6 +618,9 @@ bool applyFromPersist_v3(const uint8_t* buf, size_t len) {
   rtdRnominalCfg[0]=100; rtdRnominalCfg[1]=100;
   rtdRrefCfg[0]=200; rtdRrefCfg[1]=200;
   sanitizeRtdCfg();
+  aiCfgDefaults();
+  pidPeriodMs = PID_PERIOD_MS_DEFAULT;
+  dacSlew[0] = dacSlew[1] = 0;
   return true;
 }
 
@@ -500,6 +655,9 @@ bool applyFromPersist_v4(const uint8_t* buf, size_t len) {
   rtdRnominalCfg[0]=100; rtdRnominalCfg[1]=100;
   rtdRrefCfg[0]=200; rtdRrefCfg[1]=200;
   sanitizeRtdCfg();
+  aiCfgDefaults();
+  pidPeriodMs = PID_PERIOD_MS_DEFAULT;
+  dacSlew[0] = dacSlew[1] = 0;
   return true;
 }
 
@@ -534,6 +692,176 @@ bool applyFromPersist_v5(const uint8_t* buf, size_t len) {
   rtdRnominalCfg[0]=100; rtdRnominalCfg[1]=100;
   rtdRrefCfg[0]=200; rtdRrefCfg[1]=200;
   sanitizeRtdCfg();
+  aiCfgDefaults();
+  pidPeriodMs = PID_PERIOD_MS_DEFAULT;
+  dacSlew[0] = dacSlew[1] = 0;
+  return true;
+}
+
+bool applyFromPersist_v7(const uint8_t* buf, size_t len) {
+  struct PersistConfigV7 {
+    uint32_t magic; uint16_t version; uint16_t size;
+    uint16_t dacRaw[2]; uint8_t mb_address; uint32_t mb_baud;
+    uint8_t  pid_mode[4]; int16_t  pid_manual_sp[4];
+    uint8_t  led_src[4]; uint8_t  btn_action[4];
+    uint8_t  rtd_wires[2]; uint16_t rtd_rnominal[2]; uint16_t rtd_rref[2];
+    uint32_t crc32;
+  } __attribute__((packed));
+
+  if (len != sizeof(PersistConfigV7)) return false;
+  PersistConfigV7 pc{}; memcpy(&pc, buf, sizeof(pc));
+
+  if (pc.magic != CFG_MAGIC || pc.size != sizeof(PersistConfigV7)) return false;
+  uint32_t crc = pc.crc32; pc.crc32 = 0;
+  if (crc32_update(0, (const uint8_t*)&pc, sizeof(PersistConfigV7)) != crc) return false;
+  if (pc.version != 0x0007) return false;
+
+  dacRaw[0] = pc.dacRaw[0]; dacRaw[1] = pc.dacRaw[1];
+  g_mb_address = pc.mb_address; g_mb_baud = pc.mb_baud;
+
+  for (int i=0;i<4;i++) {
+    pid[i].mode = clamp_u8((int)pc.pid_mode[i], 0, 1);
+    pidManualSp[i] = pc.pid_manual_sp[i];
+    ledSrc[i] = clamp_u8((int)pc.led_src[i], 0, 16);
+    btnAction[i] = clamp_u8((int)pc.btn_action[i], 0, 8);
+  }
+
+  rtdWiresCfg[0]=pc.rtd_wires[0]; rtdWiresCfg[1]=pc.rtd_wires[1];
+  rtdRnominalCfg[0]=pc.rtd_rnominal[0]; rtdRnominalCfg[1]=pc.rtd_rnominal[1];
+  rtdRrefCfg[0]=pc.rtd_rref[0]; rtdRrefCfg[1]=pc.rtd_rref[1];
+  sanitizeRtdCfg();
+  aiCfgDefaults();
+  pidPeriodMs = PID_PERIOD_MS_DEFAULT;
+  dacSlew[0] = dacSlew[1] = 0;
+  return true;
+}
+
+bool applyFromPersist_v8(const uint8_t* buf, size_t len) {
+  struct PersistConfigV8 {
+    uint32_t magic; uint16_t version; uint16_t size;
+    uint16_t dacRaw[2]; uint8_t mb_address; uint32_t mb_baud;
+    uint8_t  pid_mode[4]; int16_t  pid_manual_sp[4];
+    uint8_t  led_src[4]; uint8_t  btn_action[4];
+    uint8_t  rtd_wires[2]; uint16_t rtd_rnominal[2]; uint16_t rtd_rref[2];
+    uint8_t  ai_rate[4]; uint8_t ai_osr[4];
+    uint32_t crc32;
+  } __attribute__((packed));
+
+  if (len != sizeof(PersistConfigV8)) return false;
+  PersistConfigV8 pc{}; memcpy(&pc, buf, sizeof(pc));
+
+  if (pc.magic != CFG_MAGIC || pc.size != sizeof(PersistConfigV8)) return false;
+  uint32_t crc = pc.crc32; pc.crc32 = 0;
+  if (crc32_update(0, (const uint8_t*)&pc, sizeof(PersistConfigV8)) != crc) return false;
+  if (pc.version != 0x0008) return false;
+
+  dacRaw[0] = pc.dacRaw[0]; dacRaw[1] = pc.dacRaw[1];
+  g_mb_address = pc.mb_address; g_mb_baud = pc.mb_baud;
+
+  for (int i=0;i<4;i++) {
+    pid[i].mode = clamp_u8((int)pc.pid_mode[i], 0, 1);
+    pidManualSp[i] = pc.pid_manual_sp[i];
+    ledSrc[i] = clamp_u8((int)pc.led_src[i], 0, 16);
+    btnAction[i] = clamp_u8((int)pc.btn_action[i], 0, 8);
+    aiRate[i] = pc.ai_rate[i];
+    aiOsr[i]  = pc.ai_osr[i];
+  }
+
+  rtdWiresCfg[0]=pc.rtd_wires[0]; rtdWiresCfg[1]=pc.rtd_wires[1];
+  rtdRnominalCfg[0]=pc.rtd_rnominal[0]; rtdRnominalCfg[1]=pc.rtd_rnominal[1];
+  rtdRrefCfg[0]=pc.rtd_rref[0]; rtdRrefCfg[1]=pc.rtd_rref[1];
+  sanitizeRtdCfg();
+  sanitizeAiCfg();
+  pidPeriodMs = PID_PERIOD_MS_DEFAULT;
+  dacSlew[0] = dacSlew[1] = 0;
+  return true;
+}
+
+bool applyFromPersist_v9(const uint8_t* buf, size_t len) {
+  struct PersistConfigV9 {
+    uint32_t magic; uint16_t version; uint16_t size;
+    uint16_t dacRaw[2]; uint8_t mb_address; uint32_t mb_baud;
+    uint8_t  pid_mode[4]; int16_t  pid_manual_sp[4];
+    uint8_t  led_src[4]; uint8_t  btn_action[4];
+    uint8_t  rtd_wires[2]; uint16_t rtd_rnominal[2]; uint16_t rtd_rref[2];
+    uint8_t  ai_rate[4]; uint8_t ai_osr[4];
+    uint16_t pid_period_ms;
+    uint32_t crc32;
+  } __attribute__((packed));
+
+  if (len != sizeof(PersistConfigV9)) return false;
+  PersistConfigV9 pc{}; memcpy(&pc, buf, sizeof(pc));
+
+  if (pc.magic != CFG_MAGIC || pc.size != sizeof(PersistConfigV9)) return false;
+  uint32_t crc = pc.crc32; pc.crc32 = 0;
+  if (crc32_update(0, (const uint8_t*)&pc, sizeof(PersistConfigV9)) != crc) return false;
+  if (pc.version != 0x0009) return false;
+
+  dacRaw[0] = pc.dacRaw[0]; dacRaw[1] = pc.dacRaw[1];
+  g_mb_address = pc.mb_address; g_mb_baud = pc.mb_baud;
+
+  for (int i=0;i<4;i++) {
+    pid[i].mode = clamp_u8((int)pc.pid_mode[i], 0, 1);
+    pidManualSp[i] = pc.pid_manual_sp[i];
+    ledSrc[i] = clamp_u8((int)pc.led_src[i], 0, 16);
+    btnAction[i] = clamp_u8((int)pc.btn_action[i], 0, 8);
+    aiRate[i] = pc.ai_rate[i];
+    aiOsr[i]  = pc.ai_osr[i];
+  }
+
+  rtdWiresCfg[0]=pc.rtd_wires[0]; rtdWiresCfg[1]=pc.rtd_wires[1];
+  rtdRnominalCfg[0]=pc.rtd_rnominal[0]; rtdRnominalCfg[1]=pc.rtd_rnominal[1];
+  rtdRrefCfg[0]=pc.rtd_rref[0]; rtdRrefCfg[1]=pc.rtd_rref[1];
+  sanitizeRtdCfg();
+  sanitizeAiCfg();
+  pidPeriodMs = (pc.pid_period_ms >= PID_PERIOD_MS_MIN && pc.pid_period_ms <= PID_PERIOD_MS_MAX)
+              ? pc.pid_period_ms : PID_PERIOD_MS_DEFAULT;
+  dacSlew[0] = dacSlew[1] = 0;
+  return true;
+}
+
+bool applyFromPersist_v10(const uint8_t* buf, size_t len) {
+  struct PersistConfigV10 {
+    uint32_t magic; uint16_t version; uint16_t size;
+    uint16_t dacRaw[2]; uint8_t mb_address; uint32_t mb_baud;
+    uint8_t  pid_mode[4]; int16_t  pid_manual_sp[4];
+    uint8_t  led_src[4]; uint8_t  btn_action[4];
+    uint8_t  rtd_wires[2]; uint16_t rtd_rnominal[2]; uint16_t rtd_rref[2];
+    uint8_t  ai_rate[4]; uint8_t ai_osr[4];
+    uint16_t pid_period_ms;
+    uint16_t dac_slew[2];
+    uint32_t crc32;
+  } __attribute__((packed));
+
+  if (len != sizeof(PersistConfigV10)) return false;
+  PersistConfigV10 pc{}; memcpy(&pc, buf, sizeof(pc));
+
+  if (pc.magic != CFG_MAGIC || pc.size != sizeof(PersistConfigV10)) return false;
+  uint32_t crc = pc.crc32; pc.crc32 = 0;
+  if (crc32_update(0, (const uint8_t*)&pc, sizeof(PersistConfigV10)) != crc) return false;
+  if (pc.version != 0x000A) return false;
+
+  dacRaw[0] = pc.dacRaw[0]; dacRaw[1] = pc.dacRaw[1];
+  g_mb_address = pc.mb_address; g_mb_baud = pc.mb_baud;
+
+  for (int i=0;i<4;i++) {
+    pid[i].mode = clamp_u8((int)pc.pid_mode[i], 0, 1);
+    pidManualSp[i] = pc.pid_manual_sp[i];
+    ledSrc[i] = clamp_u8((int)pc.led_src[i], 0, 16);
+    btnAction[i] = clamp_u8((int)pc.btn_action[i], 0, 8);
+    aiRate[i] = pc.ai_rate[i];
+    aiOsr[i]  = pc.ai_osr[i];
+  }
+
+  rtdWiresCfg[0]=pc.rtd_wires[0]; rtdWiresCfg[1]=pc.rtd_wires[1];
+  rtdRnominalCfg[0]=pc.rtd_rnominal[0]; rtdRnominalCfg[1]=pc.rtd_rnominal[1];
+  rtdRrefCfg[0]=pc.rtd_rref[0]; rtdRrefCfg[1]=pc.rtd_rref[1];
+  sanitizeRtdCfg();
+  sanitizeAiCfg();
+  pidPeriodMs = (pc.pid_period_ms >= PID_PERIOD_MS_MIN && pc.pid_period_ms <= PID_PERIOD_MS_MAX)
+              ? pc.pid_period_ms : PID_PERIOD_MS_DEFAULT;
+  dacSlew[0] = pc.dac_slew[0]; dacSlew[1] = pc.dac_slew[1];
+  // beta / D filter / feed-forward keep their setup() defaults
   return true;
 }
 
@@ -565,6 +893,25 @@ bool applyFromPersist(const PersistConfig &pc) {
   rtdRrefCfg[1]     = pc.rtd_rref[1];
   sanitizeRtdCfg();
 
+  for (int i=0;i<4;i++) {
+    aiRate[i] = pc.ai_rate[i];
+    aiOsr[i]  = pc.ai_osr[i];
+  }
+  sanitizeAiCfg();
+
+  pidPeriodMs = (pc.pid_period_ms >= PID_PERIOD_MS_MIN && pc.pid_period_ms <= PID_PERIOD_MS_MAX)
+              ? pc.pid_period_ms : PID_PERIOD_MS_DEFAULT;
+
+  dacSlew[0] = pc.dac_slew[0];
+  dacSlew[1] = pc.dac_slew[1];
+
+  for (int i=0;i<4;i++) {
+    pid[i].beta     = (float)clamp_u16((int)pc.pid_beta_x100[i], 0, 100) / 100.0f;
+    pid[i].dTf      = (float)clamp_u16((int)pc.pid_dtf_ms[i], 0, 60000) / 1000.0f;
+    pid[i].ffSource = clamp_u8((int)pc.pid_ff_src[i], 0, 4);
+    pid[i].ffGain   = (float)pc.pid_ff_gain_x100[i] / 100.0f;
+  }
+
   return true;
 }
 
@@ -627,6 +974,10 @@ bool loadConfigFS() {
   f.close();
   if (n != sz) { WebSerial.send("message", "load: short read"); return false; }
 
+  if (applyFromPersist_v10(buf, sz)) return true;
+  if (applyFromPersist_v9(buf, sz)) return true;
+  if (applyFromPersist_v8(buf, sz)) return true;
+  if (applyFromPersist_v7(buf, sz)) return true;
   if (applyFromPersist_v5(buf, sz)) return true;
   if (applyFromPersist_v4(buf, sz)) return true;
   if (applyFromPersist_v3(buf, sz)) return true;
@@ -689,18 +1040,26 @@ void handlePidMode(JSONVar obj);
 void handleLedCfg(JSONVar obj);
 void handleBtnCfg(JSONVar obj);
 void handleRtdCfg(JSONVar obj);
+void handleAiCfg(JSONVar obj);
 
 void performReset();
 void sendAllEchoesOnce();
 void sendPidSnapshot();
 void writeDac(int idx, uint16_t value);
+void dacService(bool force);
 void readSensors();
-void updatePids();
+void adsService();
+void adsStart();
+void aiPublish(uint8_t ch, int16_t raw);
+void sendAiSamples(int ch);
+void pidStep(float dt);
+void pidPublishInputs();
+void pidMirrorOutputs();
 void applyRtdHardwareCfg();
-void updateRtdDiagnostics();   // FIX C
+void rtdPoll(uint8_t i);
 
-float getPidPvValue(uint8_t src, bool &ok);
-float getPidSpValue(uint8_t pidIndex, uint8_t src, bool &ok);
+float getPidPvValue(const PidInputs &in, uint8_t src, bool &ok);
+float getPidSpValue(const PidInputs &in, const float* virtRaw, uint8_t pidIndex, uint8_t src, bool &ok);
 
 // ================== Command handler / reset ==================
 void handleCommand(JSONVar obj) {
@@ -728,6 +1087,13 @@ void handleCommand(JSONVar obj) {
     } else {
       WebSerial.send("message", "ERROR: Load failed/invalid");
     }
+  } else if (act == "pid_stats_reset") {
+    pidStatsResetReq = true;
+    WebSerial.send("message", "PID timing statistics reset");
+  } else if (act == "ai_samples") {
+    int ch = obj.hasOwnProperty("ch") ? (int)obj["ch"] : 1;
+    if (ch < 1 || ch > 4) { WebSerial.send("message", "ai_samples: invalid 'ch' (1..4)"); return; }
+    sendAiSamples(ch - 1);
   } else if (act == "factory") {
     setDefaults();
     if (saveConfigFS()) {
@@ -768,10 +1134,21 @@ void handleValues(JSONVar values) {
 
 void handleDac(JSONVar obj) {
   JSONVar list = obj["list"];
-  if (JSON.typeof(list) != "array") return;
+  JSONVar slew = obj["slew"];      // codes/s per AO, 0 = immediate
 
   uint32_t now = millis();
 
+  if (JSON.typeof(slew) == "array") {
+    for (int i = 0; i < 2 && i < (int)slew.length(); i++) {
+      long v = constrain((long)slew[i], 0L, 65535L);
+      dacSlew[i] = (uint16_t)v;
+    }
+    cfgDirty       = true;
+    lastCfgTouchMs = now;
+    WebSerial.send("message", "AO slew limits updated");
+  }
+  if (JSON.typeof(list) != "array") return;
+
   for (int i = 0; i < 2 && i < (int)list.length(); i++) {
     long v = (long)list[i];
     v = constrain(v, 0L, 4095L);
@@ -824,6 +1201,28 @@ void handleRtdCfg(JSONVar obj) {
   lastCfgTouchMs = millis();
 }
 
+// ===== AI acquisition config (Web-only, persisted) =====
+// { "rate":[0..7 ×4], "osr":[1..16 ×4] } – rate is the ADS1115 DR index (8..860 SPS)
+void handleAiCfg(JSONVar obj) {
+  JSONVar rate = obj["rate"];
+  JSONVar osr  = obj["osr"];
+
+  if (JSON.typeof(rate) == "array") {
+    for (int i=0;i<4 && i<(int)rate.length();i++) aiRate[i] = clamp_u8((int)rate[i], 0, 7);
+  }
+  if (JSON.typeof(osr) == "array") {
+    for (int i=0;i<4 && i<(int)osr.length();i++) aiOsr[i] = clamp_u8((int)osr[i], 1, AI_OSR_MAX);
+  }
+  sanitizeAiCfg();
+
+  // restart the current channel so the new rate/OSR applies immediately
+  adsBusy = false; adsAcc = 0; adsAccN = 0;
+
+  WebSerial.send("message", "AI acquisition configuration updated");
+  cfgDirty = true;
+  lastCfgTouchMs = millis();
+}
+
 void handlePid(JSONVar obj) {
   JSONVar sp     = obj["sp"];
   JSONVar en     = obj["en"];
@@ -838,6 +1237,16 @@ void handlePid(JSONVar obj) {
   JSONVar pvMax  = obj["pv_max"];
   JSONVar outMin = obj["out_min"];
   JSONVar outMax = obj["out_max"];
+  JSONVar period = obj["period_ms"];
+  JSONVar beta   = obj["beta"];      // x100
+  JSONVar dTf    = obj["d_tf"];      // ms
+  JSONVar ffSrc  = obj["ff_src"];
+  JSONVar ffGain = obj["ff_gain"];   // x100
+
+  if (JSON.typeof(period) == "number") {
+    int v = (int)period;
+    pidPeriodMs = clamp_u16(v, PID_PERIOD_MS_MIN, PID_PERIOD_MS_MAX);
+  }
 
   for (int i = 0; i < 4; i++) {
     PIDState &p = pid[i];
@@ -888,6 +1297,11 @@ void handlePid(JSONVar obj) {
     if (JSON.typeof(pvMax) == "array" && i < (int)pvMax.length()) p.pvMax = (float)((double)pvMax[i]);
     if (JSON.typeof(outMin)== "array" && i < (int)outMin.length()) p.outMin = (float)((double)outMin[i]);
     if (JSON.typeof(outMax)== "array" && i < (int)outMax.length()) p.outMax = (float)((double)outMax[i]);
+
+    if (JSON.typeof(beta) == "array" && i < (int)beta.length())   p.beta = (float)clamp_u16((int)beta[i], 0, 100) / 100.0f;
+    if (JSON.typeof(dTf) == "array" && i < (int)dTf.length())     p.dTf  = (float)clamp_u16((int)dTf[i], 0, 60000) / 1000.0f;
+    if (JSON.typeof(ffSrc) == "array" && i < (int)ffSrc.length()) p.ffSource = clamp_u8((int)ffSrc[i], 0, 4);
+    if (JSON.typeof(ffGain)== "array" && i < (int)ffGain.length()) p.ffGain = (float)((int16_t)((int)ffGain[i])) / 100.0f;
   }
 
   WebSerial.send("message", "PID configuration updated via WebSerial");
@@ -950,9 +1364,100 @@ void handleBtnCfg(JSONVar obj) {
 }
 
 // ================== DAC write helper ==================
+// Safe from either core: just posts the target code for dacService().
 void writeDac(int idx, uint16_t value) {
-  if (idx == 0 && dac_ok[0]) dac0.setVoltage(value, false);
-  else if (idx == 1 && dac_ok[1]) dac1.setVoltage(value, false);
+  if (idx < 0 || idx > 1) return;
+  dacTarget[idx] = (value > 4095) ? 4095 : value;
+}
+
+// core1: slew toward the targets and fast-write changed codes.
+void dacService(bool force) {
+  static uint64_t lastUs = 0;
+  uint64_t t = time_us_64();
+  if (!force && lastUs && (t - lastUs) < DAC_SERVICE_US) return;
+  float dt = lastUs ? (float)(t - lastUs) / 1e6f : 0.0f;
+  lastUs = t;
+
+  for (int ch=0; ch<2; ch++) {
+    const float tgt = (float)dacTarget[ch];
+    const uint16_t slew = dacSlew[ch];
+    if (slew == 0 || dacWritten[ch] == 0xFFFF) {
+      dacPos[ch] = tgt;
+    } else {
+      float step = (float)slew * dt;
+      if (dacPos[ch] < tgt)      dacPos[ch] = min(dacPos[ch] + step, tgt);
+      else if (dacPos[ch] > tgt) dacPos[ch] = max(dacPos[ch] - step, tgt);
+    }
+    uint16_t code = (uint16_t)lroundf(dacPos[ch]);
+    if (code == dacWritten[ch] || !dac_ok[ch]) continue;
+
+    // MCP4725 fast write: [0 0 PD1 PD0 D11..D8][D7..D0]
+    Wire1Lock lk;
+    Wire1.beginTransmission(DAC_ADDR[ch]);
+    Wire1.write((uint8_t)((code >> 8) & 0x0F));
+    Wire1.write((uint8_t)(code & 0xFF));
+    if (Wire1.endTransmission() == 0) {
+      dacWritten[ch] = code;
+      dacWrites[ch] = dacWrites[ch] + 1;
+    }
+  }
+}
+
+// ================== MAX31865 register access (soft-SPI, mode 1) ==================
+// The Adafruit driver only exposes blocking one-shot reads, so the snapshot is
+// clocked out directly on the same pins (~0.2 ms per device).
+static uint8_t rtdSpiXfer(uint8_t out) {
+  uint8_t in = 0;
+  for (int b=7;b>=0;b--) {
+    digitalWrite(RTD_DI, (out >> b) & 1);
+    digitalWrite(RTD_CLK, HIGH);
+    digitalWrite(RTD_CLK, LOW);
+    in = (uint8_t)((in << 1) | (digitalRead(RTD_DO) ? 1 : 0));
+  }
+  return in;
+}
+
+static void rtdReadRegs(uint8_t idx, uint8_t addr, uint8_t* buf, uint8_t n) {
+  const uint8_t cs = idx ? RTD2_CS : RTD1_CS;
+  digitalWrite(RTD_CLK, LOW);
+  digitalWrite(cs, LOW);
+  rtdSpiXfer(addr & 0x7F);
+  for (uint8_t k=0;k<n;k++) buf[k] = rtdSpiXfer(0xFF);
+  digitalWrite(cs, HIGH);
+}
+
+static void rtdWriteReg(uint8_t idx, uint8_t addr, uint8_t v) {
+  const uint8_t cs = idx ? RTD2_CS : RTD1_CS;
+  digitalWrite(RTD_CLK, LOW);
+  digitalWrite(cs, LOW);
+  rtdSpiXfer(addr | 0x80);
+  rtdSpiXfer(v);
+  digitalWrite(cs, HIGH);
+}
+
+// Reads one register snapshot and derives temperature + diagnostics from it.
+void rtdPoll(uint8_t i) {
+  static Adafruit_MAX31865* const rtds[2] = { &rtd1, &rtd2 };
+  uint8_t* r = rtdRegs[i];
+  rtdReadRegs(i, 0x00, r, 8);
+
+  uint8_t fault = r[7];
+  if ((r[0] & ~MAX31865_CFG_FCLEAR) != rtdCfgReg[i]) fault = 0xFF;   // lost / not answering
+
+  if (fault != rtdFault[i]) rtdError[i] = decodeMax31865Fault(fault);
+  rtdFault[i] = fault;
+  if (fault == 0xFF) {
+    rtdRawCode[i] = 0; rtdRatio[i] = 0; rtdOhms[i] = 0;
+    return;
+  }
+  if (fault) rtdWriteReg(i, 0x00, rtdCfgReg[i] | MAX31865_CFG_FCLEAR);
+
+  uint16_t raw = (uint16_t)((((uint16_t)r[1] << 8) | r[2]) >> 1);
+  float rref = (float)rtdRrefCfg[i];
+  rtdRawCode[i] = raw;
+  rtdRatio[i]   = raw / 32768.0f;
+  rtdOhms[i]    = rtdRatio[i] * rref;
+  rtdTempC[i]   = rtds[i]->calculateTemperature(raw, (float)rtdRnominalCfg[i], rref);
 }
 
 // ================== Apply RTD hardware config (wire mode) ==================
@@ -960,9 +1465,17 @@ void applyRtdHardwareCfg() {
   Adafruit_MAX31865* rtds[2] = { &rtd1, &rtd2 };
   for (int i=0;i<2;i++) {
     bool ok = rtds[i]->begin(wiresToEnum(rtdWiresCfg[i]));
+    if (ok) {
+      rtdCfgReg[i] = MAX31865_CFG_BIAS | MAX31865_CFG_AUTO |
+                     (rtdWiresCfg[i] == 3 ? MAX31865_CFG_3WIRE : 0) |
+                     (RTD_FILTER_50HZ ? MAX31865_CFG_50HZ : 0);
+      rtdWriteReg(i, 0x00, rtdCfgReg[i] | MAX31865_CFG_FCLEAR);
+      uint8_t back = 0;
+      rtdReadRegs(i, 0x00, &back, 1);
+      ok = ((back & ~MAX31865_CFG_FCLEAR) == rtdCfgReg[i]);   // begin() can't detect a missing chip
+    }
     rtd_ok[i] = ok;
     if (ok) {
-      rtds[i]->clearFault();
       WebSerial.send("message", String("MAX31865 RTD") + (i+1) + " configured: " +
         String(rtdWiresCfg[i]) + "wire, " + String(rtdRnominalCfg[i]) + "ohm, Rref " + String(rtdRrefCfg[i]) + "ohm");
     } else {
@@ -971,55 +1484,86 @@ void applyRtdHardwareCfg() {
   }
 }
 
-// ================== FIX C: update RTD diagnostics only every rtdInfoInterval ==================
-void updateRtdDiagnostics() {
-  Adafruit_MAX31865* rtds[2] = { &rtd1, &rtd2 };
+// ================== ADS1115 scheduler ==================
+void adsStart() {
+  ads.setDataRate(aiRate[adsCh]);
+#if ADS_ALERT_PIN >= 0
+  adsRdy = false;
+#endif
+  {
+    Wire1Lock lk;
+    ads.requestADC(adsCh);
+  }
+  adsStartUs = micros();
+  adsBusy = true;
+}
 
-  for (int i=0;i<2;i++) {
-    if (!rtd_ok[i]) {
-      rtdFault[i]    = 0xFF;
-      rtdError[i]    = decodeMax31865Fault(rtdFault[i]);
-      rtdRawCode[i]  = 0;
-      rtdRatio[i]    = 0;
-      rtdOhms[i]     = 0;
-      // temp already maintained in readSensors()
-      continue;
-    }
+void aiPublish(uint8_t ch, int16_t raw) {
+  aiRaw[ch] = raw;
 
-    uint16_t raw = rtds[i]->readRTD();
-    rtdRawCode[i] = raw;
+  float v_adc   = ads.toVoltage(raw);
+  float v_field = v_adc * ADC_FIELD_SCALE;
+  long  mv      = lroundf(v_field * 1000.0f);
 
-    float rref = (float)rtdRrefCfg[i];
-    float ratio = (raw / 32768.0f);
-    rtdRatio[i] = ratio;
-    rtdOhms[i]  = ratio * rref;
+  if (mv < 0)      mv = 0;
+  if (mv > 65535)  mv = 65535;
 
-    uint8_t f = rtds[i]->readFault();
-    rtdFault[i] = f;
-    rtdError[i] = decodeMax31865Fault(f);
+  aiMv[ch] = (uint16_t)mv;
+  mb.Hreg(HREG_AI_MV_BASE + ch, aiMv[ch]);
 
-    if (f) rtds[i]->clearFault();
-  }
+  aiRing[ch][aiRingHead[ch]] = aiMv[ch];
+  aiRingHead[ch] = (uint8_t)((aiRingHead[ch] + 1) & (AI_RING_SIZE - 1));
+  if (aiRingCount[ch] < AI_RING_SIZE) aiRingCount[ch]++;
+  aiSampleCnt[ch]++;
 }
 
-// ================== Sensor read helper ==================
-void readSensors() {
-  if (ads_ok) {
-    for (int ch=0; ch<4; ch++) {
-      int16_t raw = ads.readADC(ch);
-      aiRaw[ch] = raw;
+// Called every loop pass; costs one short I2C transaction at most.
+void adsService() {
+  if (!ads_ok) return;
+  if (!adsBusy) { adsStart(); return; }
+
+  uint32_t el     = micros() - adsStartUs;
+  uint32_t convUs = 1000000UL / ADS_SPS[aiRate[adsCh]];
+#if ADS_ALERT_PIN >= 0
+  bool ready = adsRdy;
+#else
+  bool ready = false;
+  if (el >= convUs) {                            // don't poll before the conversion can be done
+    Wire1Lock lk;
+    ready = ads.isReady();
+  }
+#endif
+  if (!ready) {
+    if (el > 2 * convUs + 5000) { adsTimeouts++; adsBusy = false; adsAcc = 0; adsAccN = 0; }
+    return;
+  }
 
-      float v_adc   = ads.toVoltage(raw);
-      float v_field = v_adc * ADC_FIELD_SCALE;
-      long  mv      = lroundf(v_field * 1000.0f);
+  {
+    Wire1Lock lk;
+    adsAcc += ads.getValue();
+  }
+  if (++adsAccN >= aiOsr[adsCh]) {
+    aiPublish(adsCh, (int16_t)(adsAcc / adsAccN));
+    adsAcc = 0; adsAccN = 0;
+    adsCh = (uint8_t)((adsCh + 1) & 3);
+  }
+  adsStart();
+}
 
-      if (mv < 0)      mv = 0;
-      if (mv > 65535)  mv = 65535;
+void sendAiSamples(int ch) {
+  JSONVar o, mv;
+  uint8_t n = aiRingCount[ch];
+  uint8_t start = (uint8_t)((aiRingHead[ch] - n) & (AI_RING_SIZE - 1));
+  for (uint8_t k=0;k<n;k++) mv[k] = (int)aiRing[ch][(start + k) & (AI_RING_SIZE - 1)];   // oldest first
+  o["ch"] = ch + 1;
+  o["mv"] = mv;
+  WebSerial.send("aiSamples", o);
+}
 
-      aiMv[ch] = (uint16_t)mv;
-      mb.Hreg(HREG_AI_MV_BASE + ch, aiMv[ch]);
-    }
-  } else {
+// ================== Sensor read helper ==================
+// AI is handled by adsService(); this only samples the RTDs.
+void readSensors() {
+  if (!ads_ok) {
     for (int ch=0; ch<4; ch++) {
       aiRaw[ch] = 0;
       aiMv[ch]  = 0;
@@ -1027,109 +1571,187 @@ void readSensors() {
     }
   }
 
-  // FAST RTD temperature only (avoid readRTD here)
-  Adafruit_MAX31865* rtds[2] = { &rtd1, &rtd2 };
+  // RTD: one cached register snapshot per device (auto-convert keeps it fresh)
   for (int i=0;i<2;i++) {
-    if (!rtd_ok[i]) {
+    if (rtd_ok[i]) rtdPoll((uint8_t)i);
+    if (!rtd_ok[i] || rtdFault[i] == 0xFF) {
+      if (!rtd_ok[i]) { rtdFault[i] = 0xFF; rtdError[i] = decodeMax31865Fault(0xFF); }
       rtdTemp_x10[i] = 0;
       rtdTempC[i]    = 0;
       mb.Hreg(HREG_TEMP_BASE + i, 0);
       continue;
     }
 
-    float rnom = (float)rtdRnominalCfg[i];
-    float rref = (float)rtdRrefCfg[i];
-    float temp = rtds[i]->temperature(rnom, rref);
-    rtdTempC[i] = temp;
-
-    int16_t t10 = (int16_t)lroundf(temp * 10.0f);
+    int16_t t10 = (int16_t)lroundf(rtdTempC[i] * 10.0f);
     rtdTemp_x10[i] = t10;
     mb.Hreg(HREG_TEMP_BASE + i, (uint16_t)t10);
   }
 }
 
 // ================== PID helpers ==================
-float getPidPvValue(uint8_t src, bool &ok) {
+float getPidPvValue(const PidInputs &in, uint8_t src, bool &ok) {
   ok = false;
   if (src >= 1 && src <= 4) {
     uint8_t idx = src - 1;
     ok = true;
-    return (float)((int32_t)aiMv[idx]);
+    return (float)((int32_t)in.aiMv[idx]);
   } else if (src == 5) {
     ok = true;
-    return (float)rtdTemp_x10[0];
+    return (float)in.rtdX10[0];
   } else if (src == 6) {
     ok = true;
-    return (float)rtdTemp_x10[1];
+    return (float)in.rtdX10[1];
   } else if (src >= 7 && src <= 10) {
     uint8_t idx = src - 7;
     ok = true;
-    return (float)((int32_t)(uint16_t)mb.Hreg(HREG_MBPV_BASE + idx));
+    return (float)((int32_t)in.mbpv[idx]);
   }
   return 0.0f;
 }
 
-float getPidSpValue(uint8_t pidIndex, uint8_t src, bool &ok) {
+float getPidSpValue(const PidInputs &in, const float* virtRaw, uint8_t pidIndex, uint8_t src, bool &ok) {
   ok = false;
 
   if (src == 0) {
     ok = true;
-    return (float)pidManualSp[pidIndex];
+    return (float)in.manualSp[pidIndex];
   } else if (src >= 1 && src <= 4) {
     uint8_t idx = src - 1;
-    int16_t raw = (int16_t)mb.Hreg(HREG_SP_BASE + idx);
     ok = true;
-    return (float)raw;
+    return (float)in.mbSp[idx];
   } else if (src >= 5 && src <= 8) {
     uint8_t idx = src - 5;
     ok = true;
-    return pidVirtRaw[idx];
+    return virtRaw[idx];
   }
   return 0.0f;
 }
 
-// ================== PID update (2-pass for PID->PID SP stability) ==================
-void updatePids() {
-  unsigned long now = millis();
-  if (now - lastPidUpdateMs < pidIntervalMs) return;
+// ================== PID executor (core1) ==================
+// core1 runs all four loops against absolute deadlines every pidPeriodMs, so I2C
+// and WebSerial work on core0 does not shift the cycle. LittleFS does: every
+// flash program/erase (config save) parks core1 via idleOtherCore(), and a
+// cycle due in that window starts late. HREG 421/422 record the start
+// lateness (last/max), 423 the execution time and 424 the cycles that slipped
+// a whole period (those run with the real elapsed dt). PV/SP/applied AO come
+// from the pidIn snapshot and the loop config from pidCfg (both copied once per
+// cycle), results go back through pidOut and core0 mirrors them into Modbus;
+// the control DAC writes happen here. core1 never writes pid[].
+void pidPublishInputs() {
+  PidInputs in;
+  for (int i=0;i<4;i++) {
+    in.aiMv[i]     = aiMv[i];
+    in.mbpv[i]     = (uint16_t)mb.Hreg(HREG_MBPV_BASE + i);
+    in.mbSp[i]     = (int16_t)mb.Hreg(HREG_SP_BASE + i);
+    in.manualSp[i] = pidManualSp[i];
+  }
+  in.rtdX10[0] = rtdTemp_x10[0];
+  in.rtdX10[1] = rtdTemp_x10[1];
+  in.dacRaw[0] = dacRaw[0];
+  in.dacRaw[1] = dacRaw[1];
+  pidIn.put(in);
 
-  float dt = (now - lastPidUpdateMs) / 1000.0f;
-  if (dt <= 0.0f) dt = pidIntervalMs / 1000.0f;
-  lastPidUpdateMs = now;
+  PidCfgSet c;
+  for (int i=0;i<4;i++) {
+    PIDState &p = pid[i];
+    if (p.pvMax <= p.pvMin)   { p.pvMin = 0.0f; p.pvMax = 10000.0f; }
+    if (p.outMax <= p.outMin) { p.outMin = 0.0f; p.outMax = 4095.0f; }
+    c.p[i] = p;
+  }
+  pidCfg.put(c);
+}
+
+// core0: ask core1 to clear loop i's integrator/derivative state on its next cycle
+void pidRequestReset(int i) {
+  pidResetReq[i] = pidResetReq[i] + 1;
+}
 
-  float newOutRaw[4] = { pidVirtRaw[0], pidVirtRaw[1], pidVirtRaw[2], pidVirtRaw[3] };
-  float newOutPct[4] = { pidVirtPct[0], pidVirtPct[1], pidVirtPct[2], pidVirtPct[3] };
+// core0: copy the latest cycle's results into Modbus / dacRaw
+void pidMirrorOutputs() {
+  static uint32_t lastCycle = 0;
+  PidOutputs o;
+  pidOut.get(o);
+
+  if (o.cycle != lastCycle) {
+    lastCycle = o.cycle;
+    for (int i=0;i<4;i++) {
+      pidVirtRaw[i] = o.virtRaw[i];
+      pidVirtPct[i] = o.virtPct[i];
+      pidPvPct[i]   = o.pvPct[i];
+      pidSpPct[i]   = o.spPct[i];
+      pidOutPct[i]  = o.outPct[i];
+      mb.Hreg(HREG_PID_PVVAL_BASE + i, (uint16_t)lroundf(o.pvRaw[i]));
+      if (!o.active[i]) {
+        mb.Hreg(HREG_PID_OUT_BASE + i, 0);
+        mb.Hreg(HREG_PID_ERR_BASE + i, 0);
+        continue;
+      }
+      mb.Hreg(HREG_PID_ERR_BASE + i, (uint16_t)lroundf(o.errPct[i]));
+      mb.Hreg(HREG_PID_OUT_BASE + i, (uint16_t)lroundf(o.outRaw[i]));
+      uint8_t tgt = pid[i].outTarget;
+      if (tgt == 1 || tgt == 2) {
+        int ch = tgt - 1;
+        dacRaw[ch] = (uint16_t)lroundf(o.outRaw[i]);
+        mb.Hreg(HREG_DAC_BASE + ch, dacRaw[ch]);
+      }
+    }
+  }
+
+  auto sat16 = [](uint32_t v) -> uint16_t { return v > 65535UL ? 65535 : (uint16_t)v; };
+  mb.Hreg(HREG_PID_PERIOD_MS,   pidPeriodMs);
+  mb.Hreg(HREG_PID_JITTER_US,   sat16(pidJitterUs));
+  mb.Hreg(HREG_PID_JITTER_MAX,  sat16(pidJitterMaxUs));
+  mb.Hreg(HREG_PID_EXEC_MAX_US, sat16(pidExecMaxUs));
+  mb.Hreg(HREG_PID_OVERRUNS,    sat16(pidOverruns));
+}
+
+// One control cycle, in pidEvalOrder(). Runs on core1; the per-loop law is pidLawStep().
+void pidStep(float dt) {
+  static float virtRaw[4] = {0,0,0,0}, virtPct[4] = {0,0,0,0};   // core1-private
+  static PidCfgSet c;
+  pidCfg.get(c);
+  PidInputs in;
+  pidIn.get(in);
+  PidOutputs o;
+
+  float newOutRaw[4] = { virtRaw[0], virtRaw[1], virtRaw[2], virtRaw[3] };
+  float newOutPct[4] = { virtPct[0], virtPct[1], virtPct[2], virtPct[3] };
 
   bool active[4] = { false, false, false, false };
 
-  for (int i = 0; i < 4; i++) {
-    PIDState &p = pid[i];
+  uint8_t order[4];
+  pidEvalOrder(c.p, order);
+
+  for (int k = 0; k < 4; k++) {
+    const int i = order[k];
+    const PIDState &p = c.p[i];
+    PidRt &r = pidRt[i];
+
+    uint32_t rq = pidResetReq[i];
+    if (rq != r.resetSeen) {
+      r.resetSeen = rq;
+      pidRtClear(r);
+    }
 
     bool  pvOk   = false;
     bool  spOk   = false;
-    float pvRaw  = getPidPvValue(p.pvSource, pvOk);
-    float spRaw  = getPidSpValue((uint8_t)i, p.spSource, spOk);
-
-    if (p.pvMax <= p.pvMin) { p.pvMin = 0.0f; p.pvMax = 10000.0f; }
-    if (p.outMax <= p.outMin) { p.outMin = 0.0f; p.outMax = 4095.0f; }
+    float pvRaw  = getPidPvValue(in, p.pvSource, pvOk);
+    float spRaw  = getPidSpValue(in, newOutRaw, (uint8_t)i, p.spSource, spOk);
 
-    mb.Hreg(HREG_PID_PVVAL_BASE + i, (uint16_t)lroundf(pvRaw));
+    o.pvRaw[i]  = pvRaw;
+    o.errPct[i] = 0.0f;
+    o.outRaw[i] = 0.0f;
+    o.pvPct[i]  = 0.0f;
+    o.spPct[i]  = 0.0f;
+    o.outPct[i] = 0.0f;
 
     active[i] = (p.enabled && pvOk && spOk);
 
     if (!active[i]) {
-      p.integral  = 0.0f;
-      p.prevError = 0.0f;
-      p.output    = 0.0f;
-      p.pvPct     = 0.0f;
-      p.spPct     = 0.0f;
-      p.outPct    = 0.0f;
+      pidRtClear(r);
 
       newOutRaw[i] = 0.0f;
       newOutPct[i] = 0.0f;
-
-      mb.Hreg(HREG_PID_OUT_BASE + i, 0);
-      mb.Hreg(HREG_PID_ERR_BASE + i, 0);
       continue;
     }
 
@@ -1139,72 +1761,93 @@ void updatePids() {
     pvPct = constrain(pvPct, 0.0f, 100.0f);
     spPct = constrain(spPct, 0.0f, 100.0f);
 
-    float errorPct = spPct - pvPct;
-    if (p.mode == 1) errorPct = -errorPct;
-
-    // publish error
-    mb.Hreg(HREG_PID_ERR_BASE + i, (uint16_t)lroundf(errorPct));
-
-    float derivPct = (dt > 0.0f) ? ((errorPct - p.prevError) / dt) : 0.0f;
-
-    float pd = p.Kp * errorPct + p.Kd * derivPct;
-
-    float uPct_unclamped = pd + p.integral;
-    float uPct_clamped   = constrain(uPct_unclamped, 0.0f, 100.0f);
-
-    bool saturated_low  = (uPct_unclamped <= 0.0f);
-    bool saturated_high = (uPct_unclamped >= 100.0f);
-
-    bool allow_integrate =
-        (!saturated_low && !saturated_high) ||
-        (saturated_low  && (errorPct > 0.0f)) ||
-        (saturated_high && (errorPct < 0.0f));
-
-    if (allow_integrate) {
-      p.integral += errorPct * dt * p.Ki;
-      p.integral = constrain(p.integral, -100.0f, 100.0f);
-      uPct_unclamped = pd + p.integral;
-      uPct_clamped   = constrain(uPct_unclamped, 0.0f, 100.0f);
-    }
+    float outSpan = (p.outMax - p.outMin);
+    if (outSpan < 1.0f) outSpan = 1.0f;
 
-    p.prevError = errorPct;
+    // feed-forward
+    float ffPct = 0.0f;
+    if (p.ffSource >= 1 && p.ffSource <= 4) ffPct = p.ffGain * (float)in.mbpv[p.ffSource - 1] / 100.0f;
 
-    float uPct = uPct_clamped;
+    // output currently applied, for a bumpless manual -> auto start
+    float uPrev = newOutPct[i];
+    if (!r.wasActive && (p.outTarget == 1 || p.outTarget == 2))
+      uPrev = ((float)in.dacRaw[p.outTarget - 1] - p.outMin) * 100.0f / outSpan;
 
-    float outSpan = (p.outMax - p.outMin);
-    if (outSpan < 1.0f) outSpan = 1.0f;
+    float errorPct = 0.0f;
+    const float uPct = pidLawStep(p, r, pvPct, spPct, ffPct, uPrev, dt, errorPct);
+    o.errPct[i] = errorPct;
 
     float outRawF = p.outMin + (uPct / 100.0f) * outSpan;
     outRawF = constrain(outRawF, 0.0f, 4095.0f);
 
-    p.output = outRawF;
-    p.pvPct  = pvPct;
-    p.spPct  = spPct;
-    p.outPct = uPct;
+    o.pvPct[i]  = pvPct;
+    o.spPct[i]  = spPct;
+    o.outPct[i] = uPct;
 
     newOutRaw[i] = outRawF;
     newOutPct[i] = uPct;
-
-    mb.Hreg(HREG_PID_OUT_BASE + i, (uint16_t)lroundf(outRawF));
+    o.outRaw[i]  = outRawF;
   }
 
   for (int i=0;i<4;i++) {
-    pidVirtRaw[i] = newOutRaw[i];
-    pidVirtPct[i] = newOutPct[i];
+    virtRaw[i]    = newOutRaw[i];
+    virtPct[i]    = newOutPct[i];
+    o.virtRaw[i]  = virtRaw[i];
+    o.virtPct[i]  = virtPct[i];
   }
 
-  // write AO only for active PIDs
+  // write AO only for active PIDs (dacRaw/Modbus mirror is done by core0)
   for (int i = 0; i < 4; i++) {
+    o.active[i] = active[i];
     if (!active[i]) continue;
-    PIDState &p = pid[i];
+    const PIDState &p = c.p[i];
     if (p.outTarget == 1 || p.outTarget == 2) {
       int ch = p.outTarget - 1;
-      uint16_t val = (uint16_t)lroundf(pidVirtRaw[i]);
-      dacRaw[ch] = val;
-      mb.Hreg(HREG_DAC_BASE + ch, dacRaw[ch]);
-      writeDac(ch, dacRaw[ch]);
+      writeDac(ch, (uint16_t)lroundf(virtRaw[i]));
     }
   }
+
+  o.cycle = pidCycles + 1;
+  pidOut.put(o);
+  pidCycles = o.cycle;
+}
+
+void setup1() {}
+
+void loop1() {
+  static uint64_t nextUs = 0, lastUs = 0;
+  if (!pidExecRun) return;
+
+  dacService(false);
+
+  if (pidStatsResetReq) {
+    pidStatsResetReq = false;
+    pidJitterMaxUs = 0; pidExecMaxUs = 0; pidOverruns = 0;
+  }
+
+  const uint64_t periodUs = (uint64_t)pidPeriodMs * 1000ULL;
+  uint64_t t = time_us_64();
+  if (nextUs == 0) { nextUs = t + periodUs; lastUs = t; return; }
+  if ((int64_t)(nextUs - t) > 0) return;                 // busy-wait: core1 has nothing else to do
+
+  uint64_t late = t - nextUs;
+  float dt = (float)periodUs / 1e6f;
+  if (late >= periodUs) {                                // missed a whole period: resync, use real dt
+    pidOverruns = pidOverruns + 1;
+    dt = (float)(t - lastUs) / 1e6f;
+    nextUs = t + periodUs;
+  } else {
+    nextUs += periodUs;
+  }
+  lastUs = t;
+  pidJitterUs = (uint32_t)late;
+  if (pidJitterUs > pidJitterMaxUs) pidJitterMaxUs = pidJitterUs;
+
+  pidStep(dt);
+  dacService(true);                                      // push this cycle's outputs now
+
+  uint32_t exec = (uint32_t)(time_us_64() - t);
+  if (exec > pidExecMaxUs) pidExecMaxUs = exec;
 }
 
 // ================== PID snapshot helper ==================
@@ -1215,6 +1858,7 @@ void sendPidSnapshot() {
   JSONVar pvPctArr, spPctArr, outPctArr;
   JSONVar modeArr;
   JSONVar virtRawArr, virtPctArr;
+  JSONVar betaArr, dTfArr, ffSrcArr, ffGainArr;
 
   for (int i = 0; i < 4; i++) {
     int16_t spShow = 0;
@@ -1243,12 +1887,17 @@ void sendPidSnapshot() {
     outMinArr[i]  = pid[i].outMin;
     outMaxArr[i]  = pid[i].outMax;
 
-    pvPctArr[i]   = pid[i].pvPct;
-    spPctArr[i]   = pid[i].spPct;
-    outPctArr[i]  = pid[i].outPct;
+    pvPctArr[i]   = pidPvPct[i];
+    spPctArr[i]   = pidSpPct[i];
+    outPctArr[i]  = pidOutPct[i];
 
     virtRawArr[i] = pidVirtRaw[i];
     virtPctArr[i] = pidVirtPct[i];
+
+    betaArr[i]    = (int)lroundf(pid[i].beta * 100.0f);
+    dTfArr[i]     = (int)lroundf(pid[i].dTf * 1000.0f);
+    ffSrcArr[i]   = (int)pid[i].ffSource;
+    ffGainArr[i]  = (int)lroundf(pid[i].ffGain * 100.0f);
   }
 
   pidObj["sp"]       = spArr;
@@ -1274,12 +1923,27 @@ void sendPidSnapshot() {
   pidObj["virt_raw"] = virtRawArr;
   pidObj["virt_pct"] = virtPctArr;
 
+  pidObj["beta"]     = betaArr;
+  pidObj["d_tf"]     = dTfArr;
+  pidObj["ff_src"]   = ffSrcArr;
+  pidObj["ff_gain"]  = ffGainArr;
+
+  pidObj["period_ms"] = (int)pidPeriodMs;
+  JSONVar timing;
+  timing["cycles"]      = (double)pidCycles;
+  timing["jitter_us"]   = (double)pidJitterUs;
+  timing["jitter_max"]  = (double)pidJitterMaxUs;
+  timing["exec_max_us"] = (double)pidExecMaxUs;
+  timing["overruns"]    = (double)pidOverruns;
+  pidObj["timing"] = timing;
+
   WebSerial.send("pidState", pidObj);
 }
 
 // ================== Setup ==================
 void setup() {
   Serial.begin(115200);
+  mutex_init(&wire1Mtx);
 
   for (uint8_t i=0;i<NUM_LED;i++) {
     pinMode(LED_PINS[i], OUTPUT);
@@ -1298,18 +1962,17 @@ void setup() {
     pid[i].outTarget = 0;
     pid[i].mode      = 0;
     pid[i].Kp = pid[i].Ki = pid[i].Kd = 0.0f;
-    pid[i].integral  = 0.0f;
-    pid[i].prevError = 0.0f;
-    pid[i].output    = 0.0f;
+    pid[i].beta      = 1.0f;
+    pid[i].dTf       = 0.1f;
+    pid[i].ffSource  = 0;
+    pid[i].ffGain    = 0.0f;
 
     pid[i].pvMin     = 0.0f;
     pid[i].pvMax     = 10000.0f;
     pid[i].outMin    = 0.0f;
     pid[i].outMax    = 4095.0f;
 
-    pid[i].pvPct     = 0.0f;
-    pid[i].spPct     = 0.0f;
-    pid[i].outPct    = 0.0f;
+    pidRequestReset(i);
 
     pidVirtRaw[i]    = 0.0f;
     pidVirtPct[i]    = 0.0f;
@@ -1329,6 +1992,7 @@ void setup() {
   WebSerial.on("ledCfg",  handleLedCfg);
   WebSerial.on("btnCfg",  handleBtnCfg);
   WebSerial.on("rtdCfg",  handleRtdCfg);
+  WebSerial.on("aiCfg",   handleAiCfg);
 
   if (!initFilesystemAndConfig()) {
     WebSerial.send("message", "FATAL: Filesystem/config init failed");
@@ -1342,14 +2006,23 @@ void setup() {
   ads_ok = ads.begin();
   if (ads_ok) {
     ads.setGain(1);
-    ads.setDataRate(4);
+    ads.setMode(1);                      // single-shot, started by adsStart()
+    ads.setDataRate(aiRate[0]);
+#if ADS_ALERT_PIN >= 0
+    // ALERT/RDY as conversion-ready: Hi_thresh MSB=1, Lo_thresh MSB=0, assert after 1 conversion
+    ads.setComparatorThresholdHigh((int16_t)0x8000);
+    ads.setComparatorThresholdLow(0x0000);
+    ads.setComparatorQueConvert(0);
+    pinMode(ADS_ALERT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(ADS_ALERT_PIN), adsRdyIsr, FALLING);
+#endif
     WebSerial.send("message", "ADS1115 OK @0x48 (Wire1)");
   } else {
     WebSerial.send("message", "ERROR: ADS1115 not found @0x48");
   }
 
-  dac_ok[0] = dac0.begin(0x60, &Wire1);
-  dac_ok[1] = dac1.begin(0x61, &Wire1);
+  dac_ok[0] = dac0.begin(DAC_ADDR[0], &Wire1);
+  dac_ok[1] = dac1.begin(DAC_ADDR[1], &Wire1);
   WebSerial.send("message", dac_ok[0] ? "MCP4725 #0 OK @0x60 (Wire1)" : "ERROR: MCP4725 #0 not found");
   WebSerial.send("message", dac_ok[1] ? "MCP4725 #1 OK @0x61 (Wire1)" : "ERROR: MCP4725 #1 not found");
 
@@ -1388,11 +2061,19 @@ void setup() {
     mb.addHreg(HREG_PID_PVVAL_BASE  + i, 0);
     mb.addHreg(HREG_PID_ERR_BASE    + i, 0);
   }
+  mb.addHreg(HREG_PID_PERIOD_MS,   pidPeriodMs);
+  mb.addHreg(HREG_PID_JITTER_US,   0);
+  mb.addHreg(HREG_PID_JITTER_MAX,  0);
+  mb.addHreg(HREG_PID_EXEC_MAX_US, 0);
+  mb.addHreg(HREG_PID_OVERRUNS,    0);
 
   WebSerial.send("message",
     "Boot OK (AIO-422-R1 RP2350: ADS1115@Wire1, 2xMCP4725@Wire1, 2xMAX31865 softSPI, 4 BTN, 4 LED, 4xPID + Web-only RTD config/diagnostics)");
 
   sendAllEchoesOnce();
+
+  pidPublishInputs();
+  pidExecRun = true;
 }
 
 // ================== send initial state ==================
@@ -1402,6 +2083,11 @@ void sendAllEchoesOnce() {
   dacList[1] = dacRaw[1];
   WebSerial.send("dacValues", dacList);
 
+  JSONVar dacSlewList;
+  dacSlewList[0] = (int)dacSlew[0];
+  dacSlewList[1] = (int)dacSlew[1];
+  WebSerial.send("dacSlew", dacSlewList);
+
   JSONVar ledList;
   for (int i=0;i<NUM_LED;i++) ledList[i] = ledState[i];
   WebSerial.send("LedStateList", ledList);
@@ -1428,8 +2114,19 @@ void sendAllEchoesOnce() {
   cfg["rref"]     = rr;
   WebSerial.send("rtdCfg", cfg);
 
-  // Take one diagnostics snapshot at boot
-  updateRtdDiagnostics();
+  JSONVar aiCfg, aRate, aOsr, aSps;
+  for (int i=0;i<4;i++) {
+    aRate[i] = (int)aiRate[i];
+    aOsr[i]  = (int)aiOsr[i];
+    aSps[i]  = (int)ADS_SPS[aiRate[i]];
+  }
+  aiCfg["rate"] = aRate;
+  aiCfg["osr"]  = aOsr;
+  aiCfg["sps"]  = aSps;
+  WebSerial.send("aiCfg", aiCfg);
+
+  // Fresh register snapshot for the diagnostics below
+  for (int i=0;i<2;i++) if (rtd_ok[i]) rtdPoll((uint8_t)i);
 
   JSONVar info;
   JSONVar t10, tc, fault, err, raw, ratio, ohm;
@@ -1515,6 +2212,8 @@ void loop() {
   unsigned long now = millis();
 
   mb.task();
+  adsService();
+  pidMirrorOutputs();
 
   // Sync PID config FROM Modbus
   for (int i = 0; i < 4; i++) {
@@ -1569,7 +2268,7 @@ void loop() {
     readSensors();
   }
 
-  updatePids();
+  pidPublishInputs();
 
   // LEDs
   for (int i=0;i<NUM_LED;i++) {
@@ -1590,6 +2289,26 @@ void loop() {
     for (int i=0;i<4;i++) aiList[i] = aiMv[i];
     WebSerial.send("aiValues", aiList);
 
+    // published samples/s per AI since last report
+    static uint32_t aiCntPrev[4] = {0,0,0,0};
+    static unsigned long aiStatsMs = 0;
+    JSONVar aiStats, hz;
+    float secs = aiStatsMs ? (now - aiStatsMs) / 1000.0f : 0.0f;
+    for (int i=0;i<4;i++) {
+      hz[i] = (secs > 0.0f) ? (double)((aiSampleCnt[i] - aiCntPrev[i]) / secs) : 0.0;
+      aiCntPrev[i] = aiSampleCnt[i];
+    }
+    aiStatsMs = now;
+    aiStats["hz"]       = hz;
+    aiStats["timeouts"] = (double)adsTimeouts;
+    WebSerial.send("aiStats", aiStats);
+
+    JSONVar dacStats, dw;
+    dw[0] = (double)dacWrites[0];
+    dw[1] = (double)dacWrites[1];
+    dacStats["writes"] = dw;
+    WebSerial.send("dacStats", dacStats);
+
     JSONVar tempList;
     for (int i=0;i<2;i++) tempList[i] = rtdTemp_x10[i];
     WebSerial.send("rtdTemps_x10", tempList);
@@ -1618,12 +2337,10 @@ void loop() {
     sendPidSnapshot();
   }
 
-  // FIX B + FIX C: full RTD diagnostics only every 2 seconds
+  // FIX B: full RTD diagnostics only every 2 seconds (values come from rtdPoll() snapshots)
   if (now - lastRtdInfoSend >= rtdInfoInterval) {
     lastRtdInfoSend = now;
 
-    updateRtdDiagnostics();
-
     JSONVar info;
     JSONVar t10, tc, fault, err, raw, ratio, ohm;
     t10[0] = rtdTemp_x10[0]; t10[1] = rtdTemp_x10[1];
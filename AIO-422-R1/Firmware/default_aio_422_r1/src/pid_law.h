@@ -0,0 +1,108 @@
+// ================================================
+// File: pid_law.h
+// AIO-422 PID: loop config/runtime types, the per-loop control law and the
+// cascade evaluation order
+// No Arduino dependency; tests/aio_pid_test.cpp closes the loop around a
+// first-order-plus-dead-time plant on a host.
+// ================================================
+#pragma once
+#include <stdint.h>
+
+// Config: owned by core0 (WebSerial/Modbus/persist), published to core1 via pidCfg.
+struct PIDState {
+  bool    enabled;
+  uint8_t pvSource;     // 0 none, 1..4 AI1..4(mV), 5 RTD1, 6 RTD2, 7..10 MBPV1..MBPV4
+  uint8_t spSource;     // 0 manual (Web), 1..4 SP1..SP4(Modbus), 5..8 PID1..PID4 OUT
+  uint8_t outTarget;    // 0 none, 1 AO1, 2 AO2, 3 virtual-only
+  uint8_t mode;         // 0 direct, 1 reverse (Web-only persisted)
+
+  float   Kp;
+  float   Ki;
+  float   Kd;
+
+  float   beta;         // setpoint weight on P (0..1)
+  float   dTf;          // derivative filter time constant [s], 0 = unfiltered
+  uint8_t ffSource;     // 0 none, 1..4 MBPV1..MBPV4 feed-forward
+  float   ffGain;       // FF contribution [%] = ffGain * MBPV / 100
+
+  float   pvMin;
+  float   pvMax;
+  float   outMin;
+  float   outMax;
+};
+
+// Runtime: owned by core1 (pidStep), never touched by core0.
+struct PidRt {
+  float    integral;
+  float    prevError;
+  float    prevPvPct;   // derivative is taken on measurement
+  float    dState;      // filtered derivative [%/s]
+  bool     wasActive;   // for bumpless manual -> auto transfer
+  uint32_t resetSeen;   // last pidResetReq[] value handled
+};
+
+static inline float pidClamp(float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+static inline void pidRtClear(PidRt &r) {
+  r.integral  = 0.0f;
+  r.prevError = 0.0f;
+  r.dState    = 0.0f;
+  r.wasActive = false;
+}
+
+// One cycle of an active loop, everything in % of span:
+//   u = Kp·(β·SP − PV) + I + Kd·D_f(−PV) + FF       (sign flipped for reverse mode)
+// uPrevPct is the output currently applied (bumpless start on the first active
+// cycle). Integration stops while the output is saturated in the direction the
+// error would push it (conditional anti-windup). Returns u clamped to 0..100.
+static inline float pidLawStep(const PIDState &p, PidRt &r, float pvPct, float spPct, float ffPct,
+                               float uPrevPct, float dt, float &errorPct) {
+  const float sgn = (p.mode == 1) ? -1.0f : 1.0f;
+  errorPct = sgn * (spPct - pvPct);
+
+  // proportional on weighted setpoint
+  const float pTerm = p.Kp * sgn * (p.beta * spPct - pvPct);
+
+  if (!r.wasActive) {
+    r.integral  = pidClamp(pidClamp(uPrevPct, 0.0f, 100.0f) - pTerm - ffPct, -100.0f, 100.0f);
+    r.prevPvPct = pvPct;
+    r.dState    = 0.0f;
+    r.wasActive = true;
+  }
+
+  // derivative on measurement, first-order filtered
+  const float dRaw  = (dt > 0.0f) ? (-sgn * (pvPct - r.prevPvPct) / dt) : 0.0f;
+  const float alpha = (p.dTf > 0.0f) ? (dt / (p.dTf + dt)) : 1.0f;
+  r.dState   += alpha * (dRaw - r.dState);
+  r.prevPvPct = pvPct;
+
+  const float pd = pTerm + p.Kd * r.dState + ffPct;
+
+  float u = pd + r.integral;
+  const bool satLow  = (u <= 0.0f);
+  const bool satHigh = (u >= 100.0f);
+  if ((!satLow && !satHigh) || (satLow && errorPct > 0.0f) || (satHigh && errorPct < 0.0f)) {
+    r.integral = pidClamp(r.integral + errorPct * dt * p.Ki, -100.0f, 100.0f);
+    u = pd + r.integral;
+  }
+
+  r.prevError = errorPct;
+  return pidClamp(u, 0.0f, 100.0f);
+}
+
+// Evaluation order: a loop whose SP is another loop's output (spSource 5..8) runs
+// after that loop, so cascades see the outer output of the same cycle. Loops in a
+// dependency cycle fall back to index order and read the previous cycle's value.
+static inline void pidEvalOrder(const PIDState cfg[4], uint8_t order[4]) {
+  bool placed[4] = { false, false, false, false };
+  uint8_t n = 0;
+  for (int pass = 0; pass < 4 && n < 4; pass++) {
+    for (int i = 0; i < 4; i++) {
+      if (placed[i]) continue;
+      uint8_t src = cfg[i].spSource;
+      int dep = (src >= 5 && src <= 8) ? (src - 5) : -1;
+      if (dep < 0 || dep == i || placed[dep]) { order[n++] = (uint8_t)i; placed[i] = true; }
+    }
+  }
+  for (int i = 0; i < 4; i++) if (!placed[i]) order[n++] = (uint8_t)i;
+}
@@ -5,8 +5,9 @@ struct PersistConfig;
  * DIM-420-R1 — RP2350A (Pico 2) firmware
  * QUIET WEB CONFIG + LOGS + LIVE DI STATE
  *
- * - Sends a compact JSON "config" snapshot via WebSerial once/second
- *   (includes DI runtime state, buttons state, LEDs state)
+ * - Sends the full JSON "config" on hello/getAll or config change, and a
+ *   "delta" of changed runtime values (levels, ZC/PLL, DI/button/LED state)
+ *   at a configurable rate
  * - Accepts "values" (Modbus addr/baud) and "Config" updates from Web UI
  * - Minimal "message" logs on user/Modbus actions
  * - RS-485/Modbus on Serial2, WebSerial on USB Serial
@@ -19,7 +20,10 @@ struct PersistConfig;
 #include <LittleFS.h>
 #include <utility>
 #include <math.h>
-#include "pico/time.h"          // time_us_64(), add_alarm_in_us(), alarm_id_t
+#include "pico/time.h"          // time_us_64(), add_alarm_at()
+#include "hardware/pio.h"       // gate generator state machines
+#include "hardware/clocks.h"    // clock_get_hz()
+#include "src/zc_pll.h"         // zero-cross PLL (host-testable)
 
 // ================== UART2 (RS-485 / Modbus) ==================
 #define TX2 4
@@ -39,12 +43,21 @@ static const uint8_t BTN_PINS[4]  = {22, 23, 24, 25};
 static const uint8_t NUM_DI=4, NUM_CH=2, NUM_LED=4, NUM_BTN=4;
 
 // ================== AC timing / MOSFET gating ==================
-constexpr uint32_t HALF_US_DEFAULT=10000u, ZC_BLANK_US=100u, MOS_OFF_GUARD_US=150u, GATE_PULSE_US=120u;
+constexpr uint32_t ZC_BLANK_US=100u, MOS_OFF_GUARD_US=150u, GATE_PULSE_US=120u;
 
 // ---- State (volatile: accessed in ISR) ----
-volatile uint8_t  chLevel[NUM_CH] = {0,0};
+volatile uint8_t  chLevel[NUM_CH] = {0,0};          // 8-bit view of the target (HREG 400+ch)
 volatile uint8_t  chLastNonZero[NUM_CH] = {200,200};
 
+// ---- 16-bit level + fade engine ----
+// chTarget16 is the requested level (0..65535); chCur32 is the output in 16.16
+// fixed point, advanced by chFadeStep32 once per half-cycle from the ZC ISR.
+volatile uint16_t chTarget16[NUM_CH] = {0,0};
+volatile uint32_t chCur32[NUM_CH]    = {0,0};
+volatile uint32_t chFadeStep32[NUM_CH] = {0,0};
+uint16_t chFadeMs[NUM_CH]   = {0,0};   // time for one transition, 0 = instant
+uint16_t chFadeRate[NUM_CH] = {0,0};   // max speed, 0.1 % of full scale per s, 0 = no limit
+
 // ================== Digital Input switch model ==================
 enum DiSwitchType : uint8_t { DI_SW_MOMENTARY=0, DI_SW_LATCHING=1 };
 enum DiPressType  : uint8_t { PRESS_SHORT=0, PRESS_LONG=1, PRESS_DOUBLE_SHORT=2, PRESS_SHORT_THEN_LONG=3, PRESS_COUNT=4 };
@@ -112,17 +125,13 @@ const uint32_t ZC_FAULT_TIMEOUT_MS = 1000;
 const uint8_t  ZC_OK_STREAK_N=6, ZC_FAULT_STREAK_N=6;
 uint8_t zcOkStreak[NUM_CH]={0,0}, zcFaultStreak[NUM_CH]={0,0};
 
-// ================== Frequency measurement (robust) ==================
-volatile uint64_t zcPrevEdgeUs64[NUM_CH] = {0,0};
-volatile uint32_t zcHalfUsLatest[NUM_CH] = {HALF_US_DEFAULT,HALF_US_DEFAULT};
-volatile uint32_t zcSampleSeq[NUM_CH]    = {0,0};
-constexpr uint32_t HALF_MIN_US=7500, HALF_MAX_US=12000;
-constexpr int MED_W=3, AVG_N=32;
-uint32_t med3[NUM_CH][MED_W]={{HALF_US_DEFAULT,HALF_US_DEFAULT,HALF_US_DEFAULT},{HALF_US_DEFAULT,HALF_US_DEFAULT,HALF_US_DEFAULT}};
-uint8_t  medIdx[NUM_CH]={0,0};
-uint32_t avgBuf[NUM_CH][AVG_N]={{HALF_US_DEFAULT}}, avgIdx[NUM_CH]={0,0};
-uint64_t avgSum[NUM_CH]={(uint64_t)HALF_US_DEFAULT*AVG_N,(uint64_t)HALF_US_DEFAULT*AVG_N};
+// ================== Zero-cross PLL (frequency + phase) ==================
+// Tracker itself is in src/zc_pll.h; the ZC ISR only feeds it edges.
+volatile ZcPll zcPll[NUM_CH];
+volatile uint32_t zcSampleSeq[NUM_CH]    = {0,0};   // accepted edges
+volatile uint32_t zcRejectCnt[NUM_CH]    = {0,0};   // spurious edges dropped
 uint32_t lastSeqConsumed[NUM_CH]={0,0};
+bool pllLockPrev[NUM_CH]={false,false};
 constexpr int CLOCK_PPM_CORR=0;
 inline double corr_half_us(double half_us){ return half_us * (1.0 + (CLOCK_PPM_CORR / 1e6)); }
 uint16_t freq_x100[NUM_CH] = {5000,5000};
@@ -151,7 +160,8 @@ JSONVar modbusStatus;
 static inline void wsLog(const String& line){ WebSerial.send("message",(const char*)line.c_str()); }
 
 // ================== Timing ==================
-unsigned long lastSend=0; const unsigned long sendInterval=1000;
+unsigned long lastSend=0; uint16_t telemIntervalMs=200; constexpr uint16_t TELEM_MIN_MS=50, TELEM_MAX_MS=5000;
+bool telemLegacy=false; constexpr uint16_t TELEM_LEGACY_MS=1000;   // A/B only: the pre-delta 1 s full snapshot, not persisted
 unsigned long lastBlinkToggle=0; const unsigned long blinkPeriodMs=400; bool blinkPhase=false;
 
 // ================== Persisted Modbus settings ==================
@@ -163,10 +173,20 @@ struct PersistConfig {
   InCfg  diCfg[NUM_DI]; ChCfg chCfg[NUM_CH]; LedCfg ledCfg[NUM_LED]; BtnCfg btnCfg[NUM_BTN];
   uint8_t chLevel[NUM_CH]; uint8_t chLastNonZero[NUM_CH]; uint8_t chLower[NUM_CH]; uint8_t chUpper[NUM_CH];
   uint8_t chLoadType[NUM_CH]; uint16_t chPctX10[NUM_CH]; uint8_t chCutMode[NUM_CH]; uint8_t chPreset[NUM_CH];
+  uint16_t chLevel16[NUM_CH]; uint16_t chFadeMs[NUM_CH]; uint16_t chFadeRate[NUM_CH];
   uint8_t mb_address; uint32_t mb_baud; uint32_t crc32;
 } __attribute__((packed));
 
-static const uint32_t CFG_MAGIC=0x314D4449UL; static const uint16_t CFG_VERSION=0x0006; static const char* CFG_PATH="/cfg.bin";
+// v6 layout (8-bit level only), migrated on load
+struct PersistConfigV6 {
+  uint32_t magic; uint16_t version; uint16_t size;
+  InCfg  diCfg[NUM_DI]; ChCfg chCfg[NUM_CH]; LedCfg ledCfg[NUM_LED]; BtnCfg btnCfg[NUM_BTN];
+  uint8_t chLevel[NUM_CH]; uint8_t chLastNonZero[NUM_CH]; uint8_t chLower[NUM_CH]; uint8_t chUpper[NUM_CH];
+  uint8_t chLoadType[NUM_CH]; uint16_t chPctX10[NUM_CH]; uint8_t chCutMode[NUM_CH]; uint8_t chPreset[NUM_CH];
+  uint8_t mb_address; uint32_t mb_baud; uint32_t crc32;
+} __attribute__((packed));
+
+static const uint32_t CFG_MAGIC=0x314D4449UL; static const uint16_t CFG_VERSION=0x0007; static const char* CFG_PATH="/cfg.bin";
 
 volatile bool cfgDirty=false; uint32_t lastCfgTouchMs=0; const uint32_t CFG_AUTOSAVE_MS=1500;
 volatile bool diCfgEchoPending=false;
@@ -177,66 +197,171 @@ uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len){
 }
 inline bool timeAfter32(uint32_t a, uint32_t b){ return (int32_t)(a-b) >= 0; }
 
-// ---- MOSFET gate set callbacks ----
-static int64_t mos_on_cb_ch0 (alarm_id_t, void*){ digitalWrite(GATE_PINS[0], HIGH); return 0; }
-static int64_t mos_on_cb_ch1 (alarm_id_t, void*){ digitalWrite(GATE_PINS[1], HIGH); return 0; }
-static int64_t mos_off_cb_ch0(alarm_id_t, void*){ digitalWrite(GATE_PINS[0], LOW ); return 0; }
-static int64_t mos_off_cb_ch1(alarm_id_t, void*){ digitalWrite(GATE_PINS[1], LOW ); return 0; }
-
-// ---- Zero-cross ISR ----
-void zc_isr_common(uint8_t ch){
-  uint64_t now = time_us_64(); uint64_t prev = zcPrevEdgeUs64[ch]; zcPrevEdgeUs64[ch]=now;
-  if (prev){ uint32_t delta=(uint32_t)(now-prev); if (delta>=7500 && delta<=12000){ zcHalfUsLatest[ch]=delta; zcSampleSeq[ch]++; } }
-  zcLastEdgeMs[ch]=millis();
-  digitalWrite(GATE_PINS[ch], LOW);
-
-  const uint8_t lvl=chLevel[ch]; if (lvl==0 || !chCfg[ch].enabled) return;
+// ================== PIO phase-cut gate generator ==================
+// One SM per channel (pio0, shared program), clocked at 1 MHz. The SM does not
+// watch the ZC pin: a timer callback fires GATE_ALARM_LEAD_US before each
+// PLL-predicted crossing and posts {width:16|delay:16} with the delay measured
+// from that moment, so glitch edges never fire a gate and a missing edge does
+// not drop one (the prediction coasts for up to PLL_COAST_N half-cycles).
+// While the PLL is unlocked the ZC ISR posts the word itself, timed from the
+// edge, once pllEdgeGateOk() trusts the edge stream (relock, high jitter).
+// So there is still CPU work per half-cycle, in IRQ context: one fade step, a
+// 32-bit multiply/divide against gatePre[] (precomputed in loop() whenever the
+// half-period moves) and a non-blocking FIFO write. A word that would fire too
+// late is shortened or skipped, and a full FIFO drops it; all three are
+// counted (gateLate/gateTrunc/gateDrop, reported by the "stats" command).
+//   0: pull block       ; wait for this half-cycle's word
+//   1: out y, 16        ; delay
+//   2: jmp y-- 2
+//   3: out y, 16        ; width
+//   4: jmp !y 0         ; width 0 = stay off this half-cycle
+//   5: set pins, 1
+//   6: jmp y-- 6
+//   7: set pins, 0      ; .wrap
+static const uint16_t gate_pio_instr[]={ 0x80A0,0x6050,0x0082,0x6050,0x0060,0xE001,0x0086,0xE000 };
+static const pio_program_t gate_pio_prog={ gate_pio_instr, 8, -1 };
+constexpr uint32_t GATE_PIO_LEAD_US=6, GATE_PIO_TAIL_US=2;   // fixed SM cycles from put to gate-on / inside width
+constexpr uint32_t GATE_ALARM_LEAD_US=100;                   // callback runs this far ahead of the crossing
+static PIO gatePio=pio0; static int gateSm[NUM_CH]={-1,-1};
+volatile bool     gateArmed[NUM_CH]={false,false};            // timer owns the half-cycle (fade + gate)
+volatile uint64_t gateAlarmAt[NUM_CH]={0,0};
+volatile uint32_t gatePre[NUM_CH]={0,0};                      // {t_off max:16|usable:16} for the current half-period
+volatile uint32_t gateLate[NUM_CH]={0,0}, gateTrunc[NUM_CH]={0,0}, gateDrop[NUM_CH]={0,0};
+
+bool gatePioBegin(){
+  if(!pio_can_add_program(gatePio,&gate_pio_prog)) return false;
+  const uint off=pio_add_program(gatePio,&gate_pio_prog); const float div=(float)clock_get_hz(clk_sys)/1000000.0f;
+  for(uint8_t ch=0;ch<NUM_CH;ch++){
+    const int sm=pio_claim_unused_sm(gatePio,false); if(sm<0) return false; gateSm[ch]=sm;
+    pio_sm_config c=pio_get_default_sm_config();
+    sm_config_set_wrap(&c,off+0,off+7); sm_config_set_set_pins(&c,GATE_PINS[ch],1);
+    sm_config_set_out_shift(&c,true,false,32); sm_config_set_clkdiv(&c,div);
+    pio_gpio_init(gatePio,GATE_PINS[ch]); pio_sm_set_consistent_pindirs(gatePio,sm,GATE_PINS[ch],1,true);
+    pio_sm_init(gatePio,sm,off,&c); pio_sm_exec(gatePio,sm,pio_encode_set(pio_pins,0)); pio_sm_set_enabled(gatePio,sm,true);
+  }
+  return true;
+}
 
+// Half-period dependent part of the gate timing; loop() refreshes it when the PLL moves
+void gatePrecompute(uint8_t ch){
   uint32_t half_us=gateHalfUs[ch]; if (half_us<HALF_MIN_US || half_us>HALF_MAX_US) half_us=HALF_US_DEFAULT;
   const uint32_t usable=(half_us>(ZC_BLANK_US+MOS_OFF_GUARD_US+20))?(half_us-ZC_BLANK_US-MOS_OFF_GUARD_US):(half_us/2);
-  auto on_cb  = (ch==0)?mos_on_cb_ch0:mos_on_cb_ch1;
-  auto off_cb = (ch==0)?mos_off_cb_ch0:mos_off_cb_ch1;
+  gatePre[ch]=((half_us-MOS_OFF_GUARD_US)<<16)|usable;                 // one word, so the IRQ never sees a torn pair
+}
 
+// Gate timing relative to the crossing for the current level/mode/half-period:
+// {width:16|t_on:16}, 0 = no pulse. 32-bit only (lvl*usable < 2^30), IRQ-safe.
+uint32_t gateTimingFor(uint8_t ch){
+  const uint32_t lvl=chCur32[ch]>>16; if (lvl==0 || !chCfg[ch].enabled) return 0;
+  const uint32_t pre=gatePre[ch], usable=pre&0xFFFFu;
+  uint32_t t_on, t_off=pre>>16;
   if (chCutMode[ch]==CUT_TRAILING){
-    uint32_t on_time=(uint32_t)((uint64_t)lvl*usable/255u); if (on_time==0) return;
-    uint32_t t_on=ZC_BLANK_US, t_off=ZC_BLANK_US+on_time, latest_off=half_us-MOS_OFF_GUARD_US;
-    if (t_off>latest_off) t_off=latest_off; if (t_on>=t_off) return;
-    add_alarm_in_us((int64_t)t_on, on_cb, nullptr, true);
-    add_alarm_in_us((int64_t)t_off, off_cb, nullptr, true);
+    const uint32_t on_time=lvl*usable/65535u; if (on_time==0) return 0;
+    t_on=ZC_BLANK_US; if (ZC_BLANK_US+on_time<t_off) t_off=ZC_BLANK_US+on_time;
   } else {
-    uint32_t delay=ZC_BLANK_US + (uint32_t)((uint64_t)(255-lvl)*usable/255u);
-    uint32_t t_off=half_us-MOS_OFF_GUARD_US; if (delay>=t_off) return;
-    add_alarm_in_us((int64_t)delay, on_cb, nullptr, true);
-    add_alarm_in_us((int64_t)t_off, off_cb, nullptr, true);
+    t_on=ZC_BLANK_US + (65535u-lvl)*usable/65535u;
   }
+  if (t_on>=t_off || t_off-t_on<=GATE_PIO_TAIL_US) return 0;
+  return ((t_off-t_on-GATE_PIO_TAIL_US)<<16) | t_on;
+}
+
+// Post this half-cycle's word for crossing c; the SM is idle on 'pull block'
+void gatePost(uint8_t ch,uint64_t c){
+  if(gateSm[ch]<0) return; const uint32_t tw=gateTimingFor(ch); if(!tw) return;
+  uint32_t width=tw>>16; int64_t d=(int64_t)(c+(tw&0xFFFFu)-time_us_64())-(int64_t)GATE_PIO_LEAD_US;
+  if(d<0){ if((uint64_t)(-d)>=width){ gateLate[ch]++; return; } width-=(uint32_t)(-d); d=0; gateTrunc[ch]++; }   // ran late: keep the off edge
+  if(pio_sm_is_tx_fifo_full(gatePio,gateSm[ch])){ gateDrop[ch]++; return; }                            // SM stalled: never block in IRQ
+  pio_sm_put(gatePio,gateSm[ch],(width<<16)|(uint32_t)d);
+}
+
+// One fade increment toward chTarget16; below Lower the load is dark, so skip that band
+static inline void fadeAdvance(uint8_t ch){
+  const uint32_t tgt=(uint32_t)chTarget16[ch]<<16, lo=(uint32_t)chLower[ch]*257u<<16; uint32_t cur=chCur32[ch]; if(cur==tgt) return;
+  const uint32_t step=chFadeStep32[ch];
+  if(cur<tgt){ if(cur<lo) cur=lo; cur=(tgt-cur>step)?cur+step:tgt; }
+  else { cur=(cur-tgt>step)?cur-step:tgt; if(cur<lo) cur=tgt; }
+  chCur32[ch]=cur;
+}
+
+// ---- Gate timer: one callback per predicted crossing while the PLL is locked ----
+static int64_t gate_alarm_cb(alarm_id_t,void* ud){
+  const uint8_t ch=(uint8_t)(uintptr_t)ud; const uint64_t at=gateAlarmAt[ch]; uint64_t c, next;
+  if(!pllGateStep(zcPll[ch],at,GATE_ALARM_LEAD_US,c,next)){ gateArmed[ch]=false; return 0; }   // unlocked or coasted too long
+  fadeAdvance(ch); gatePost(ch,c); gateAlarmAt[ch]=next;
+  return (int64_t)(next-at);                                               // relative to the previous target
+}
+static void gateArm(uint8_t ch){
+  gateAlarmAt[ch]=zcPll[ch].nextUs-GATE_ALARM_LEAD_US; gateArmed[ch]=true;
+  if(add_alarm_at(from_us_since_boot(gateAlarmAt[ch]),gate_alarm_cb,(void*)(uintptr_t)ch,false)<=0) gateArmed[ch]=false;
+}
+
+// ---- Zero-cross ISR: feeds the PLL; while the gate timer is idle it steps the fade,
+//      gates this crossing from the edge (acquisition fallback) and arms the timer once locked ----
+void zc_isr_common(uint8_t ch){
+  const uint64_t t=time_us_64();
+  if(!pllEdge(zcPll[ch],t)){ zcRejectCnt[ch]++; return; }
+  gateHalfUs[ch]=zcPll[ch].halfQ8>>8; zcSampleSeq[ch]++; zcLastEdgeMs[ch]=millis();
+  if(gateArmed[ch]) return;
+  fadeAdvance(ch);
+  if(gateSm[ch]<0) return;
+  if(pllEdgeGateOk(zcPll[ch])) gatePost(ch,t);
+  if(pllGateOk(zcPll[ch],zcPll[ch].nextUs)) gateArm(ch);
 }
 void zc_isr_ch0(){ zc_isr_common(0); }
 void zc_isr_ch1(){ zc_isr_common(1); }
 
 // ================== Mapping helpers ==================
-constexpr double LAMP_LOG_MAX=6.0;
+// Percent -> 16-bit level LUT per channel (1 % steps, linear in between),
+// rebuilt when Lower/Upper/LoadType change. Lamp: CIE L* lightness, so equal
+// percent steps look equal; heater: linear power; key: on/off at Upper.
+constexpr uint8_t LUT_N=101;
+uint16_t chLut[NUM_CH][LUT_N];
 inline uint8_t clamp8(int v){ return (uint8_t)constrain(v,0,255); }
-uint8_t mapLampPercentToLevel(uint8_t ch,double pct){ if(pct<=0.0) return 0; if(pct>100.0) pct=100.0; if(pct<=1.0) return chLower[ch];
-  const double L=1.0+(LAMP_LOG_MAX-1.0)*((pct-1.0)/99.0); const double t=(L-1.0)/(LAMP_LOG_MAX-1.0);
-  const double span=(double)(chUpper[ch]-chLower[ch]); int lvl=(int)lround(chLower[ch]+t*span);
-  if(lvl>0 && lvl<chLower[ch]) lvl=chLower[ch]; if(lvl>chUpper[ch]) lvl=chUpper[ch]; return clamp8(lvl);}
-uint8_t mapHeaterPercentToLevel(uint8_t ch,double pct){ if(pct<=0.0) return 0; if(pct<1.0) return chLower[ch]; if(pct>100.0) pct=100.0;
-  double span=(double)(chUpper[ch]-chLower[ch]); int lvl=(int)lround(chLower[ch]+(span*(pct/100.0)));
-  if(lvl<chLower[ch]) lvl=chLower[ch]; if(lvl>chUpper[ch]) lvl=chUpper[ch]; return clamp8(lvl);}
-uint8_t mapKeyPercentToLevel(uint8_t ch,double pct){ return (pct<=0.0)?0:chUpper[ch]; }
-uint8_t mapPercentToLevel(uint8_t ch,double pct){ switch((LoadType)chLoadType[ch]){case LOAD_LAMP: return mapLampPercentToLevel(ch,pct); case LOAD_HEATER: return mapHeaterPercentToLevel(ch,pct); case LOAD_KEY: return mapKeyPercentToLevel(ch,pct);} return mapLampPercentToLevel(ch,pct); }
-void setLevelDirect(uint8_t ch,uint8_t lvl){ chLevel[ch]=lvl; if(lvl>0) chLastNonZero[ch]=lvl; mb.setHreg(400+ch,chLevel[ch]); }
+inline uint16_t lvl16Lower(uint8_t ch){ return (uint16_t)(chLower[ch]*257u); }
+inline uint16_t lvl16Upper(uint8_t ch){ return (uint16_t)(chUpper[ch]*257u); }
+inline uint8_t level8From16(uint16_t t){ if(t==0) return 0; const uint32_t l=((uint32_t)t+128u)/257u; return (uint8_t)(l?l:1); }
+static inline float cieLstarToY(float L){ return (L>8.0f)?powf((L+16.0f)/116.0f,3.0f):(L/903.3f); }
+void buildLevelLut(uint8_t ch){
+  const uint32_t lo=lvl16Lower(ch), span=lvl16Upper(ch)-lo; chLut[ch][0]=0;
+  for(uint8_t p=1;p<LUT_N;p++){
+    float y; switch((LoadType)chLoadType[ch]){ case LOAD_HEATER: y=p/100.0f; break; case LOAD_KEY: y=1.0f; break; default: y=cieLstarToY((p-1)*100.0f/99.0f); break; }
+    chLut[ch][p]=(uint16_t)(lo+(uint32_t)lroundf(y*span));
+  }
+}
+uint16_t percentX10ToLevel16(uint8_t ch,uint16_t x10){
+  if(x10==0) return 0; if((LoadType)chLoadType[ch]==LOAD_KEY) return lvl16Upper(ch); if(x10<10) return chLut[ch][1]; if(x10>=1000) return chLut[ch][LUT_N-1];
+  const uint16_t i=x10/10, fr=x10%10; const int32_t a=chLut[ch][i], b=chLut[ch][i+1]; return (uint16_t)(a+(b-a)*fr/10);
+}
+
+// Per-half-cycle increment for a transition to chTarget16 (fade time, capped by rate)
+void fadeStart(uint8_t ch){
+  const uint32_t tgt=(uint32_t)chTarget16[ch]<<16, cur=chCur32[ch]; const uint32_t d=(cur>tgt)?cur-tgt:tgt-cur; if(d==0) return;
+  uint32_t half=gateHalfUs[ch]; if(half<HALF_MIN_US || half>HALF_MAX_US) half=HALF_US_DEFAULT;
+  uint64_t step=0xFFFFFFFFull;
+  if(chFadeMs[ch]){ const uint32_t n=(uint32_t)chFadeMs[ch]*1000u/half; if(n) step=((uint64_t)d+n-1)/n; }
+  if(chFadeRate[ch]){ uint64_t r=(uint64_t)chFadeRate[ch]*(65535ull<<16)/1000ull*half/1000000ull; if(r<1) r=1; if(r<step) step=r; }
+  if(step>=d || !zcOk[ch]){ noInterrupts(); chFadeStep32[ch]=0xFFFFFFFFu; chCur32[ch]=tgt; interrupts(); return; }
+  chFadeStep32[ch]=(uint32_t)step;
+}
+
+void setLevelTarget16(uint8_t ch,uint16_t t){
+  chTarget16[ch]=t; const uint8_t l=level8From16(t); chLevel[ch]=l; if(l>0) chLastNonZero[ch]=l;
+  mb.setHreg(400+ch,l); mb.setHreg(520+ch,t); fadeStart(ch);
+}
+// 8-bit level write; a no-op if it only restates the current 16-bit target
+void setLevelDirect(uint8_t ch,uint8_t lvl){ if(level8From16(chTarget16[ch])==lvl){ chLevel[ch]=lvl; mb.setHreg(400+ch,lvl); return; } setLevelTarget16(ch,(uint16_t)(lvl*257u)); }
 
 // ================== Defaults / persist ==================
 static inline void setThresholds(uint8_t ch,int lower,int upper);
 static inline void clampAndApplyPreset(uint8_t ch){ if(ch>=NUM_CH) return; if(chPreset[ch]>0){ if(chPreset[ch]<chLower[ch]) chPreset[ch]=chLower[ch]; if(chPreset[ch]>chUpper[ch]) chPreset[ch]=chUpper[ch]; } }
-void initFreqEstimator(){ for(int i=0;i<NUM_CH;i++){ zcPrevEdgeUs64[i]=0; zcHalfUsLatest[i]=HALF_US_DEFAULT; zcSampleSeq[i]=0; med3[i][0]=med3[i][1]=med3[i][2]=HALF_US_DEFAULT; medIdx[i]=0; for(int k=0;k<AVG_N;k++) avgBuf[i][k]=HALF_US_DEFAULT; avgIdx[i]=0; avgSum[i]=(uint64_t)HALF_US_DEFAULT*AVG_N; lastSeqConsumed[i]=0; freq_x100[i]=5000; gateHalfUs[i]=HALF_US_DEFAULT; } }
+void initFreqEstimator(){ for(int i=0;i<NUM_CH;i++){ zcPll[i].have=false; zcPll[i].locked=false; zcPll[i].halfQ8=HALF_US_DEFAULT<<8; zcSampleSeq[i]=0; zcRejectCnt[i]=0; lastSeqConsumed[i]=0; pllLockPrev[i]=false; freq_x100[i]=5000; gateHalfUs[i]=HALF_US_DEFAULT; gatePrecompute(i); } }
 void setDefaults(){
   for(int i=0;i<NUM_DI;i++){ diCfg[i].enabled=true; diCfg[i].inverted=false; diCfg[i].switchType=DI_SW_MOMENTARY;
     for(int p=0;p<PRESS_COUNT;p++){ diCfg[i].pressAction[p]=DI_ACT_NONE; diCfg[i].pressTarget[p]=DI_TGT_NONE; }
     diCfg[i].latchMode=LATCH_TOGGLE_TO_PRESET_OR_0; diCfg[i].latchTarget=DI_TGT_NONE; }
   for(int i=0;i<NUM_CH;i++) chCfg[i]={true}; for(int i=0;i<NUM_LED;i++) ledCfg[i]={0,0}; for(int i=0;i<NUM_BTN;i++) btnCfg[i]={0};
-  for(int i=0;i<NUM_CH;i++){ chLevel[i]=0; chLastNonZero[i]=200; chPulseUntil[i]=0; zcLastEdgeMs[i]=0; zcOk[i]=zcPrevOk[i]=false; zcOkStreak[i]=zcFaultStreak[i]=0; chLower[i]=20; chUpper[i]=255; chLoadType[i]=LOAD_LAMP; chPctX10[i]=0; chCutMode[i]=CUT_LEADING; chPreset[i]=200; }
+  for(int i=0;i<NUM_CH;i++){ chLevel[i]=0; chLastNonZero[i]=200; chPulseUntil[i]=0; zcLastEdgeMs[i]=0; zcOk[i]=zcPrevOk[i]=false; zcOkStreak[i]=zcFaultStreak[i]=0; chLower[i]=20; chUpper[i]=255; chLoadType[i]=LOAD_LAMP; chPctX10[i]=0; chCutMode[i]=CUT_LEADING; chPreset[i]=200;
+    chTarget16[i]=0; chCur32[i]=0; chFadeStep32[i]=0; chFadeMs[i]=0; chFadeRate[i]=0; buildLevelLut(i); }
   g_mb_address=3; g_mb_baud=19200; initFreqEstimator();
 }
 
@@ -244,7 +369,8 @@ void setDefaults(){
 void captureToPersist(PersistConfig &pc){
   pc.magic=CFG_MAGIC; pc.version=CFG_VERSION; pc.size=sizeof(PersistConfig);
   memcpy(pc.diCfg,diCfg,sizeof(diCfg)); memcpy(pc.chCfg,chCfg,sizeof(chCfg)); memcpy(pc.ledCfg,ledCfg,sizeof(ledCfg)); memcpy(pc.btnCfg,btnCfg,sizeof(btnCfg));
-  for(int i=0;i<NUM_CH;i++){ pc.chLevel[i]=chLevel[i]; pc.chLastNonZero[i]=chLastNonZero[i]; pc.chLower[i]=chLower[i]; pc.chUpper[i]=chUpper[i]; pc.chLoadType[i]=chLoadType[i]; pc.chPctX10[i]=chPctX10[i]; pc.chCutMode[i]=chCutMode[i]; pc.chPreset[i]=chPreset[i]; }
+  for(int i=0;i<NUM_CH;i++){ pc.chLevel[i]=chLevel[i]; pc.chLastNonZero[i]=chLastNonZero[i]; pc.chLower[i]=chLower[i]; pc.chUpper[i]=chUpper[i]; pc.chLoadType[i]=chLoadType[i]; pc.chPctX10[i]=chPctX10[i]; pc.chCutMode[i]=chCutMode[i]; pc.chPreset[i]=chPreset[i];
+    pc.chLevel16[i]=chTarget16[i]; pc.chFadeMs[i]=chFadeMs[i]; pc.chFadeRate[i]=chFadeRate[i]; }
   pc.mb_address=g_mb_address; pc.mb_baud=g_mb_baud; pc.crc32=0; pc.crc32=crc32_update(0,(const uint8_t*)&pc,sizeof(PersistConfig));
 }
 bool applyFromPersist(const PersistConfig &pc){
@@ -254,13 +380,27 @@ bool applyFromPersist(const PersistConfig &pc){
   for(int i=0;i<NUM_CH;i++){ chLower[i]=pc.chLower[i]; chUpper[i]=pc.chUpper[i]; chLastNonZero[i]=constrain(pc.chLastNonZero[i],chLower[i],chUpper[i]);
     chLoadType[i]=(pc.chLoadType[i]<=LOAD_KEY)?pc.chLoadType[i]:LOAD_LAMP; chPctX10[i]=(pc.chPctX10[i]>1000)?1000:pc.chPctX10[i];
     chCutMode[i]=(pc.chCutMode[i]<=CUT_TRAILING)?pc.chCutMode[i]:CUT_LEADING; chPreset[i]=pc.chPreset[i]; clampAndApplyPreset(i);
-    uint8_t lvl=pc.chLevel[i]; if(lvl==0) chLevel[i]=0; else if(lvl<chLower[i]) chLevel[i]=0; else if(lvl>chUpper[i]) chLevel[i]=chUpper[i]; else chLevel[i]=lvl; }
+    uint8_t lvl=pc.chLevel[i]; if(lvl==0) chLevel[i]=0; else if(lvl<chLower[i]) chLevel[i]=0; else if(lvl>chUpper[i]) chLevel[i]=chUpper[i]; else chLevel[i]=lvl;
+    uint16_t t=pc.chLevel16[i]; if(level8From16(t)!=chLevel[i]) t=(uint16_t)(chLevel[i]*257u); else if(t && t<lvl16Lower(i)) t=lvl16Lower(i); else if(t>lvl16Upper(i)) t=lvl16Upper(i);
+    chTarget16[i]=t; chCur32[i]=(uint32_t)t<<16; chFadeMs[i]=pc.chFadeMs[i]; chFadeRate[i]=pc.chFadeRate[i]; buildLevelLut(i); }
   g_mb_address=pc.mb_address; g_mb_baud=pc.mb_baud; return true;
 }
+bool applyFromPersistV6(const PersistConfigV6 &o){
+  if(o.magic!=CFG_MAGIC || o.size!=sizeof(PersistConfigV6) || o.version!=0x0006) return false; PersistConfigV6 tmp=o; uint32_t crc=tmp.crc32; tmp.crc32=0;
+  if(crc32_update(0,(const uint8_t*)&tmp,sizeof(tmp))!=crc) return false;
+  PersistConfig pc{}; pc.magic=CFG_MAGIC; pc.version=CFG_VERSION; pc.size=sizeof(PersistConfig);
+  memcpy(pc.diCfg,o.diCfg,sizeof(pc.diCfg)); memcpy(pc.chCfg,o.chCfg,sizeof(pc.chCfg)); memcpy(pc.ledCfg,o.ledCfg,sizeof(pc.ledCfg)); memcpy(pc.btnCfg,o.btnCfg,sizeof(pc.btnCfg));
+  for(int i=0;i<NUM_CH;i++){ pc.chLevel[i]=o.chLevel[i]; pc.chLastNonZero[i]=o.chLastNonZero[i]; pc.chLower[i]=o.chLower[i]; pc.chUpper[i]=o.chUpper[i]; pc.chLoadType[i]=o.chLoadType[i]; pc.chPctX10[i]=o.chPctX10[i]; pc.chCutMode[i]=o.chCutMode[i]; pc.chPreset[i]=o.chPreset[i];
+    pc.chLevel16[i]=(uint16_t)(o.chLevel[i]*257u); pc.chFadeMs[i]=0; pc.chFadeRate[i]=0; }
+  pc.mb_address=o.mb_address; pc.mb_baud=o.mb_baud; pc.crc32=0; pc.crc32=crc32_update(0,(const uint8_t*)&pc,sizeof(pc));
+  return applyFromPersist(pc);
+}
 bool saveConfigFS(){ PersistConfig pc{}; captureToPersist(pc); File f=LittleFS.open(CFG_PATH,"w"); if(!f) return false; size_t n=f.write((const uint8_t*)&pc,sizeof(pc)); f.flush(); f.close(); if(n!=sizeof(pc)) return false;
   File r=LittleFS.open(CFG_PATH,"r"); if(!r) return false; if((size_t)r.size()!=sizeof(PersistConfig)){ r.close(); return false; } PersistConfig back{}; size_t nr=r.read((uint8_t*)&back,sizeof(back)); r.close(); if(n!=sizeof(back)) return false;
   PersistConfig tmp2=back; uint32_t crc=tmp2.crc32; tmp2.crc32=0; if(crc32_update(0,(const uint8_t*)&tmp2,sizeof(tmp2))!=crc) return false; wsLog("config: saved to FS"); return true; }
-bool loadConfigFS(){ File f=LittleFS.open(CFG_PATH,"r"); if(!f) return false; if(f.size()!=sizeof(PersistConfig)){ f.close(); return false; } PersistConfig pc{}; size_t n=f.read((uint8_t*)&pc,sizeof(pc)); f.close(); if(n!=sizeof(pc)) return false; if(!applyFromPersist(pc)) return false; wsLog("config: loaded from FS"); return true; }
+bool loadConfigFS(){ File f=LittleFS.open(CFG_PATH,"r"); if(!f) return false;
+  if(f.size()==sizeof(PersistConfigV6)){ PersistConfigV6 o{}; size_t n=f.read((uint8_t*)&o,sizeof(o)); f.close(); if(n!=sizeof(o) || !applyFromPersistV6(o)) return false; cfgDirty=true; lastCfgTouchMs=millis(); wsLog("config: migrated v6 -> v7"); return true; }
+  if(f.size()!=sizeof(PersistConfig)){ f.close(); return false; } PersistConfig pc{}; size_t n=f.read((uint8_t*)&pc,sizeof(pc)); f.close(); if(n!=sizeof(pc)) return false; if(!applyFromPersist(pc)) return false; wsLog("config: loaded from FS"); return true; }
 bool initFilesystemAndConfig(){ if(!LittleFS.begin()){ if(!LittleFS.format()||!LittleFS.begin()){ wsLog("fs: init failed"); return false; } } if(loadConfigFS()) return true; setDefaults(); if(saveConfigFS()) return true; if(!LittleFS.format()||!LittleFS.begin()) return false; setDefaults(); if(saveConfigFS()) return true; return false; }
 
 // ================== SFINAE helper ==================
@@ -268,19 +408,22 @@ template <class M> inline auto setSlaveIdIfAvailable(M& m,uint8_t id)->decltype(
 inline void setSlaveIdIfAvailable(...){}
 
 // ================== Modbus map ==================
-enum : uint16_t { ISTS_DI_BASE=1, ISTS_CH_BASE=50, ISTS_LED_BASE=90, ISTS_ZC_OK_BASE=120 };
+enum : uint16_t { ISTS_DI_BASE=1, ISTS_CH_BASE=50, ISTS_LED_BASE=90, ISTS_ZC_OK_BASE=120, ISTS_PLL_LOCK_BASE=130 };
 enum : uint16_t { CMD_CH_ON_BASE=200, CMD_CH_OFF_BASE=210, CMD_DI_EN_BASE=300, CMD_DI_DIS_BASE=320 };
-enum : uint16_t { HREG_DIM_LEVEL_BASE=400, HREG_DIM_LO_BASE=410, HREG_DIM_HI_BASE=420, HREG_FREQ_X100_BASE=430, HREG_PCT_X10_BASE=440, HREG_LOADTYPE_BASE=460, HREG_CUTMODE_BASE=470, HREG_PRESET_BASE=480 };
+enum : uint16_t { HREG_DIM_LEVEL_BASE=400, HREG_DIM_LO_BASE=410, HREG_DIM_HI_BASE=420, HREG_FREQ_X100_BASE=430, HREG_PCT_X10_BASE=440, HREG_LOADTYPE_BASE=460, HREG_CUTMODE_BASE=470, HREG_PRESET_BASE=480,
+                  HREG_FADE_MS_BASE=490, HREG_FADE_RATE_BASE=500, HREG_LEVEL16_BASE=520 };
 
 // ================== Fw decls (helpers) ==================
 void applyModbusSettings(uint8_t addr,uint32_t baud);
 void handleValues(JSONVar values);
 void handleUnifiedConfig(JSONVar obj);
 void handleCommand(JSONVar obj);
+void handleHello(JSONVar obj);
 JSONVar LedConfigListFromCfg();
 void processModbusCommandPulses();
 void applyActionToTarget(uint8_t target,uint8_t action,uint32_t now);
 void clampAndSetLevel(uint8_t ch,int value);
+void clampAndSetLevel16(uint8_t ch,int value);
 
 // ================== DI press detection runtime ==================
 struct DiRuntime{
@@ -326,30 +469,76 @@ static inline bool ledSrcActive(uint8_t src){
   }
 }
 
-// ============ COMPACT CONFIG SNAPSHOT SENDER ============
+// ============ TELEMETRY: FULL SNAPSHOT + RUNTIME DELTAS ============
+// Last values sent to the UI; deltas carry only fields that differ from these.
+struct TelemShadow {
+  uint8_t level[NUM_CH]; uint16_t level16[NUM_CH], pctX10[NUM_CH], freq[NUM_CH]; bool zcOk[NUM_CH], pll[NUM_CH];
+  bool di[NUM_DI], btn[NUM_BTN], led[NUM_LED];
+};
+TelemShadow telemSent{}; volatile bool fullSnapPending=true; volatile bool statsPending=false; uint32_t cfgSigSent=0;
+
+// Loop period / heap watermarks (reported by the "stats" command)
+uint32_t loopPrevUs=0, loopMaxUs=0, loopSumUs=0, loopCnt=0, heapMin=0xFFFFFFFFu;
+static inline void heapMark(){ const uint32_t h=rp2040.getFreeHeap(); if(h<heapMin) heapMin=h; }   // call with the JSON tree still alive
+
+static inline bool ledPhysState(int i){ const bool a=ledSrcActive(ledCfg[i].source); return (ledCfg[i].mode==0)?a:(a && blinkPhase); }
+
+// CRC of the persisted config with runtime fields masked; a change means the UI needs a full snapshot
+uint32_t configSignature(){
+  PersistConfig pc{}; captureToPersist(pc);
+  for(int i=0;i<NUM_CH;i++){ pc.chLevel[i]=0; pc.chLastNonZero[i]=0; pc.chPctX10[i]=0; pc.chLevel16[i]=0; }
+  pc.crc32=0; return crc32_update(0,(const uint8_t*)&pc,sizeof(pc));
+}
+
 void sendConfigSnapshot(){
   JSONVar cfg;
-  cfg["mb"]["address"]=(int)g_mb_address; cfg["mb"]["baud"]=(int)g_mb_baud;
-  for(int i=0;i<NUM_CH;i++){ JSONVar ch; ch["enabled"]=chCfg[i].enabled; ch["level"]=(int)chLevel[i]; ch["lower"]=(int)chLower[i]; ch["upper"]=(int)chUpper[i]; ch["loadType"]=(int)chLoadType[i]; ch["percent"]=(int)min((int)(chPctX10[i]/10),100); ch["cutMode"]=(int)chCutMode[i]; ch["preset"]=(int)chPreset[i]; ch["freq_x100"]=(int)freq_x100[i]; ch["zc_ok"]=zcOk[i]; cfg["ch"][i]=ch; }
-  for(int i=0;i<NUM_DI;i++){ JSONVar d; d["enabled"]=diCfg[i].enabled; d["invert"]=diCfg[i].inverted; d["switchType"]=diCfg[i].switchType; d["state"]=diRt[i].cur;
+  cfg["mb"]["address"]=(int)g_mb_address; cfg["mb"]["baud"]=(int)g_mb_baud; cfg["telemMs"]=(int)telemIntervalMs;
+  for(int i=0;i<NUM_CH;i++){ JSONVar ch; ch["enabled"]=chCfg[i].enabled; ch["level"]=(int)chLevel[i]; ch["lower"]=(int)chLower[i]; ch["upper"]=(int)chUpper[i]; ch["loadType"]=(int)chLoadType[i]; ch["percent"]=(int)min((int)(chPctX10[i]/10),100); ch["cutMode"]=(int)chCutMode[i]; ch["preset"]=(int)chPreset[i]; ch["level16"]=(int)chTarget16[i]; ch["fadeMs"]=(int)chFadeMs[i]; ch["fadeRate"]=(int)chFadeRate[i]; ch["freq_x100"]=(int)freq_x100[i]; ch["zc_ok"]=zcOk[i]; ch["pll_lock"]=(bool)zcPll[i].locked; cfg["ch"][i]=ch;
+    telemSent.level[i]=chLevel[i]; telemSent.level16[i]=chTarget16[i]; telemSent.pctX10[i]=chPctX10[i]; telemSent.freq[i]=freq_x100[i]; telemSent.zcOk[i]=zcOk[i]; telemSent.pll[i]=zcPll[i].locked; }
+  for(int i=0;i<NUM_DI;i++){ JSONVar d; d["enabled"]=diCfg[i].enabled; d["invert"]=diCfg[i].inverted; d["switchType"]=diCfg[i].switchType; d["state"]=diRt[i].cur; telemSent.di[i]=diRt[i].cur;
     d["press"]["short"]["action"]=diCfg[i].pressAction[PRESS_SHORT]; d["press"]["short"]["target"]=diCfg[i].pressTarget[PRESS_SHORT];
     d["press"]["long"]["action"]=diCfg[i].pressAction[PRESS_LONG]; d["press"]["long"]["target"]=diCfg[i].pressTarget[PRESS_LONG];
     d["press"]["doubleShort"]["action"]=diCfg[i].pressAction[PRESS_DOUBLE_SHORT]; d["press"]["doubleShort"]["target"]=diCfg[i].pressTarget[PRESS_DOUBLE_SHORT];
     d["press"]["shortThenLong"]["action"]=diCfg[i].pressAction[PRESS_SHORT_THEN_LONG]; d["press"]["shortThenLong"]["target"]=diCfg[i].pressTarget[PRESS_SHORT_THEN_LONG];
     d["latchMode"]=diCfg[i].latchMode; d["latchTarget"]=diCfg[i].latchTarget; cfg["di"][i]=d; }
-  for(int i=0;i<NUM_BTN;i++){ JSONVar b; b["action"]=btnCfg[i].action; b["state"]=buttonState[i]; cfg["btn"][i]=b; }
+  for(int i=0;i<NUM_BTN;i++){ JSONVar b; b["action"]=btnCfg[i].action; b["state"]=buttonState[i]; telemSent.btn[i]=buttonState[i]; cfg["btn"][i]=b; }
 
   // ----- LEDs in snapshot
   for(int i=0;i<NUM_LED;i++){
     JSONVar L;
     L["mode"]=ledCfg[i].mode;
     L["source"]=ledCfg[i].source;     // 0..8 per enum above
-    bool srcActive = ledSrcActive(ledCfg[i].source);
-    bool phys      = (ledCfg[i].mode==0) ? srcActive : (srcActive && (blinkPhase));
+    const bool phys=ledPhysState(i);
     L["state"]=phys;                   // preview of physical LED
+    telemSent.led[i]=phys;
     cfg["led"][i]=L;
   }
-  WebSerial.send("config", cfg);
+  heapMark(); WebSerial.send("config", cfg);
+}
+
+// Changed runtime fields only: {"ch":[{"i":0,"level":..}],"di":[{"i":2,"state":true}],...}; nothing sent if idle
+void sendTelemetryDelta(){
+  JSONVar d; bool any=false; int n=0;
+  for(int i=0;i<NUM_CH;i++){ JSONVar c; bool ch=false; TelemShadow &t=telemSent;
+    if(t.level[i]!=chLevel[i]){ t.level[i]=chLevel[i]; c["level"]=(int)chLevel[i]; ch=true; }
+    if(t.level16[i]!=chTarget16[i]){ t.level16[i]=chTarget16[i]; c["level16"]=(int)chTarget16[i]; ch=true; }
+    if(t.pctX10[i]!=chPctX10[i]){ t.pctX10[i]=chPctX10[i]; c["percent"]=(int)min((int)(chPctX10[i]/10),100); ch=true; }
+    if(t.freq[i]!=freq_x100[i]){ t.freq[i]=freq_x100[i]; c["freq_x100"]=(int)freq_x100[i]; ch=true; }
+    if(t.zcOk[i]!=zcOk[i]){ t.zcOk[i]=zcOk[i]; c["zc_ok"]=zcOk[i]; ch=true; }
+    const bool lk=zcPll[i].locked; if(t.pll[i]!=lk){ t.pll[i]=lk; c["pll_lock"]=lk; ch=true; }
+    if(ch){ c["i"]=i; d["ch"][n++]=c; any=true; } }
+  n=0; for(int i=0;i<NUM_DI;i++) if(telemSent.di[i]!=diRt[i].cur){ telemSent.di[i]=diRt[i].cur; JSONVar x; x["i"]=i; x["state"]=diRt[i].cur; d["di"][n++]=x; any=true; }
+  n=0; for(int i=0;i<NUM_BTN;i++) if(telemSent.btn[i]!=buttonState[i]){ telemSent.btn[i]=buttonState[i]; JSONVar x; x["i"]=i; x["state"]=buttonState[i]; d["btn"][n++]=x; any=true; }
+  n=0; for(int i=0;i<NUM_LED;i++){ const bool ph=ledPhysState(i); if(telemSent.led[i]!=ph){ telemSent.led[i]=ph; JSONVar x; x["i"]=i; x["state"]=ph; d["led"][n++]=x; any=true; } }
+  if(any){ heapMark(); WebSerial.send("delta", d); }
+}
+
+void sendLoopStats(){
+  JSONVar st; st["loop_max_us"]=(int)loopMaxUs; st["loop_avg_us"]=(int)(loopCnt?loopSumUs/loopCnt:0); st["loops"]=(int)loopCnt;
+  st["heap_free"]=(int)rp2040.getFreeHeap(); st["heap_min"]=(int)heapMin; st["telemMs"]=(int)(telemLegacy?TELEM_LEGACY_MS:telemIntervalMs);
+  st["mode"]=telemLegacy?"legacy":"delta";
+  for(int i=0;i<NUM_CH;i++){ st["gate_late"][i]=(int)gateLate[i]; st["gate_trunc"][i]=(int)gateTrunc[i]; st["gate_drop"][i]=(int)gateDrop[i]; st["zc_rejects"][i]=(int)zcRejectCnt[i]; }
+  WebSerial.send("stats", st); loopMaxUs=loopSumUs=loopCnt=0;
 }
 
 // ================== Setup ==================
@@ -365,6 +554,7 @@ void setup(){
   pinMode(ZC_PINS[0], INPUT_PULLUP); pinMode(ZC_PINS[1], INPUT_PULLUP);
   attachInterrupt(digitalPinToInterrupt(ZC_PINS[0]), zc_isr_ch0, FALLING);
   attachInterrupt(digitalPinToInterrupt(ZC_PINS[1]), zc_isr_ch1, FALLING);
+  const bool gateOk=gatePioBegin();
 
   setDefaults(); initFreqEstimator(); initFilesystemAndConfig();
 
@@ -378,8 +568,9 @@ void setup(){
   for(uint16_t i=0;i<NUM_DI;i++)  mb.addIsts(ISTS_DI_BASE + i);
   for(uint16_t i=0;i<NUM_CH;i++)  mb.addIsts(ISTS_CH_BASE + i);
   for(uint16_t i=0;i<NUM_LED;i++) mb.addIsts(ISTS_LED_BASE + i);
-  for(uint16_t i=0;i<NUM_CH;i++)  mb.addIsts(ISTS_ZC_OK_BASE + i);
-  for(uint16_t i=0;i<NUM_CH;i++){ mb.addHreg(HREG_DIM_LEVEL_BASE + i, chLevel[i]); mb.addHreg(HREG_DIM_LO_BASE + i, chLower[i]); mb.addHreg(HREG_DIM_HI_BASE + i, chUpper[i]); mb.addHreg(HREG_FREQ_X100_BASE + i, freq_x100[i]); mb.addHreg(HREG_PCT_X10_BASE + i, chPctX10[i]); mb.addHreg(HREG_LOADTYPE_BASE + i, chLoadType[i]); mb.addHreg(HREG_CUTMODE_BASE + i, chCutMode[i]); mb.addHreg(HREG_PRESET_BASE + i, chPreset[i]); }
+  for(uint16_t i=0;i<NUM_CH;i++){ mb.addIsts(ISTS_ZC_OK_BASE + i); mb.addIsts(ISTS_PLL_LOCK_BASE + i); }
+  for(uint16_t i=0;i<NUM_CH;i++){ mb.addHreg(HREG_DIM_LEVEL_BASE + i, chLevel[i]); mb.addHreg(HREG_DIM_LO_BASE + i, chLower[i]); mb.addHreg(HREG_DIM_HI_BASE + i, chUpper[i]); mb.addHreg(HREG_FREQ_X100_BASE + i, freq_x100[i]); mb.addHreg(HREG_PCT_X10_BASE + i, chPctX10[i]); mb.addHreg(HREG_LOADTYPE_BASE + i, chLoadType[i]); mb.addHreg(HREG_CUTMODE_BASE + i, chCutMode[i]); mb.addHreg(HREG_PRESET_BASE + i, chPreset[i]);
+    mb.addHreg(HREG_FADE_MS_BASE + i, chFadeMs[i]); mb.addHreg(HREG_FADE_RATE_BASE + i, chFadeRate[i]); mb.addHreg(HREG_LEVEL16_BASE + i, chTarget16[i]); }
   for(uint16_t i=0;i<NUM_CH;i++){ mb.addCoil(CMD_CH_ON_BASE + i);  mb.setCoil(CMD_CH_ON_BASE + i, false); }
   for(uint16_t i=0;i<NUM_CH;i++){ mb.addCoil(CMD_CH_OFF_BASE + i); mb.setCoil(CMD_CH_OFF_BASE + i, false); }
   for(uint16_t i=0;i<NUM_DI;i++){ mb.addCoil(CMD_DI_EN_BASE + i);  mb.setCoil(CMD_DI_EN_BASE + i, false); }
@@ -391,7 +582,10 @@ void setup(){
   WebSerial.on("values",  handleValues);
   WebSerial.on("Config",  handleUnifiedConfig);
   WebSerial.on("command", handleCommand);
+  WebSerial.on("hello",   handleHello);
+  WebSerial.on("getAll",  handleHello);
 
+  if(!gateOk) wsLog("gate: PIO unavailable, outputs held off");
   wsLog("boot: ready");
 }
 
@@ -401,7 +595,12 @@ void handleCommand(JSONVar obj){
   if(act=="save"){ wsLog("cmd: save"); saveConfigFS(); }
   else if(act=="load"){ wsLog("cmd: load"); if(loadConfigFS()){ applyModbusSettings(g_mb_address,g_mb_baud); } }
   else if(act=="factory"){ wsLog("cmd: factory"); setDefaults(); if(saveConfigFS()){ applyModbusSettings(g_mb_address,g_mb_baud); } }
+  else if(act=="telemetry"){ if(obj.hasOwnProperty("ms")){ telemIntervalMs=(uint16_t)constrain((int)obj["ms"],(int)TELEM_MIN_MS,(int)TELEM_MAX_MS); }
+    if(obj.hasOwnProperty("legacy")){ telemLegacy=(bool)obj["legacy"]; wsLog(String("telemetry: ")+(telemLegacy?"legacy 1 s snapshot":"delta")); }
+    fullSnapPending=true; }
+  else if(act=="stats"){ statsPending=true; if(obj.hasOwnProperty("reset") && (bool)obj["reset"]){ loopMaxUs=loopSumUs=loopCnt=0; heapMin=0xFFFFFFFFu; } }
 }
+void handleHello(JSONVar){ fullSnapPending=true; }
 void applyModbusSettings(uint8_t addr,uint32_t baud){
   bool baudChanged=((uint32_t)modbusStatus["baud"]!=baud); if(baudChanged){ Serial2.end(); Serial2.begin(baud); mb.config(baud); }
   setSlaveIdIfAvailable(mb, addr); g_mb_address=addr; g_mb_baud=baud; modbusStatus["address"]=g_mb_address; modbusStatus["baud"]=g_mb_baud;
@@ -436,10 +635,13 @@ void handleUnifiedConfig(JSONVar obj){
     for(int i=0;i<NUM_CH && i<list.length();i++){
       chCfg[i].enabled=(bool)list[i]["enabled"];
       int lo=(int)list[i]["lower"], hi=(int)list[i]["upper"]; setThresholds(i,lo,hi);
-      if(list[i].hasOwnProperty("loadType")){ int lt=(int)list[i]["loadType"]; chLoadType[i]=(uint8_t)constrain(lt,0,2); mb.setHreg(HREG_LOADTYPE_BASE + i, chLoadType[i]); }
+      if(list[i].hasOwnProperty("loadType")){ int lt=(int)list[i]["loadType"]; chLoadType[i]=(uint8_t)constrain(lt,0,2); buildLevelLut(i); mb.setHreg(HREG_LOADTYPE_BASE + i, chLoadType[i]); }
+      if(list[i].hasOwnProperty("fadeMs")){ chFadeMs[i]=(uint16_t)constrain((int)list[i]["fadeMs"],0,60000); mb.setHreg(HREG_FADE_MS_BASE + i, chFadeMs[i]); }
+      if(list[i].hasOwnProperty("fadeRate")){ chFadeRate[i]=(uint16_t)constrain((int)list[i]["fadeRate"],0,10000); mb.setHreg(HREG_FADE_RATE_BASE + i, chFadeRate[i]); }
       if(list[i].hasOwnProperty("cutMode")){ int cm=(int)list[i]["cutMode"]; chCutMode[i]=(uint8_t)constrain(cm,0,1); mb.setHreg(HREG_CUTMODE_BASE + i, chCutMode[i]); }
       if(list[i].hasOwnProperty("preset")){ int pv=(int)list[i]["preset"]; pv=constrain(pv,0,255); chPreset[i]=(uint8_t)pv; clampAndApplyPreset(i); mb.setHreg(HREG_PRESET_BASE + i, chPreset[i]); }
-      if(list[i].hasOwnProperty("percent")){ double pct=(double)list[i]["percent"]; if((LoadType)chLoadType[i]!=LOAD_KEY) pct=constrain(pct,0.0,100.0); chPctX10[i]=(uint16_t)constrain((int)lround(pct*10.0),0,1000); mb.setHreg(HREG_PCT_X10_BASE + i, chPctX10[i]); uint8_t lvl=mapPercentToLevel(i,pct); setLevelDirect(i,lvl); wsLog("channel["+String(i)+"]: percent="+String((int)pct)+" -> level="+String(lvl)); }
+      if(list[i].hasOwnProperty("percent")){ double pct=(double)list[i]["percent"]; if((LoadType)chLoadType[i]!=LOAD_KEY) pct=constrain(pct,0.0,100.0); chPctX10[i]=(uint16_t)constrain((int)lround(pct*10.0),0,1000); mb.setHreg(HREG_PCT_X10_BASE + i, chPctX10[i]); const uint16_t t=percentX10ToLevel16(i,chPctX10[i]); setLevelTarget16(i,t); wsLog("channel["+String(i)+"]: percent="+String((int)pct)+" -> level16="+String(t)); }
+      else if(list[i].hasOwnProperty("level16")){ clampAndSetLevel16(i,(int)list[i]["level16"]); }
       else if(list[i].hasOwnProperty("level")){ int lvl=(int)list[i]["level"]; clampAndSetLevel(i,lvl); }
     }
     changed=true; wsLog("cfg: channels");
@@ -466,7 +668,7 @@ static inline void setThresholds(uint8_t ch,int lower,int upper){
   if(ch>=NUM_CH) return; lower=constrain(lower,0,255); upper=constrain(upper,0,255); if(upper<lower) upper=lower;
   if((uint8_t)lower==chLower[ch] && (uint8_t)upper==chUpper[ch]) return;
   chLower[ch]=(uint8_t)lower; chUpper[ch]=(uint8_t)upper; chLastNonZero[ch]=constrain(chLastNonZero[ch],chLower[ch],chUpper[ch]); clampAndApplyPreset(ch);
-  if(chLevel[ch]>0){ if(chLevel[ch]<chLower[ch]) chLevel[ch]=chLower[ch]; else if(chLevel[ch]>chUpper[ch]) chLevel[ch]=chUpper[ch]; }
+  buildLevelLut(ch); const uint16_t t=chTarget16[ch]; if(t>0) setLevelTarget16(ch,constrain(t,lvl16Lower(ch),lvl16Upper(ch)));
   mb.setHreg(HREG_DIM_LO_BASE + ch, chLower[ch]); mb.setHreg(HREG_DIM_HI_BASE + ch, chUpper[ch]); mb.setHreg(HREG_DIM_LEVEL_BASE + ch, chLevel[ch]);
   wsLog("channel["+String(ch)+"]: range=["+String(chLower[ch])+".."+String(chUpper[ch])+"]");
 }
@@ -475,6 +677,11 @@ void clampAndSetLevel(uint8_t ch,int value){
   if(value==0) out=0; else if(value>chUpper[ch]) out=chUpper[ch]; else if(value>=chLower[ch]) out=(uint8_t)value; else out=(prev==0)?chLower[ch]:0;
   setLevelDirect(ch,out); if(out!=prev){ wsLog("channel["+String(ch)+"]: level "+String(prev)+" -> "+String(out)); }
 }
+void clampAndSetLevel16(uint8_t ch,int value){
+  if(ch>=NUM_CH) return; value=constrain(value,0,65535); const uint16_t prev=chTarget16[ch]; uint16_t out;
+  if(value==0) out=0; else if(value>lvl16Upper(ch)) out=lvl16Upper(ch); else if(value>=lvl16Lower(ch)) out=(uint16_t)value; else out=(prev==0)?lvl16Lower(ch):0;
+  if(out!=prev){ setLevelTarget16(ch,out); wsLog("channel["+String(ch)+"]: level16 "+String(prev)+" -> "+String(out)); } else mb.setHreg(HREG_LEVEL16_BASE + ch, out);
+}
 
 // Old helper for mapped button target actions (toggle/pulse demo)
 void applyActionToTarget(uint8_t target,uint8_t action,uint32_t now){
@@ -529,6 +736,7 @@ static inline void onePingPongStep(int ch, int8_t &dir){
 
 // ================== Main loop ==================
 void loop(){
+  const uint32_t loopUs=micros(); if(loopPrevUs){ const uint32_t dt=loopUs-loopPrevUs; if(dt>loopMaxUs) loopMaxUs=dt; loopSumUs+=dt; loopCnt++; } loopPrevUs=loopUs;
   unsigned long now=millis();
   mb.task(); processModbusCommandPulses();
   if(now-lastBlinkToggle>=blinkPeriodMs){ lastBlinkToggle=now; blinkPhase=!blinkPhase; }
@@ -540,19 +748,14 @@ void loop(){
     else { if(zcFaultStreak[c]<255) zcFaultStreak[c]++; zcOkStreak[c]=0; if(zcOk[c] && zcFaultStreak[c]>=ZC_FAULT_STREAK_N){ zcOk[c]=false; mb.setIsts(ISTS_ZC_OK_BASE+c,false); wsLog("zc["+String(c)+"]: FAULT"); } }
   }
 
-  // Frequency estimator
+  // Frequency and gate precompute from the PLL half-period (the ISR already feeds gateHalfUs)
   for(uint8_t ch=0; ch<NUM_CH; ++ch){
     uint32_t seq=zcSampleSeq[ch]; if(seq!=lastSeqConsumed[ch]){
-      noInterrupts(); uint32_t half=zcHalfUsLatest[ch]; interrupts();
-      med3[ch][medIdx[ch]%MED_W]=half; medIdx[ch]++;
-      uint32_t a=med3[ch][0],b=med3[ch][1],c=med3[ch][2];
-      uint32_t med=(a>b)?((b>c)?b:(a>c?c:a)):((a>c)?a:(b>c?c:b));
-      avgSum[ch]-=avgBuf[ch][avgIdx[ch]]; avgBuf[ch][avgIdx[ch]]=med; avgSum[ch]+=med; avgIdx[ch]=(uint8_t)((avgIdx[ch]+1)%AVG_N);
-      double mean_half=corr_half_us((double)avgSum[ch]/(double)AVG_N);
-      double fx100=50000000.0/mean_half; if(fx100<0.0) fx100=0.0; if(fx100>65535.0) fx100=65535.0;
+      gatePrecompute(ch);
+      const uint32_t halfQ8=zcPll[ch].halfQ8; const bool lk=zcPll[ch].locked;
+      double fx100=50000000.0*256.0/corr_half_us((double)halfQ8); if(fx100<0.0) fx100=0.0; if(fx100>65535.0) fx100=65535.0;
       uint16_t prevF=freq_x100[ch]; freq_x100[ch]=(uint16_t)lround(fx100); if(freq_x100[ch]!=prevF) mb.setHreg(HREG_FREQ_X100_BASE + ch, freq_x100[ch]);
-      uint32_t stable_half=(uint32_t)lround(mean_half);
-      if(stable_half<HALF_MIN_US || stable_half>HALF_MAX_US) stable_half=HALF_US_DEFAULT; gateHalfUs[ch]=stable_half;
+      if(lk!=pllLockPrev[ch]){ pllLockPrev[ch]=lk; mb.setIsts(ISTS_PLL_LOCK_BASE+ch,lk); wsLog("zc["+String(ch)+"]: PLL "+String(lk?"locked":"unlocked")+" rejects="+String(zcRejectCnt[ch])); }
       lastSeqConsumed[ch]=seq;
     }
   }
@@ -757,8 +960,7 @@ void loop(){
 
   // LEDs drive + Modbus mirror
   for(int i=0;i<NUM_LED;i++){
-    bool srcActive = ledSrcActive(ledCfg[i].source);
-    bool phys = (ledCfg[i].mode==0) ? srcActive : (srcActive && blinkPhase);
+    const bool phys=ledPhysState(i);
     digitalWrite(LED_PINS[i], phys ? HIGH : LOW);
     mb.setIsts(ISTS_LED_BASE + i, phys);
   }
@@ -766,8 +968,13 @@ void loop(){
   // Channel "on" mirror
   for(int c=0;c<NUM_CH;c++){ bool onb=(chCfg[c].enabled && chLevel[c]>0); mb.setIsts(ISTS_CH_BASE + c, onb); }
 
-  // Periodic snapshot
-  if(millis()-lastSend>=sendInterval){ lastSend=millis(); WebSerial.check(); sendConfigSnapshot(); }
+  // Telemetry: full snapshot on request / config change, runtime deltas otherwise.
+  // Legacy mode reproduces the old unconditional 1 s snapshot under the same stats instrumentation.
+  if(telemLegacy){ if(millis()-lastSend>=TELEM_LEGACY_MS){ lastSend=millis(); WebSerial.check(); sendConfigSnapshot();
+    if(statsPending){ statsPending=false; sendLoopStats(); } } }
+  else if(millis()-lastSend>=telemIntervalMs){ lastSend=millis(); WebSerial.check();
+    const uint32_t sig=configSignature(); if(fullSnapPending || sig!=cfgSigSent){ fullSnapPending=false; cfgSigSent=sig; sendConfigSnapshot(); } else sendTelemetryDelta();
+    if(statsPending){ statsPending=false; sendLoopStats(); } }
 }
 
 // ================== Modbus helpers ==================
@@ -782,10 +989,13 @@ void processModbusCommandPulses(){
   }
   for(int c=0;c<NUM_CH;c++){
     uint16_t lo=mb.Hreg(HREG_DIM_LO_BASE + c), hi=mb.Hreg(HREG_DIM_HI_BASE + c); if(lo!=chLower[c] || hi!=chUpper[c]) setThresholds(c,(int)lo,(int)hi);
-    uint16_t lt=constrain((int)mb.Hreg(HREG_LOADTYPE_BASE + c),0,2); if(lt!=chLoadType[c]){ chLoadType[c]=(uint8_t)lt; cfgDirty=true; lastCfgTouchMs=millis(); wsLog("modbus: CH"+String(c+1)+" loadType="+String(lt)); }
+    uint16_t lt=constrain((int)mb.Hreg(HREG_LOADTYPE_BASE + c),0,2); if(lt!=chLoadType[c]){ chLoadType[c]=(uint8_t)lt; buildLevelLut(c); cfgDirty=true; lastCfgTouchMs=millis(); wsLog("modbus: CH"+String(c+1)+" loadType="+String(lt)); }
     uint16_t cm=constrain((int)mb.Hreg(HREG_CUTMODE_BASE + c),0,1); if(cm!=chCutMode[c]){ chCutMode[c]=(uint8_t)cm; cfgDirty=true; lastCfgTouchMs=millis(); wsLog("modbus: CH"+String(c+1)+" cutMode="+String(cm)); }
     uint16_t pv=constrain((int)mb.Hreg(HREG_PRESET_BASE + c),0,255); if(pv!=chPreset[c]){ chPreset[c]=(uint8_t)pv; clampAndApplyPreset(c); cfgDirty=true; lastCfgTouchMs=millis(); wsLog("modbus: CH"+String(c+1)+" preset="+String((int)chPreset[c])); }
-    uint16_t p10=mb.Hreg(HREG_PCT_X10_BASE + c); if(p10>1000 && chLoadType[c]!=LOAD_KEY) p10=1000; if(p10!=chPctX10[c]){ chPctX10[c]=p10; double pct=chPctX10[c]/10.0; uint8_t lvl=mapPercentToLevel(c,pct); setLevelDirect(c,lvl); cfgDirty=true; lastCfgTouchMs=millis(); wsLog("modbus: CH"+String(c+1)+" percent="+String(pct,1)+" -> level="+String(lvl)); }
+    uint16_t p10=mb.Hreg(HREG_PCT_X10_BASE + c); if(p10>1000 && chLoadType[c]!=LOAD_KEY) p10=1000; if(p10!=chPctX10[c]){ chPctX10[c]=p10; double pct=chPctX10[c]/10.0; const uint16_t t=percentX10ToLevel16(c,p10); setLevelTarget16(c,t); cfgDirty=true; lastCfgTouchMs=millis(); wsLog("modbus: CH"+String(c+1)+" percent="+String(pct,1)+" -> level16="+String(t)); }
+    uint16_t fm=min((int)mb.Hreg(HREG_FADE_MS_BASE + c),60000); if(fm!=chFadeMs[c]){ chFadeMs[c]=fm; cfgDirty=true; lastCfgTouchMs=millis(); wsLog("modbus: CH"+String(c+1)+" fadeMs="+String(fm)); }
+    uint16_t fr=min((int)mb.Hreg(HREG_FADE_RATE_BASE + c),10000); if(fr!=chFadeRate[c]){ chFadeRate[c]=fr; cfgDirty=true; lastCfgTouchMs=millis(); wsLog("modbus: CH"+String(c+1)+" fadeRate="+String(fr)); }
+    uint16_t l16=mb.Hreg(HREG_LEVEL16_BASE + c); if(l16!=chTarget16[c]){ clampAndSetLevel16(c,(int)l16); cfgDirty=true; lastCfgTouchMs=millis(); }
     uint16_t lvl=mb.Hreg(HREG_DIM_LEVEL_BASE + c); clampAndSetLevel(c,(int)lvl);
   }
 }
@@ -0,0 +1,72 @@
+// ================================================
+// File: zc_pll.h
+// DIM-420 zero-cross PLL: frequency + phase tracker and crossing predictor
+// No Arduino dependency; tests/dim_pll_test.cpp replays jittered, dropped and
+// glitch edge streams through it on a host.
+// ================================================
+#pragma once
+#include <stdint.h>
+
+// Per edge: e = measured - predicted crossing. Edges far ahead of the
+// prediction are rejected as noise; late ones are checked against whole
+// missed half-cycles. Accepted edges drive a PI loop on phase and half-period
+// (Q8 us). Once locked, the gate is timed from the predicted crossing. While
+// (re)acquiring it is timed from the edge itself, as before the PLL, but only
+// after PLL_ACQ_N accepted edges in a row each came a plausible half-period
+// (HALF_MIN_US..HALF_MAX_US) after the previous one. That keeps a channel
+// running through a relock or with jitter above PLL_LOCK_US; random noise edges
+// rarely pass it.
+constexpr uint32_t HALF_US_DEFAULT=10000u, HALF_MIN_US=7500, HALF_MAX_US=12000;
+constexpr int32_t  PLL_WIN_US=1000, PLL_LOCK_US=150;
+constexpr uint8_t  PLL_KP_SH=3, PLL_KI_SH=6, PLL_LOCK_N=16, PLL_UNLOCK_N=8;
+constexpr uint8_t  PLL_COAST_N=8;   // gate on prediction alone for at most this many half-cycles without an edge
+constexpr uint8_t  PLL_ACQ_N=4;     // plausible intervals in a row before edge-referenced gating while unlocked
+struct ZcPll { uint64_t nextUs, lastUs; uint32_t halfQ8; uint8_t good, bad, ivRun; bool have, locked; };
+
+static inline int32_t pllClamp(int32_t v,int32_t lo,int32_t hi){ return v<lo?lo:(v>hi?hi:v); }
+
+// One PLL update for an edge at t; false = edge rejected
+static inline bool pllEdge(volatile ZcPll &p,uint64_t t){
+  const uint64_t last=p.lastUs; p.lastUs=t;
+  if(!p.have){ p.have=true; p.halfQ8=HALF_US_DEFAULT<<8; p.nextUs=t+HALF_US_DEFAULT; p.good=p.bad=p.ivRun=0; p.locked=false; return true; }
+  const uint64_t iv=t-last; const bool ivOk=(iv>=HALF_MIN_US && iv<=HALF_MAX_US);
+  const int32_t half=(int32_t)(p.halfQ8>>8); int32_t e=(int32_t)(int64_t)(t-p.nextUs);
+  if(e>PLL_WIN_US && e<8*half){ const int32_t k=(e+half/2)/half; e-=k*half; p.nextUs+=(uint64_t)(k*half); }   // dropped crossings
+  if(e>PLL_WIN_US || e< -PLL_WIN_US){
+    if(p.locked && ++p.bad<PLL_UNLOCK_N){ p.lastUs=last; return false; }                                   // spurious edge
+    if(ivOk) p.halfQ8=(uint32_t)iv<<8;                                                                       // (re)acquire
+    p.locked=false; p.good=p.bad=0; p.ivRun=ivOk?(uint8_t)(p.ivRun+(p.ivRun<PLL_ACQ_N)):0; p.nextUs=t+(p.halfQ8>>8); return true;
+  }
+  const int32_t pe=e>>PLL_KP_SH;
+  p.halfQ8=(uint32_t)pllClamp((int32_t)p.halfQ8+e*(1<<(8-PLL_KI_SH)),(int32_t)(HALF_MIN_US<<8),(int32_t)(HALF_MAX_US<<8));
+  p.nextUs+=(int64_t)pe+(p.halfQ8>>8);
+  p.ivRun=ivOk?(uint8_t)(p.ivRun+(p.ivRun<PLL_ACQ_N)):0;
+  if(e<=PLL_LOCK_US && e>=-PLL_LOCK_US){ p.bad=0; if(!p.locked && ++p.good>=PLL_LOCK_N) p.locked=true; }
+  else if(p.locked && ++p.bad>=PLL_UNLOCK_N){ p.locked=false; p.good=0; }
+  return true;
+}
+
+// Predicted crossing nearest t: whole half-periods from the next unobserved
+// crossing, so it coasts over missing edges and picks up the correction from
+// an edge that arrived just before t.
+static inline uint64_t pllCrossingNear(const volatile ZcPll &p,uint64_t t){
+  const int64_t half=(int64_t)(p.halfQ8>>8); const int64_t d=(int64_t)(t-p.nextUs);
+  const int64_t k=(d>=0)?(d+half/2)/half:-((-d+half/2)/half);
+  return p.nextUs+(uint64_t)(k*half);
+}
+
+// Gate may run on crossing c: locked, and the last accepted edge is recent
+static inline bool pllGateOk(const volatile ZcPll &p,uint64_t c){
+  return p.locked && (int64_t)(c-p.lastUs) <= (int64_t)PLL_COAST_N*(int64_t)(p.halfQ8>>8);
+}
+
+// Edge just accepted by pllEdge() may gate its own crossing (acquisition
+// fallback; the caller only uses it while the gate timer is idle)
+static inline bool pllEdgeGateOk(const volatile ZcPll &p){ return p.ivRun>=PLL_ACQ_N; }
+
+// Gate timer step for a callback scheduled at 'at' (leadUs ahead of its crossing):
+// crossing to gate this half-cycle and the next callback time; false = stop
+static inline bool pllGateStep(const volatile ZcPll &p,uint64_t at,uint32_t leadUs,uint64_t &c,uint64_t &next){
+  c=pllCrossingNear(p,at+leadUs); if(!pllGateOk(p,c)) return false;
+  next=c+(p.halfQ8>>8)-leadUs; return true;
+}
@@ -2,9 +2,12 @@
 #include <ModbusSerial.h>
 #include <SimpleWebSerial.h>
 #include <Arduino_JSON.h>
+#include <LittleFS.h>
 #include <utility>
+#include "pico/time.h"
 
-#include "atm90e32.h"   // your external driver
+#include <ATM90E32.h>   // shared driver: /libraries/ATM90E32
+#include "src/enm_alarm.h"
 
 // ================== UART2 (RS-485 / Modbus) ==================
 #define TX2 4
@@ -24,13 +27,22 @@ static const uint8_t NUM_BTN = 4;
 
 // ================== Config & runtime ==================
 struct RlyCfg { bool enabled; bool inverted; };
-struct LedCfg { uint8_t mode; uint8_t source; }; // mode:0 steady,1 blink; source:0 none,5 relay1,6 relay2
+struct LedCfg { uint8_t mode; uint8_t source; }; // mode:0 steady,1 blink; source:0 none,5 relay1,6 relay2,10..25 alarms
 struct BtnCfg { uint8_t action; };               // 0 none, 5 relay1 toggle, 6 relay2 toggle
 
 static RlyCfg rlyCfg[NUM_RLY];
 static LedCfg ledCfg[NUM_LED];
 static BtnCfg btnCfg[NUM_BTN];
 
+// ================== Alarms (table-driven, evaluated per snapshot) ==================
+// Rule types, alarmMetricValue() and alarmStep() live in src/enm_alarm.h.
+struct ChannelAlarmCfg { bool ackRequired; AlarmRule rule[AK_COUNT]; };
+struct RelayAlarmSrc { uint8_t ch; uint8_t kindsMask; };   // kindsMask 0 = relay not alarm-driven
+
+static ChannelAlarmCfg g_alarmCfg[CH_COUNT];
+static AlarmRuntime    g_alarmRt [CH_COUNT][AK_COUNT];
+static RelayAlarmSrc   rlyAlarm[NUM_RLY];
+
 static bool buttonState[NUM_BTN]  = {false,false,false,false};
 static bool buttonPrev[NUM_BTN]   = {false,false,false,false};
 static bool desiredRelay[NUM_RLY] = {false,false};
@@ -68,7 +80,26 @@ static const uint8_t ATM_CS   = 13;
 static const uint8_t ATM_PM1  = 2;
 static const uint8_t ATM_PM0  = 3;
 
-static ATM90E32 g_atm(SPI1, ATM_CS, ATM_PM0, ATM_PM1, 200000, SPI_MODE0, false);
+// IRQ0/IRQ1 (active high) -> GPIO; -1 = not wired, poll EMMIntState instead
+#define ATM_IRQ0_PIN  -1
+#define ATM_IRQ1_PIN  -1
+
+// SCK for normal mode (PM1:PM0=11). 200 kHz is the rate this board has been
+// validated at; faster clocks are not datasheet-backed here (see ATM90E32.h).
+// If raised, begin() verifies by read-back and falls back to 200 kHz.
+static const uint32_t ATM_SPI_HZ = ATM90E32::kSafeSpiHz;
+
+static ATM90E32 g_atm(SPI1, ATM_CS, ATM_PM0, ATM_PM1, ATM_SPI_HZ, SPI_MODE0, false);
+
+// ================== Metering scheduler ==================
+// Only meterTick() touches SPI for live values. It fills the back buffer and
+// then flips g_snapFront, so Modbus/WebSerial always read a complete snapshot.
+static MeterSnapshot g_snapBuf[2];
+static volatile uint8_t g_snapFront = 0;
+static bool     g_snapValid = false;
+static uint16_t g_meter_ms  = 100;          // 10..5000, HREG 400 / WebSerial "meter"
+static unsigned long lastMeterTick = 0;
+static inline const MeterSnapshot& meterSnap() { return g_snapBuf[g_snapFront]; }
 
 struct AtmCfg {
   uint16_t lineHz;   // 50/60
@@ -78,8 +109,174 @@ struct AtmCfg {
 };
 static AtmCfg g_atm_cfg;
 
+// ================== Energy engine ==================
+// ATM energy registers are clear-on-read deltas in 0.01 CF. They are drained
+// on a fixed schedule (and right before any begin(), which soft-resets the
+// chip) into 64-bit tick counters; Wh follow from the meter constant MC.
+enum : uint8_t { EK_AP=0, EK_AN, EK_RP, EK_RN, EK_SA, EK_COUNT };   // import/export P, Q, S
+enum : uint8_t { ECH_L1=0, ECH_L2, ECH_L3, ECH_TOT, ECH_COUNT };
+static uint64_t g_eTicks[EK_COUNT][ECH_COUNT];
+static uint32_t g_plconst32 = 0;
+static uint32_t g_MC_imp_per_kWh = 3200;
+static unsigned long lastEnergyPoll = 0;
+static const unsigned long ENERGY_POLL_MS = 1000;
+
+// ---- Energy journal ----
+// Append-only checkpoints in two alternating files. A file is only truncated
+// after the other one holds the newest record, so a power cut never loses both.
+static const char* const E_JNL_PATH[2] = { "/energy_a.jnl", "/energy_b.jnl" };
+static const uint32_t E_JNL_MAGIC    = 0x4A4E4D45UL; // 'EMNJ'
+static const uint16_t E_JNL_MAX_RECS = 128;          // records per file before rotating
+static const uint32_t E_JNL_MIN_MS   = 60000;        // never append more often than this
+static const uint32_t E_JNL_MAX_MS   = 900000;       // append at least this often while energy moves
+static const double   E_JNL_STEP_WH  = 10.0;         // ...or once any counter moved 10 Wh
+struct EnergyJnlRec {
+  uint32_t magic;
+  uint32_t seq;
+  uint64_t ticks[EK_COUNT][ECH_COUNT];
+  uint32_t crc32;
+} __attribute__((packed));
+static uint32_t eJnlSeq = 0;
+static uint8_t  eJnlFile = 0;
+static uint16_t eJnlRecs = 0;
+static uint32_t eJnlLastMs = 0;
+static uint32_t eJnlWrites = 0;
+static uint64_t eJnlLastTicks[EK_COUNT][ECH_COUNT];
+static bool     fsOk = false;
+
+// Sliced append (open, write, close on separate loop passes), same scheme as
+// the config save below; only one of the two runs at a time.
+enum : uint8_t { EJ_IDLE=0, EJ_OPEN, EJ_WRITE, EJ_CLOSE };
+static EnergyJnlRec eJnlRec;
+static File         eJnlF;
+static uint8_t      eJnlState  = EJ_IDLE;
+static uint8_t      eJnlFi     = 0;
+static bool         eJnlRotate = false;
+
+// Flash stall per LittleFS step. Slicing keeps mb.task()/metering running
+// between steps but not inside one: a step that programs or erases flash runs
+// with XIP off and core1 parked, so the whole chip waits. On the W25Q32JV a
+// close or rename costs a 4 KB sector erase when LittleFS needs a fresh block
+// (45 ms typ, 400 ms max per datasheet), two if a metadata pair compacts;
+// page programs are 0.4 ms typ / 3 ms max. Moving the work to core1 would not
+// help for the same reason. Measured values: energy JSON fsStallMaxUs/LastUs.
+static uint32_t fsStallLastUs = 0, fsStallMaxUs = 0;
+static inline void fsStallEnd(uint32_t t0) {
+  fsStallLastUs = micros() - t0;
+  if (fsStallLastUs > fsStallMaxUs) fsStallMaxUs = fsStallLastUs;
+}
+
+// ================== Persistence (LittleFS) ==================
+struct PersistConfig {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+
+  uint8_t  mb_address;
+  uint32_t mb_baud;
+
+  RlyCfg   rly[NUM_RLY];
+  LedCfg   led[NUM_LED];
+  BtnCfg   btn[NUM_BTN];
+
+  uint16_t atm_lineHz;
+  uint8_t  atm_sumAbs;
+  uint16_t atm_ucal;
+  M90PhaseCal cal[3];
+
+  uint16_t meter_ms;
+
+  ChannelAlarmCfg alarm[CH_COUNT];
+  RelayAlarmSrc   rly_alarm[NUM_RLY];
+
+  uint32_t crc32;
+} __attribute__((packed));
+
+static const uint32_t CFG_MAGIC   = 0x324D4E45UL;   // 'ENM2'
+static const uint16_t CFG_VERSION = 0x0001;
+static const char*    CFG_PATH    = "/enm_cfg.bin";
+static const char*    CFG_TMP     = "/enm_cfg.tmp";
+
+static bool           cfgDirty        = false;
+static unsigned long  lastCfgTouchMs  = 0;
+static const unsigned long CFG_AUTOSAVE_MS = 1500;
+
+// Sliced save: one LittleFS call per loop pass (open, CFG_SLICE bytes, close,
+// rename), so mb.task() and the meter keep running between them. The writes
+// only fill the LittleFS cache; close and rename do the flash work and can
+// stall for a sector erase (see fsStallMaxUs). The record is captured once at
+// start; the tmp file is renamed over CFG_PATH at the end.
+enum : uint8_t { CS_IDLE=0, CS_OPEN, CS_WRITE, CS_CLOSE, CS_COMMIT };
+static const size_t CFG_SLICE = 64;
+static PersistConfig cfgSavePc;
+static File          cfgSaveFile;
+static size_t        cfgSaveOff   = 0;
+static uint8_t       cfgSaveState = CS_IDLE;
+static uint32_t      cfgSaves     = 0;
+
+// ================== Power-quality event capture ==================
+// The chip latches EMMIntState0/1 on its own; IRQ0/IRQ1 only tell us when.
+// The ISR stamps the first edge in us, loop reads+clears the latches and
+// turns state edges into begin/end records in a fixed ring.
+enum : uint8_t { EV_SAG=1, EV_PHASE_LOSS, EV_FREQ_HI, EV_FREQ_LO, EV_REVERSE_P, EV_TYPES };
+enum : uint8_t { EVF_END=0x01, EVF_IRQ_TS=0x02, EVF_SHORT=0x04 };
+struct PqEvent {
+  uint32_t seq;
+  uint64_t t_us;        // time_us_64 at IRQ edge (EVF_IRQ_TS) or at the poll that saw it
+  uint8_t  type;        // EV_*
+  uint8_t  mask;        // bit0..2 = L1..L3, bit3 = total
+  uint8_t  flags;       // EVF_*
+};
+static const uint8_t  EVT_LOG_N   = 64;
+static const uint32_t EVT_POLL_MS = 10;        // fallback / end-of-event detection cadence
+static PqEvent  evtLog[EVT_LOG_N];
+static uint32_t evtSeq = 0;                    // total events ever logged
+static uint32_t evtSentSeq = 0;                // last seq pushed to WebSerial
+static uint8_t  evtActive[EV_TYPES];           // masks currently active (from EMMState1)
+static unsigned long evtLastPoll = 0;
+static volatile bool     evtIrq = false;
+static volatile uint64_t evtIrqUs = 0;
+#if ATM_IRQ0_PIN >= 0 || ATM_IRQ1_PIN >= 0
+void atmIrqIsr() {
+  if (!evtIrq) { evtIrqUs = time_us_64(); evtIrq = true; }
+}
+#endif
+
+// ================== Trend buffer (min/max/avg aggregation) ==================
+// Every snapshot is folded into an open 1 s bucket; closed 1 s buckets roll up
+// into 1 min buckets and those into 15 min (demand) buckets, each tier in its
+// own RAM ring. Values are int32 fixed point in the Modbus units:
+// U 0.01 V, I 0.001 A, P/Q/S 1 W/var/VA.
+enum : uint8_t { TR_U1=0, TR_U2, TR_U3, TR_I1, TR_I2, TR_I3, TR_P1, TR_P2, TR_P3, TR_PT, TR_QT, TR_ST, TR_CH };
+enum : uint8_t { TT_1S=0, TT_1M, TT_15M, TT_COUNT };
+struct TrendAgg {                     // open bucket / PLC window
+  int32_t  mn[TR_CH];
+  int32_t  mx[TR_CH];
+  int64_t  sum[TR_CH];
+  uint32_t n;
+};
+struct TrendBucket {                  // closed bucket (ring entry)
+  int32_t mn[TR_CH];
+  int32_t mx[TR_CH];
+  int32_t avg[TR_CH];
+};
+static const uint8_t  TREND_LEN[TT_COUNT]      = { 60, 60, 96 };   // 1 min, 1 h, 24 h of history
+static const uint8_t  TREND_FANIN[TT_COUNT]    = { 1, 60, 15 };    // ticks of the tier below per bucket
+static const uint16_t TREND_PERIOD_S[TT_COUNT] = { 1, 60, 900 };
+static const uint16_t TREND_JSON_MAX = 720;                        // numbers per "trend" reply
+static TrendBucket trRing1s[60], trRing1m[60], trRing15m[96];
+static TrendBucket* const trRing[TT_COUNT] = { trRing1s, trRing1m, trRing15m };
+static TrendAgg trAcc[TT_COUNT];      // open bucket per tier
+static uint8_t  trTicks[TT_COUNT];    // ticks of the tier below folded into trAcc[t]
+static uint32_t trSeq[TT_COUNT];      // buckets pushed per tier
+static TrendAgg trWin;                // since last window reset (coil / "trendReset")
+static unsigned long trWinStartMs = 0;
+static unsigned long trLastTickMs = 0;
+static uint8_t  trSelTier = TT_1S, trSelCh = TR_PT;   // HREG history view
+
 // ===== SAFE queued ATM apply (NO begin() IN CALLBACKS) =====
 static volatile bool atmApplyPending = false;
+static volatile bool atmCalPending   = false;   // gains/offsets only: applyCalibration(), no soft reset
 static unsigned long atmLastApplyMs = 0;
 static const unsigned long atmApplyMinIntervalMs = 300;
 static bool atmBusy = false;
@@ -89,6 +286,8 @@ static volatile bool dirtyRelayCfg = false;
 static volatile bool dirtyBtnCfg   = false;
 static volatile bool dirtyLedCfg   = false;
 static volatile bool dirtyAtmCfg   = false;
+static volatile bool dirtyAlarmCfg = false;
+static bool          alarmStateChanged = false;
 
 // ================== Outbound-send deferral (CRITICAL) ==================
 // Never call WebSerial.send() from handlers; only set these flags.
@@ -108,12 +307,71 @@ inline void setSlaveIdIfAvailable(...) {}
 enum : uint16_t {
   ISTS_BTN_BASE = 1,
   ISTS_RLY_BASE = 60,
-  ISTS_LED_BASE = 90
+  ISTS_LED_BASE = 90,
+  ISTS_ALARM_BASE = 120   // 120..131: ch*AK_COUNT + kind (L1,L2,L3,Tot x Alarm,Warning,Event)
 };
 
+// Input registers: live metering (same layout as RGB-621 enm_modbus)
+enum : uint16_t {
+  IREG_URMS_BASE = 100,   // 100..102  0.01 V
+  IREG_IRMS_BASE = 110,   // 110..112  0.001 A
+  IREG_P_BASE    = 200,   // 200..207  s32 W   (L1,L2,L3,Tot; high word first)
+  IREG_Q_BASE    = 210,   // 210..217  s32 var
+  IREG_S_BASE    = 220,   // 220..227  s32 VA
+  IREG_PF_BASE   = 240,   // 240..243  x1000 signed (L1,L2,L3,Tot)
+  IREG_ANG_BASE  = 244,   // 244..246  0.1 deg signed
+  IREG_FREQ      = 250,   // 0.01 Hz
+  IREG_TEMP      = 251,   // degC signed
+  IREG_PFUND_BASE= 260,   // 260..267  s32 W fundamental
+  IREG_PHARM_BASE= 268,   // 268..275  s32 W harmonic
+  IREG_THDU_BASE = 280,   // 280..282  THD+N U (0.01 %)
+  IREG_THDI_BASE = 283,   // 283..285  THD+N I (0.01 %)
+  IREG_DIAG_BASE = 360    // 360..365  EMMState0/1, EMMIntState0/1, CRCErrStatus, LastSPIData
+};
+
+// Holding registers
+enum : uint16_t {
+  HREG_METER_MS = 400,
+  HREG_TREND_TIER = 470,   // 0 = 1 s, 1 = 1 min, 2 = 15 min
+  HREG_TREND_CH   = 471    // TR_* channel for IREG 880..977
+};
+
+// Input registers: energies as u32 Wh/varh/VAh, high word first
+// AP 300..306, AN 308..314, RP 316..322, RN 324..330, S 332..338 (L1,L2,L3,Tot)
+enum : uint16_t {
+  IREG_E_BASE = 300
+};
+
+// Input registers: power-quality event log
+// 700 = events logged (u16 wrap), 701 = entries in ring,
+// 702.. newest first, 8 x 6 regs: seq, type<<8|mask, flags, t_ms hi, t_ms lo, t_us%1000
+enum : uint16_t {
+  IREG_EVT_COUNT = 700,
+  IREG_EVT_FILL  = 701,
+  IREG_EVT_BASE  = 702
+};
+static const uint8_t IREG_EVT_N = 8;
+
+// Input registers: trend buffer (s32 high word first, units as live values)
+// 800..871 window min,max,avg per channel (U1..U3, I1..I3, P1..P3, Ptot, Qtot, Stot)
+// 872 window samples (sat), 873 window age s (sat)
+// 880 buckets pushed in selected tier (u16 wrap), 881 fill,
+// 882..977 newest 16 buckets of the selected channel: min,max,avg
+enum : uint16_t {
+  IREG_TRW_BASE  = 800,
+  IREG_TRW_N     = 872,
+  IREG_TRW_AGE   = 873,
+  IREG_TRH_SEQ   = 880,
+  IREG_TRH_FILL  = 881,
+  IREG_TRH_BASE  = 882
+};
+static const uint8_t IREG_TRH_N = 16;
+
 enum : uint16_t {
   CMD_RLY_ON_BASE  = 200,
-  CMD_RLY_OFF_BASE = 210
+  CMD_RLY_OFF_BASE = 210,
+  CMD_ALARM_ACK_BASE = 220,  // 220..223 ack L1,L2,L3,Tot
+  CMD_TREND_RESET    = 230   // restart the min/max/avg window (IREG 800..873)
 };
 
 // ================== clamps ==================
@@ -128,6 +386,18 @@ static inline int16_t clamp_i16(int v) {
   return (int16_t)v;
 }
 
+static uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t k = 0; k < 8; k++)
+      crc = (crc >> 1) ^ (0xEDB88320UL & (-(int32_t)(crc & 1)));
+  }
+  return ~crc;
+}
+
+static inline void cfgTouch() { cfgDirty = true; lastCfgTouchMs = millis(); }
+
 // ================== Defaults ==================
 static void setAtmDefaults() {
   g_atm_cfg.lineHz = 50;
@@ -142,6 +412,18 @@ static void setAtmDefaults() {
   }
 }
 
+static void setAlarmDefaults() {
+  const AlarmRule off = { false, (uint8_t)AM_VOLTAGE, 0, 0, 0, 0, 0 };
+  for (int ch = 0; ch < CH_COUNT; ch++) {
+    g_alarmCfg[ch].ackRequired = false;
+    for (int k = 0; k < AK_COUNT; k++) {
+      g_alarmCfg[ch].rule[k] = off;
+      g_alarmRt[ch][k] = {false, false, false, false, 0};
+    }
+  }
+  for (int i = 0; i < NUM_RLY; i++) rlyAlarm[i] = { CH_TOT, 0 };
+}
+
 static void setDefaults() {
   for (int i = 0; i < NUM_RLY; i++) rlyCfg[i] = { true, false };
   for (int i = 0; i < NUM_LED; i++) ledCfg[i] = { 0, 0 };
@@ -155,6 +437,7 @@ static void setDefaults() {
   mb_req_baud    = g_mb_baud;
 
   setAtmDefaults();
+  setAlarmDefaults();
 }
 
 // ================== ATM apply (safe) ==================
@@ -168,9 +451,24 @@ static void atmApplyFromCfg_NOW() {
 static void queueAtmApply() {
   atmApplyPending = true;
   dirtyAtmCfg = true;
+  cfgTouch();
+  pendingAtmCfg = true;
+}
+
+// Phase gain/offset edits keep the energy registers: no begin()
+static void queueAtmCalApply() {
+  atmCalPending = true;
+  dirtyAtmCfg = true;
+  cfgTouch();
   pendingAtmCfg = true;
 }
 
+static void atmApplyCalOnly_NOW() {
+  M90PhaseCal tmp[3];
+  for (int i = 0; i < 3; i++) tmp[i] = g_atm_cfg.cal[i];
+  g_atm.applyCalibration(tmp);
+}
+
 // ================== JSON builders (built ONLY in loop) ==================
 static JSONVar relayEnableListToJson() {
   JSONVar a;
@@ -202,6 +500,7 @@ static JSONVar atmCfgToJson() {
   o["lineHz"] = (int)g_atm_cfg.lineHz;
   o["sumAbs"] = (int)g_atm_cfg.sumAbs;
   o["ucal"]   = (int)g_atm_cfg.ucal;
+  o["sample_ms"] = (int)g_meter_ms;
 
   JSONVar cal;
   for (int i = 0; i < 3; i++) {
@@ -216,6 +515,53 @@ static JSONVar atmCfgToJson() {
   return o;
 }
 
+static JSONVar alarmsCfgToJson() {
+  JSONVar o;
+  for (int ch = 0; ch < CH_COUNT; ch++) {
+    JSONVar c;
+    c["ack"] = g_alarmCfg[ch].ackRequired;
+    for (int k = 0; k < AK_COUNT; k++) {
+      const AlarmRule& r = g_alarmCfg[ch].rule[k];
+      JSONVar j;
+      j["enabled"] = r.enabled;
+      j["metric"]  = (int)r.metric;
+      j["min"]     = (double)r.min;
+      j["max"]     = (double)r.max;
+      j["hyst"]    = (double)r.hyst;
+      j["on_ms"]   = (int)r.onDelayMs;
+      j["off_ms"]  = (int)r.offDelayMs;
+      c[String(k)] = j;
+    }
+    o[ch] = c;
+  }
+  return o;
+}
+static JSONVar alarmsStateToJson() {
+  JSONVar o;
+  for (int ch = 0; ch < CH_COUNT; ch++) {
+    JSONVar c;
+    for (int k = 0; k < AK_COUNT; k++) {
+      JSONVar j;
+      j["cond"]    = g_alarmRt[ch][k].conditionNow;
+      j["active"]  = g_alarmRt[ch][k].active;
+      j["latched"] = g_alarmRt[ch][k].latched;
+      c[k] = j;
+    }
+    o[ch] = c;
+  }
+  return o;
+}
+static JSONVar relayAlarmToJson() {
+  JSONVar a;
+  for (int i = 0; i < NUM_RLY; i++) {
+    JSONVar j;
+    j["ch"]   = (int)rlyAlarm[i].ch;
+    j["mask"] = (int)rlyAlarm[i].kindsMask;
+    a[i] = j;
+  }
+  return a;
+}
+
 static void updateModbusStatusJson() {
   modbusStatus["address"] = (int)g_mb_address;
   modbusStatus["baud"]    = (int)g_mb_baud;
@@ -230,6 +576,9 @@ static void sendAllConfigEcho_NOW() {
   WebSerial.send("ButtonGroupList", buttonGroupListToJson());
   WebSerial.send("LedConfigList",   ledCfgListToJson());
   WebSerial.send("atmCfg",          atmCfgToJson());
+  WebSerial.send("AlarmsCfg",       alarmsCfgToJson());
+  WebSerial.send("AlarmRelayCfg",   relayAlarmToJson());
+  WebSerial.send("AlarmsState",     alarmsStateToJson());
 }
 
 // ================== Update-from-JSON (NO send, no hardware) ==================
@@ -287,46 +636,868 @@ static void applyModbusPendingIfNeeded() {
 
   mbLastApplyMs = now;
   mbBusy = false;
+  cfgTouch();
 
   pendingStatus = true;
   pendingMsgText = "OK: Modbus applied";
   pendingMsg = true;
 }
 
+// ================== Energy engine ==================
+// MC [imp/kWh] = 450e9 / PLconst; one register LSB is 0.01 CF = 10/MC Wh.
+static void energyMcRefresh() {
+  const uint32_t pl = g_atm.readPLconst();
+  g_plconst32 = pl;
+  const uint32_t mc = atm90::mcFromPLconst(pl);
+  if (mc) g_MC_imp_per_kWh = mc;
+}
+
+static inline double energyTicksToWh(uint64_t ticks) {
+  return atm90::ticksToWh(ticks, g_MC_imp_per_kWh);
+}
+
+static inline uint32_t energyWhU32(uint64_t ticks) {
+  const double wh = energyTicksToWh(ticks);
+  return (wh >= 4294967295.0) ? 0xFFFFFFFFUL : (uint32_t)wh;
+}
+
+static void energyPublish() {
+  for (int k = 0; k < EK_COUNT; k++) {
+    for (int c = 0; c < ECH_COUNT; c++) {
+      const uint32_t v   = energyWhU32(g_eTicks[k][c]);
+      const uint16_t reg = IREG_E_BASE + (uint16_t)((k * ECH_COUNT + c) * 2);
+      mb.Ireg(reg + 0, (uint16_t)(v >> 16));
+      mb.Ireg(reg + 1, (uint16_t)(v & 0xFFFF));
+    }
+  }
+}
+
+// Drain the 20 clear-on-read registers (chip order T,A,B,C per kind).
+static void energyPoll() {
+  uint16_t r[ATM90E32::kEnergyRegs];
+  g_atm.readEnergyRegs(r);
+  for (int k = 0; k < EK_COUNT; k++) {
+    g_eTicks[k][ECH_TOT] += r[k * 4 + 0];
+    g_eTicks[k][ECH_L1]  += r[k * 4 + 1];
+    g_eTicks[k][ECH_L2]  += r[k * 4 + 2];
+    g_eTicks[k][ECH_L3]  += r[k * 4 + 3];
+  }
+  energyPublish();
+}
+
+// Captures the counters now; fsStep() then writes the record one
+// energyJnlOp() step per loop pass.
+static bool energyJnlStart() {
+  if (!fsOk || eJnlState != EJ_IDLE) return false;
+  eJnlRec = EnergyJnlRec{}; eJnlRec.magic = E_JNL_MAGIC; eJnlRec.seq = eJnlSeq + 1;
+  memcpy(eJnlRec.ticks, g_eTicks, sizeof(eJnlRec.ticks));
+  eJnlRec.crc32 = 0; eJnlRec.crc32 = crc32_update(0, (const uint8_t*)&eJnlRec, sizeof(eJnlRec));
+
+  eJnlRotate = (eJnlRecs >= E_JNL_MAX_RECS);
+  eJnlFi     = eJnlRotate ? (uint8_t)(eJnlFile ^ 1) : eJnlFile;
+  eJnlLastMs = millis();                               // rate limit counts from the capture
+  memcpy(eJnlLastTicks, g_eTicks, sizeof(eJnlLastTicks));
+  eJnlState  = EJ_OPEN;
+  return true;
+}
+
+static void energyJnlFail() {
+  if (eJnlF) eJnlF.close();
+  eJnlState = EJ_IDLE;
+  pendingMsgText = "energy journal: write failed";
+  pendingMsg = true;
+}
+
+// Advances the append by one LittleFS operation.
+static void energyJnlOp() {
+  switch (eJnlState) {
+    case EJ_OPEN:
+      eJnlF = LittleFS.open(E_JNL_PATH[eJnlFi], eJnlRotate ? "w" : "a");
+      if (!eJnlF) { energyJnlFail(); return; }
+      eJnlState = EJ_WRITE;
+      return;
+    case EJ_WRITE:
+      if (eJnlF.write((const uint8_t*)&eJnlRec, sizeof(eJnlRec)) != sizeof(eJnlRec)) { energyJnlFail(); return; }
+      eJnlState = EJ_CLOSE;
+      return;
+    case EJ_CLOSE:
+      eJnlF.close();
+      eJnlSeq = eJnlRec.seq; eJnlFile = eJnlFi; eJnlRecs = eJnlRotate ? 1 : (uint16_t)(eJnlRecs + 1);
+      eJnlWrites++;
+      eJnlState = EJ_IDLE;
+      return;
+    default:
+      return;
+  }
+}
+
+// Restores g_eTicks from the newest valid record of either file.
+static bool energyJnlLoad() {
+  bool found = false;
+  for (uint8_t fi = 0; fi < 2 && fsOk; fi++) {
+    File f = LittleFS.open(E_JNL_PATH[fi], "r");
+    if (!f) continue;
+    uint16_t recs = 0;
+    EnergyJnlRec r{};
+    while (f.read((uint8_t*)&r, sizeof(r)) == sizeof(r)) {
+      recs++;
+      EnergyJnlRec tmp = r; const uint32_t crc = tmp.crc32; tmp.crc32 = 0;
+      if (r.magic != E_JNL_MAGIC || crc32_update(0, (const uint8_t*)&tmp, sizeof(tmp)) != crc) continue;
+      if (found && (int32_t)(r.seq - eJnlSeq) <= 0) continue;
+      found = true; eJnlSeq = r.seq; eJnlFile = fi;
+      memcpy(g_eTicks, r.ticks, sizeof(g_eTicks));
+    }
+    f.close();
+    if (found && eJnlFile == fi) eJnlRecs = recs;
+  }
+  memcpy(eJnlLastTicks, g_eTicks, sizeof(eJnlLastTicks));
+  eJnlLastMs = millis();
+  return found;
+}
+
+// Rate-limited checkpoint; force=true skips the limits.
+static void energyJnlCheckpoint(bool force) {
+  const uint32_t now = millis();
+  if (!force) {
+    if ((uint32_t)(now - eJnlLastMs) < E_JNL_MIN_MS) return;
+    uint64_t moved = 0;
+    for (int k = 0; k < EK_COUNT; k++)
+      for (int c = 0; c < ECH_COUNT; c++) {
+        const uint64_t d = g_eTicks[k][c] - eJnlLastTicks[k][c];
+        if (d > moved) moved = d;
+      }
+    if (moved == 0) return;
+    if (energyTicksToWh(moved) < E_JNL_STEP_WH && (uint32_t)(now - eJnlLastMs) < E_JNL_MAX_MS) return;
+  }
+  energyJnlStart();
+}
+
+static JSONVar energyToJson() {
+  static const char* const KEYS[EK_COUNT] = { "ap_Wh", "an_Wh", "rp_varh", "rn_varh", "s_VAh" };
+  JSONVar o;
+  for (int k = 0; k < EK_COUNT; k++) {
+    JSONVar a;
+    for (int c = 0; c < ECH_COUNT; c++) a[c] = energyTicksToWh(g_eTicks[k][c]);
+    o[KEYS[k]] = a;
+  }
+  o["MC_imp_per_kWh"] = (int)g_MC_imp_per_kWh;
+  o["PLconst32"]      = (double)g_plconst32;
+  o["jnlWrites"]      = (int)eJnlWrites;
+  o["fsStallLastUs"]  = (double)fsStallLastUs;
+  o["fsStallMaxUs"]   = (double)fsStallMaxUs;
+  return o;
+}
+
+// ================== Metering scheduler ==================
+static inline uint16_t u16sat(float v) {
+  if (!(v > 0.0f)) return 0;
+  if (v >= 65535.0f) return 65535;
+  return (uint16_t)lroundf(v);
+}
+
+static inline int32_t s32sat(float v) {
+  if (v >= 2147483647.0f) return INT32_MAX;
+  if (v <= -2147483648.0f) return INT32_MIN;
+  return (int32_t)lroundf(v);
+}
+
+static inline void putI32(uint16_t reg, int32_t x) {
+  mb.Ireg(reg + 0, (uint16_t)(((uint32_t)x >> 16) & 0xFFFF));
+  mb.Ireg(reg + 1, (uint16_t)((uint32_t)x & 0xFFFF));
+}
+
+static inline void putS32(uint16_t reg, float v) { putI32(reg, s32sat(v)); }
+
+static void meterPublishModbus(const MeterSnapshot& m) {
+  for (int i = 0; i < 4; i++) {
+    putS32(IREG_P_BASE     + 2*i, m.P_W[i]);
+    putS32(IREG_Q_BASE     + 2*i, m.Q_var[i]);
+    putS32(IREG_S_BASE     + 2*i, m.S_VA[i]);
+    putS32(IREG_PFUND_BASE + 2*i, m.Pfund_W[i]);
+    putS32(IREG_PHARM_BASE + 2*i, m.Pharm_W[i]);
+  }
+  for (int i = 0; i < 3; i++) {
+    mb.Ireg(IREG_THDU_BASE + i, m.THDN_U[i]);
+    mb.Ireg(IREG_THDI_BASE + i, m.THDN_I[i]);
+  }
+  for (int i = 0; i < 3; i++) {
+    mb.Ireg(IREG_URMS_BASE + i, u16sat(m.Urms_V[i] * 100.0f));
+    mb.Ireg(IREG_IRMS_BASE + i, u16sat(m.Irms_A[i] * 1000.0f));
+    mb.Ireg(IREG_ANG_BASE  + i, (uint16_t)m.PAngle[i]);
+  }
+  for (int i = 0; i < 4; i++) mb.Ireg(IREG_PF_BASE + i, (uint16_t)m.PFmean[i]);
+  mb.Ireg(IREG_FREQ, m.Freq_x100);
+  mb.Ireg(IREG_TEMP, (uint16_t)m.TempC);
+
+  mb.Ireg(IREG_DIAG_BASE + 0, m.diag.EMMState0);
+  mb.Ireg(IREG_DIAG_BASE + 1, m.diag.EMMState1);
+  mb.Ireg(IREG_DIAG_BASE + 2, m.diag.EMMIntState0);
+  mb.Ireg(IREG_DIAG_BASE + 3, m.diag.EMMIntState1);
+  mb.Ireg(IREG_DIAG_BASE + 4, m.diag.CRCErrStatus);
+  mb.Ireg(IREG_DIAG_BASE + 5, m.diag.LastSPIData);
+}
+
+// ================== Alarm engine ==================
+static inline bool ledSourceValid(int s) { return s == 0 || s == 5 || s == 6 || (s >= 10 && s <= 25); }
+
+// nowMs is millis() when the snapshot was taken; m.t_us is the 32-bit bus clock
+// (micros) and wraps every 71.6 min, so it is not used for delays.
+static void alarmsEvaluate(const MeterSnapshot& m, uint32_t nowMs) {
+  for (int ch = 0; ch < CH_COUNT; ch++) {
+    for (int k = 0; k < AK_COUNT; k++) {
+      const AlarmRule& r = g_alarmCfg[ch].rule[k];
+      const int32_t v = alarmMetricValue((uint8_t)ch, r.metric, m);
+      if (alarmStep(r, g_alarmRt[ch][k], g_alarmCfg[ch].ackRequired, v, nowMs)) alarmStateChanged = true;
+      mb.setIsts(ISTS_ALARM_BASE + ch * AK_COUNT + k, g_alarmRt[ch][k].active);
+    }
+  }
+}
+
+// Clears latched kinds whose condition is gone.
+static void alarmsAckChannel(uint8_t ch) {
+  if (ch >= CH_COUNT) return;
+  for (int k = 0; k < AK_COUNT; k++) {
+    if (!g_alarmRt[ch][k].conditionNow) {
+      g_alarmRt[ch][k].latched = false;
+      g_alarmRt[ch][k].active  = false;
+      mb.setIsts(ISTS_ALARM_BASE + ch * AK_COUNT + k, false);
+    }
+  }
+  alarmStateChanged = true;
+}
+
+static bool alarmAnyActive(uint8_t ch, uint8_t kindsMask) {
+  if (ch >= CH_COUNT) return false;
+  for (int k = 0; k < AK_COUNT; k++)
+    if ((kindsMask & (1u << k)) && g_alarmRt[ch][k].active) return true;
+  return false;
+}
+
+// LED sources 10..21: ch L1..Tot for Alarm(10..13)/Warning(14..17)/Event(18..21); 22..25 any kind
+static bool alarmLedSource(uint8_t src) {
+  if (src >= 10 && src <= 21) return alarmAnyActive((uint8_t)((src - 10) % 4), (uint8_t)(1u << ((src - 10) / 4)));
+  if (src >= 22 && src <= 25) return alarmAnyActive((uint8_t)(src - 22), 0b111);
+  return false;
+}
+
+// ================== Auto-calibration ==================
+// Driven by meter snapshots: apply start values -> settle -> average N ->
+// compute -> applyCalibration() -> settle -> average N again -> residual.
+//   offset: I (and optionally U) offsets at no load / no voltage;
+//           Xoffset = -(raw32 >> 7), raw32 = H<<16 | LSB of the RMS register.
+//   gain:   Xgain *= ref / measured per phase in 'phases'.
+enum : uint8_t { CAL_IDLE=0, CAL_SETTLE, CAL_ACCUM, CAL_VSETTLE, CAL_VACCUM };
+enum : uint8_t { CALM_OFFSET=0, CALM_GAIN };
+static const uint16_t CAL_N_MAX     = 200;
+static const uint32_t CAL_SETTLE_MS = 1000;
+struct CalJob {
+  uint8_t  state;
+  uint8_t  mode;
+  uint8_t  phases;        // bit0..2 = A..C
+  bool     doU;           // offset: include Uoffset (needs U = 0)
+  uint16_t n, got;
+  float    uRef, iRef;    // gain references (V, A); 0 = skip that quantity
+  uint32_t tMs;
+  double   sumU[3], sumI[3];
+  float    before[2][3];  // measured U/I averages before applying
+  float    after[2][3];
+  M90PhaseCal old[3];
+};
+static CalJob calJob = {};
+static bool   calResultPending = false;
+static const char* calErr = nullptr;
+
+static void calReset(uint8_t state) {
+  calJob.state = state;
+  calJob.got = 0;
+  calJob.tMs = millis();
+  for (int p = 0; p < 3; p++) { calJob.sumU[p] = 0; calJob.sumI[p] = 0; }
+}
+
+static void calStart(uint8_t mode, uint8_t phases, uint16_t n, float uRef, float iRef, bool doU) {
+  if (calJob.state != CAL_IDLE) { calErr = "cal: already running"; return; }
+  calJob.mode = mode; calJob.phases = phases & 0b111; calJob.n = n;
+  calJob.uRef = uRef; calJob.iRef = iRef; calJob.doU = doU;
+  memcpy(calJob.old, g_atm_cfg.cal, sizeof(calJob.old));
+
+  // offsets are measured with the old offsets removed
+  if (mode == CALM_OFFSET) {
+    for (int p = 0; p < 3; p++) {
+      if (!(calJob.phases & (1u << p))) continue;
+      g_atm_cfg.cal[p].Ioffset = 0;
+      if (doU) g_atm_cfg.cal[p].Uoffset = 0;
+    }
+    atmApplyCalOnly_NOW();
+  }
+  calReset(CAL_SETTLE);
+}
+
+static void calAbort(const char* why) {
+  memcpy(g_atm_cfg.cal, calJob.old, sizeof(g_atm_cfg.cal));
+  atmApplyCalOnly_NOW();
+  calJob.state = CAL_IDLE;
+  calErr = why;
+}
+
+static inline int16_t calOffsetFrom(double avgUnits, double unitPerH) {
+  const double raw32 = avgUnits / unitPerH * 65536.0;        // H<<16 | LSB
+  long v = -lround(raw32 / 128.0);
+  if (v < -32768) v = -32768;
+  if (v >  32767) v =  32767;
+  return (int16_t)v;
+}
+
+static void calCompute() {
+  for (int p = 0; p < 3; p++) {
+    if (!(calJob.phases & (1u << p))) continue;
+    const double u = calJob.before[0][p], i = calJob.before[1][p];
+    M90PhaseCal& c = g_atm_cfg.cal[p];
+    if (calJob.mode == CALM_OFFSET) {
+      c.Ioffset = calOffsetFrom(i, 0.001);
+      if (calJob.doU) c.Uoffset = calOffsetFrom(u, 0.01);
+    } else {
+      if (calJob.uRef > 0 && u > 0.0) c.Ugain = clamp_u16((int)lround(c.Ugain * (calJob.uRef / u)));
+      if (calJob.iRef > 0 && i > 0.0) c.Igain = clamp_u16((int)lround(c.Igain * (calJob.iRef / i)));
+    }
+  }
+  atmApplyCalOnly_NOW();
+}
+
+static void calOnSnapshot(const MeterSnapshot& m) {
+  if (calJob.state == CAL_IDLE) return;
+  const bool verify = (calJob.state == CAL_VSETTLE || calJob.state == CAL_VACCUM);
+
+  if (calJob.state == CAL_SETTLE || calJob.state == CAL_VSETTLE) {
+    if (millis() - calJob.tMs >= CAL_SETTLE_MS) calJob.state = verify ? CAL_VACCUM : CAL_ACCUM;
+    return;
+  }
+
+  for (int p = 0; p < 3; p++) { calJob.sumU[p] += m.Urms_V[p]; calJob.sumI[p] += m.Irms_A[p]; }
+  if (++calJob.got < calJob.n) return;
+
+  float (*dst)[3] = verify ? calJob.after : calJob.before;
+  for (int p = 0; p < 3; p++) {
+    dst[0][p] = (float)(calJob.sumU[p] / calJob.n);
+    dst[1][p] = (float)(calJob.sumI[p] / calJob.n);
+  }
+
+  if (!verify) {
+    if (calJob.mode == CALM_GAIN) {
+      for (int p = 0; p < 3; p++) {
+        if (!(calJob.phases & (1u << p))) continue;
+        if ((calJob.uRef > 0 && dst[0][p] < 1.0f) || (calJob.iRef > 0 && dst[1][p] < 0.01f)) {
+          calAbort("cal: no signal on a selected phase"); return;
+        }
+      }
+    }
+    calCompute();
+    calReset(CAL_VSETTLE);
+    return;
+  }
+
+  calJob.state = CAL_IDLE;
+  dirtyAtmCfg = true;
+  cfgTouch();
+  calResultPending = true;
+}
+
+static JSONVar calResultToJson() {
+  JSONVar o;
+  o["mode"]   = (calJob.mode == CALM_OFFSET) ? "offset" : "gain";
+  o["n"]      = (int)calJob.n;
+  JSONVar ph;
+  int n = 0;
+  for (int p = 0; p < 3; p++) {
+    if (!(calJob.phases & (1u << p))) continue;
+    JSONVar j;
+    j["phase"]    = p;
+    j["U_before"] = calJob.before[0][p];
+    j["I_before"] = calJob.before[1][p];
+    j["U_after"]  = calJob.after[0][p];
+    j["I_after"]  = calJob.after[1][p];
+    // residual: % of reference for gain, absolute reading for offset (should be ~0)
+    if (calJob.mode == CALM_GAIN) {
+      if (calJob.uRef > 0) j["U_err_pct"] = (calJob.after[0][p] - calJob.uRef) * 100.0 / calJob.uRef;
+      if (calJob.iRef > 0) j["I_err_pct"] = (calJob.after[1][p] - calJob.iRef) * 100.0 / calJob.iRef;
+    } else {
+      j["I_resid_A"] = calJob.after[1][p];
+      if (calJob.doU) j["U_resid_V"] = calJob.after[0][p];
+    }
+    j["Ugain"]   = (int)g_atm_cfg.cal[p].Ugain;
+    j["Igain"]   = (int)g_atm_cfg.cal[p].Igain;
+    j["Uoffset"] = (int)g_atm_cfg.cal[p].Uoffset;
+    j["Ioffset"] = (int)g_atm_cfg.cal[p].Ioffset;
+    ph[n++] = j;
+  }
+  o["phases"] = ph;
+  return o;
+}
+
+// ================== Trend buffer ==================
+static void trendAggReset(TrendAgg& a) {
+  for (int c = 0; c < TR_CH; c++) { a.mn[c] = INT32_MAX; a.mx[c] = INT32_MIN; a.sum[c] = 0; }
+  a.n = 0;
+}
+
+static void trendAggFold(TrendAgg& a, const int32_t* mn, const int32_t* mx, const int32_t* v) {
+  for (int c = 0; c < TR_CH; c++) {
+    if (mn[c] < a.mn[c]) a.mn[c] = mn[c];
+    if (mx[c] > a.mx[c]) a.mx[c] = mx[c];
+    a.sum[c] += v[c];
+  }
+  a.n++;
+}
+
+static inline int32_t trendAggAvg(const TrendAgg& a, int c) {
+  return a.n ? (int32_t)(a.sum[c] / (int64_t)a.n) : 0;
+}
+
+static void trendInit() {
+  for (int t = 0; t < TT_COUNT; t++) { trendAggReset(trAcc[t]); trTicks[t] = 0; trSeq[t] = 0; }
+  trendAggReset(trWin);
+  trWinStartMs = trLastTickMs = millis();
+}
+
+static void trendOnSnapshot(const MeterSnapshot& m) {
+  int32_t v[TR_CH];
+  for (int p = 0; p < 3; p++) {
+    v[TR_U1 + p] = s32sat(m.Urms_V[p] * 100.0f);
+    v[TR_I1 + p] = s32sat(m.Irms_A[p] * 1000.0f);
+    v[TR_P1 + p] = s32sat(m.P_W[p]);
+  }
+  v[TR_PT] = s32sat(m.P_W[3]);
+  v[TR_QT] = s32sat(m.Q_var[3]);
+  v[TR_ST] = s32sat(m.S_VA[3]);
+  trendAggFold(trAcc[TT_1S], v, v, v);
+  trendAggFold(trWin, v, v, v);
+}
+
+static void trendPublishWindow() {
+  for (int c = 0; c < TR_CH; c++) {
+    const uint16_t reg = IREG_TRW_BASE + c * 6;
+    putI32(reg + 0, trWin.n ? trWin.mn[c] : 0);
+    putI32(reg + 2, trWin.n ? trWin.mx[c] : 0);
+    putI32(reg + 4, trendAggAvg(trWin, c));
+  }
+  const uint32_t age = (millis() - trWinStartMs) / 1000;
+  mb.Ireg(IREG_TRW_N,   (uint16_t)(trWin.n > 65535 ? 65535 : trWin.n));
+  mb.Ireg(IREG_TRW_AGE, (uint16_t)(age > 65535 ? 65535 : age));
+}
+
+static void trendPublishHistory() {
+  const uint8_t  t    = trSelTier;
+  const uint32_t fill = (trSeq[t] < TREND_LEN[t]) ? trSeq[t] : TREND_LEN[t];
+  mb.Ireg(IREG_TRH_SEQ,  (uint16_t)trSeq[t]);
+  mb.Ireg(IREG_TRH_FILL, (uint16_t)fill);
+  for (uint8_t i = 0; i < IREG_TRH_N; i++) {
+    const uint16_t reg = IREG_TRH_BASE + i * 6;
+    if (i >= fill) { for (int k = 0; k < 6; k++) mb.Ireg(reg + k, 0); continue; }
+    const TrendBucket& b = trRing[t][(trSeq[t] - 1 - i) % TREND_LEN[t]];
+    putI32(reg + 0, b.mn[trSelCh]);
+    putI32(reg + 2, b.mx[trSelCh]);
+    putI32(reg + 4, b.avg[trSelCh]);
+  }
+}
+
+static void trendWindowReset() {
+  trendAggReset(trWin);
+  trWinStartMs = millis();
+  trendPublishWindow();
+}
+
+// Close the open bucket of tier t (if it saw data) and roll it into t+1
+static void trendClose(uint8_t t) {
+  TrendAgg& a = trAcc[t];
+  if (a.n) {
+    TrendBucket& b = trRing[t][trSeq[t] % TREND_LEN[t]];
+    for (int c = 0; c < TR_CH; c++) { b.mn[c] = a.mn[c]; b.mx[c] = a.mx[c]; b.avg[c] = trendAggAvg(a, c); }
+    trSeq[t]++;
+    if (t + 1 < TT_COUNT) trendAggFold(trAcc[t + 1], b.mn, b.mx, b.avg);
+    if (t == trSelTier) trendPublishHistory();
+  }
+  trendAggReset(a);
+  if (t + 1 < TT_COUNT && ++trTicks[t + 1] >= TREND_FANIN[t + 1]) {
+    trTicks[t + 1] = 0;
+    trendClose(t + 1);
+  }
+}
+
+// 1 s tick from loop; ticks missed while busy are dropped, not replayed
+static void trendService() {
+  const unsigned long now = millis();
+  if (now - trLastTickMs < 1000) return;
+  trLastTickMs += 1000;
+  if (now - trLastTickMs >= 1000) trLastTickMs = now;
+  trendClose(TT_1S);
+  trendPublishWindow();
+}
+
+// HREG 470/471 select the tier/channel mirrored into IREG 880..977
+static void serviceTrendHreg() {
+  uint16_t t = mb.Hreg(HREG_TREND_TIER), c = mb.Hreg(HREG_TREND_CH);
+  if (t >= TT_COUNT) { t = TT_COUNT - 1; mb.Hreg(HREG_TREND_TIER, t); }
+  if (c >= TR_CH)    { c = TR_CH - 1;    mb.Hreg(HREG_TREND_CH, c); }
+  if (t != trSelTier || c != trSelCh) {
+    trSelTier = (uint8_t)t;
+    trSelCh   = (uint8_t)c;
+    trendPublishHistory();
+  }
+}
+
+// {"tier":t, "period_s", "seq", "ch":c|-1, "stride", "d":[min,max,avg,...] oldest bucket first,
+//  "win":[min,max,avg per channel], "win_n", "win_s"}
+static JSONVar trendToJson(uint8_t t, int ch, uint16_t nReq) {
+  JSONVar o;
+  const uint8_t  c0     = (ch < 0) ? 0 : (uint8_t)ch;
+  const uint8_t  nCh    = (ch < 0) ? TR_CH : 1;
+  const uint16_t stride = (uint16_t)(nCh * 3);
+  uint32_t n = (trSeq[t] < TREND_LEN[t]) ? trSeq[t] : TREND_LEN[t];
+  if (nReq && n > nReq) n = nReq;
+  if (n * stride > TREND_JSON_MAX) n = TREND_JSON_MAX / stride;
+
+  JSONVar d;
+  int k = 0;
+  for (uint32_t i = n; i-- > 0; ) {
+    const TrendBucket& b = trRing[t][(trSeq[t] - 1 - i) % TREND_LEN[t]];
+    for (uint8_t c = c0; c < c0 + nCh; c++) { d[k++] = (double)b.mn[c]; d[k++] = (double)b.mx[c]; d[k++] = (double)b.avg[c]; }
+  }
+  JSONVar w;
+  k = 0;
+  for (int c = 0; c < TR_CH; c++) {
+    w[k++] = trWin.n ? (double)trWin.mn[c] : 0.0;
+    w[k++] = trWin.n ? (double)trWin.mx[c] : 0.0;
+    w[k++] = (double)trendAggAvg(trWin, c);
+  }
+  o["tier"]     = (int)t;
+  o["period_s"] = (int)TREND_PERIOD_S[t];
+  o["seq"]      = (double)trSeq[t];
+  o["ch"]       = ch;
+  o["stride"]   = (int)stride;
+  o["d"]        = d;
+  o["win"]      = w;
+  o["win_n"]    = (double)trWin.n;
+  o["win_s"]    = (double)((millis() - trWinStartMs) / 1000);
+  return o;
+}
+
+static void meterTick() {
+  const uint8_t back = (uint8_t)(g_snapFront ^ 1);
+  g_atm.readSnapshot(g_snapBuf[back]);
+  g_snapFront = back;
+  g_snapValid = true;
+  meterPublishModbus(g_snapBuf[back]);
+  alarmsEvaluate(g_snapBuf[back], millis());
+  calOnSnapshot(g_snapBuf[back]);
+  trendOnSnapshot(g_snapBuf[back]);
+}
+
+static uint16_t clampMeterMs(int v) {
+  if (v < 10)   v = 10;
+  if (v > 5000) v = 5000;
+  return (uint16_t)v;
+}
+
+// HREG 400: a master write is adopted (clamped); WebSerial changes are mirrored back
+static uint16_t meterHregLast = 0;
+static void serviceMeterHreg() {
+  const uint16_t h = mb.Hreg(HREG_METER_MS);
+  if (h != meterHregLast) {
+    g_meter_ms = clampMeterMs(h);
+    dirtyAtmCfg = true;
+    cfgTouch();
+  }
+  if (h != g_meter_ms) mb.Hreg(HREG_METER_MS, g_meter_ms);
+  meterHregLast = g_meter_ms;
+}
+
+// ================== Persistence ==================
+static void captureToPersist(PersistConfig& pc) {
+  pc = {};
+  pc.magic   = CFG_MAGIC;
+  pc.version = CFG_VERSION;
+  pc.size    = sizeof(PersistConfig);
+
+  pc.mb_address = g_mb_address;
+  pc.mb_baud    = g_mb_baud;
+  memcpy(pc.rly, rlyCfg, sizeof(pc.rly));
+  memcpy(pc.led, ledCfg, sizeof(pc.led));
+  memcpy(pc.btn, btnCfg, sizeof(pc.btn));
+
+  pc.atm_lineHz = g_atm_cfg.lineHz;
+  pc.atm_sumAbs = g_atm_cfg.sumAbs;
+  pc.atm_ucal   = g_atm_cfg.ucal;
+  memcpy(pc.cal, g_atm_cfg.cal, sizeof(pc.cal));
+
+  pc.meter_ms = g_meter_ms;
+  memcpy(pc.alarm, g_alarmCfg, sizeof(pc.alarm));
+  memcpy(pc.rly_alarm, rlyAlarm, sizeof(pc.rly_alarm));
+
+  pc.crc32 = 0;
+  pc.crc32 = crc32_update(0, (const uint8_t*)&pc, sizeof(PersistConfig));
+}
+
+static bool applyFromPersist(const PersistConfig& pc) {
+  if (pc.magic != CFG_MAGIC || pc.size != sizeof(PersistConfig)) return false;
+  PersistConfig tmp = pc; const uint32_t crc = tmp.crc32; tmp.crc32 = 0;
+  if (crc32_update(0, (const uint8_t*)&tmp, sizeof(PersistConfig)) != crc) return false;
+  if (pc.version != CFG_VERSION) return false;
+
+  g_mb_address = (uint8_t)constrain((int)pc.mb_address, 1, 247);
+  g_mb_baud    = (uint32_t)constrain((int)pc.mb_baud, 9600, 115200);
+  mb_req_address = g_mb_address;
+  mb_req_baud    = g_mb_baud;
+
+  memcpy(rlyCfg, pc.rly, sizeof(rlyCfg));
+  for (int i = 0; i < NUM_LED; i++) {
+    ledCfg[i].mode   = (uint8_t)constrain((int)pc.led[i].mode, 0, 1);
+    ledCfg[i].source = ledSourceValid(pc.led[i].source) ? pc.led[i].source : 0;
+  }
+  for (int i = 0; i < NUM_BTN; i++) {
+    const uint8_t a = pc.btn[i].action;
+    btnCfg[i].action = (a == 0 || a == 5 || a == 6) ? a : 0;
+  }
+
+  g_atm_cfg.lineHz = (pc.atm_lineHz == 60) ? 60 : 50;
+  g_atm_cfg.sumAbs = pc.atm_sumAbs ? 1 : 0;
+  g_atm_cfg.ucal   = pc.atm_ucal ? pc.atm_ucal : 1;
+  memcpy(g_atm_cfg.cal, pc.cal, sizeof(g_atm_cfg.cal));
+
+  g_meter_ms = clampMeterMs(pc.meter_ms);
+
+  memcpy(g_alarmCfg, pc.alarm, sizeof(g_alarmCfg));
+  for (int ch = 0; ch < CH_COUNT; ch++)
+    for (int k = 0; k < AK_COUNT; k++) {
+      if (g_alarmCfg[ch].rule[k].metric >= AM_COUNT) g_alarmCfg[ch].rule[k].metric = AM_VOLTAGE;
+      g_alarmRt[ch][k] = {false, false, false, false, 0};
+    }
+  for (int i = 0; i < NUM_RLY; i++) {
+    rlyAlarm[i].ch        = (pc.rly_alarm[i].ch < CH_COUNT) ? pc.rly_alarm[i].ch : CH_TOT;
+    rlyAlarm[i].kindsMask = pc.rly_alarm[i].kindsMask & 0b111;
+  }
+  return true;
+}
+
+static bool loadConfigFromPath(const char* path) {
+  File f = LittleFS.open(path, "r");
+  if (!f) return false;
+  if (f.size() != sizeof(PersistConfig)) { f.close(); return false; }
+  PersistConfig pc{};
+  const size_t n = f.read((uint8_t*)&pc, sizeof(pc));
+  f.close();
+  return n == sizeof(pc) && applyFromPersist(pc);
+}
+
+// A complete tmp file (power lost before the rename) is as good as the real one.
+static bool loadConfigFS() {
+  if (!fsOk) return false;
+  return loadConfigFromPath(CFG_PATH) || loadConfigFromPath(CFG_TMP);
+}
+
+static void cfgSaveStart() {
+  if (!fsOk || cfgSaveState != CS_IDLE) return;
+  captureToPersist(cfgSavePc);
+  cfgSaveOff = 0;
+  cfgSaveState = CS_OPEN;
+}
+
+static void cfgSaveFail(const char* why) {
+  if (cfgSaveFile) cfgSaveFile.close();
+  cfgSaveState = CS_IDLE;
+  pendingMsgText = why;
+  pendingMsg = true;
+}
+
+// Advances the save by one LittleFS operation.
+static void cfgSaveOp() {
+  switch (cfgSaveState) {
+    case CS_OPEN:
+      cfgSaveFile = LittleFS.open(CFG_TMP, "w");
+      if (!cfgSaveFile) { cfgSaveFail("save: open failed"); return; }
+      cfgSaveState = CS_WRITE;
+      return;
+    case CS_WRITE: {
+      const size_t left = sizeof(PersistConfig) - cfgSaveOff;
+      const size_t n = (left < CFG_SLICE) ? left : CFG_SLICE;
+      if (cfgSaveFile.write((const uint8_t*)&cfgSavePc + cfgSaveOff, n) != n) { cfgSaveFail("save: short write"); return; }
+      cfgSaveOff += n;
+      if (cfgSaveOff >= sizeof(PersistConfig)) cfgSaveState = CS_CLOSE;
+      return;
+    }
+    case CS_CLOSE:
+      cfgSaveFile.close();
+      cfgSaveState = CS_COMMIT;
+      return;
+    case CS_COMMIT:
+      if (!LittleFS.rename(CFG_TMP, CFG_PATH)) { cfgSaveFail("save: rename failed"); return; }
+      cfgSaveState = CS_IDLE;
+      cfgSaves++;
+      pendingMsgText = "OK: Configuration saved";
+      pendingMsg = true;
+      return;
+    default:
+      return;
+  }
+}
+
+// One flash step per loop pass for whichever writer is active, timed.
+static void fsStep() {
+  if (cfgSaveState == CS_IDLE && eJnlState == EJ_IDLE) return;
+  const uint32_t t0 = micros();
+  if (cfgSaveState != CS_IDLE) cfgSaveOp();
+  else                         energyJnlOp();
+  fsStallEnd(t0);
+}
+
+// ================== Power-quality events ==================
+// EMMState1 / EMMIntState1 bit layout
+static uint8_t evtMaskFrom(uint8_t type, uint16_t st1) {
+  switch (type) {
+    case EV_SAG:        return (uint8_t)(((st1 >> 14) & 1) | (((st1 >> 13) & 1) << 1) | (((st1 >> 12) & 1) << 2));
+    case EV_PHASE_LOSS: return (uint8_t)(((st1 >> 10) & 1) | (((st1 >> 9)  & 1) << 1) | (((st1 >> 8)  & 1) << 2));
+    case EV_FREQ_HI:    return (st1 & 0x8000) ? 0x08 : 0;
+    case EV_FREQ_LO:    return (st1 & 0x0800) ? 0x08 : 0;
+    case EV_REVERSE_P:  return (uint8_t)(((st1 >> 2) & 1) | (((st1 >> 1) & 1) << 1) | ((st1 & 1) << 2) | (((st1 >> 3) & 1) << 3));
+    default:            return 0;
+  }
+}
+
+static void evtPush(uint8_t type, uint8_t mask, uint8_t flags, uint64_t t) {
+  PqEvent& e = evtLog[evtSeq % EVT_LOG_N];
+  e.seq = ++evtSeq; e.t_us = t; e.type = type; e.mask = mask; e.flags = flags;
+}
+
+static void evtPublishModbus() {
+  const uint32_t fill = (evtSeq < EVT_LOG_N) ? evtSeq : EVT_LOG_N;
+  mb.Ireg(IREG_EVT_COUNT, (uint16_t)evtSeq);
+  mb.Ireg(IREG_EVT_FILL,  (uint16_t)fill);
+  for (uint8_t i = 0; i < IREG_EVT_N; i++) {
+    const uint16_t reg = IREG_EVT_BASE + i * 6;
+    if (i >= fill) { for (int k = 0; k < 6; k++) mb.Ireg(reg + k, 0); continue; }
+    const PqEvent& e = evtLog[(evtSeq - 1 - i) % EVT_LOG_N];
+    const uint32_t ms = (uint32_t)(e.t_us / 1000);
+    mb.Ireg(reg + 0, (uint16_t)e.seq);
+    mb.Ireg(reg + 1, (uint16_t)((e.type << 8) | e.mask));
+    mb.Ireg(reg + 2, e.flags);
+    mb.Ireg(reg + 3, (uint16_t)(ms >> 16));
+    mb.Ireg(reg + 4, (uint16_t)(ms & 0xFFFF));
+    mb.Ireg(reg + 5, (uint16_t)(e.t_us % 1000));
+  }
+}
+
+static void evtService() {
+  const unsigned long nowMs = millis();
+  const bool irq = evtIrq;
+  if (!irq && (nowMs - evtLastPoll < EVT_POLL_MS)) return;
+  evtLastPoll = nowMs;
+
+  uint64_t tEdge;
+  noInterrupts(); tEdge = evtIrqUs; evtIrq = false; interrupts();
+  const uint64_t tNow = time_us_64();
+  if (!irq) tEdge = tNow;
+
+  uint16_t st[4];                       // EMMState0/1, EMMIntState0/1
+  g_atm.readEmmStates(st);
+  if (st[2] || st[3]) g_atm.clearIntState(st[2], st[3]);
+
+  const uint32_t before = evtSeq;
+  for (uint8_t t = 1; t < EV_TYPES; t++) {
+    const uint8_t cur   = evtMaskFrom(t, st[1]);
+    const uint8_t lat   = evtMaskFrom(t, st[3]);
+    const uint8_t prev  = evtActive[t];
+    const uint8_t began = (uint8_t)((cur | lat) & ~prev);
+    const uint8_t ended = (uint8_t)(prev & ~cur);
+    const uint8_t brief = (uint8_t)(began & ~cur);          // latched only: began and ended between reads
+    if (began) evtPush(t, began, irq ? EVF_IRQ_TS : 0, tEdge);
+    if (brief) evtPush(t, brief, EVF_END | EVF_SHORT, tNow);
+    if (ended) evtPush(t, ended, EVF_END, tNow);
+    evtActive[t] = cur;
+  }
+  if (evtSeq != before) evtPublishModbus();
+}
+
+static JSONVar evtToJson(const PqEvent& e) {
+  JSONVar j;
+  j["seq"]   = (double)e.seq;
+  j["t_ms"]  = (double)(e.t_us / 1000);
+  j["t_us"]  = (int)(e.t_us % 1000);
+  j["type"]  = (int)e.type;
+  j["mask"]  = (int)e.mask;
+  j["flags"] = (int)e.flags;
+  return j;
+}
+
+// Events with seq > fromSeq still in the ring, oldest first
+static JSONVar evtListToJson(uint32_t fromSeq) {
+  JSONVar a;
+  const uint32_t oldest = (evtSeq > EVT_LOG_N) ? evtSeq - EVT_LOG_N : 0;
+  if (fromSeq < oldest) fromSeq = oldest;
+  int n = 0;
+  for (uint32_t s = fromSeq; s < evtSeq; s++) a[n++] = evtToJson(evtLog[s % EVT_LOG_N]);
+  return a;
+}
+
 // ================== ATM live ==================
 static JSONVar atmLiveToJson() {
   JSONVar o;
 
-  o["Ua_V"] = g_atm.readUrmsA_V();
-  o["Ub_V"] = g_atm.readUrmsB_V();
-  o["Uc_V"] = g_atm.readUrmsC_V();
+  const MeterSnapshot& m = meterSnap();
 
-  o["Ia_A"] = g_atm.readIrmsA_A();
-  o["Ib_A"] = g_atm.readIrmsB_A();
-  o["Ic_A"] = g_atm.readIrmsC_A();
+  o["Ua_V"] = m.Urms_V[0];
+  o["Ub_V"] = m.Urms_V[1];
+  o["Uc_V"] = m.Urms_V[2];
 
-  o["PF_A_raw"] = (int)g_atm.readPFmeanA();
-  o["PF_B_raw"] = (int)g_atm.readPFmeanB();
-  o["PF_C_raw"] = (int)g_atm.readPFmeanC();
-  o["PF_T_raw"] = (int)g_atm.readPFmeanT();
+  o["Ia_A"] = m.Irms_A[0];
+  o["Ib_A"] = m.Irms_A[1];
+  o["Ic_A"] = m.Irms_A[2];
 
-  o["AngA_raw"] = (int)g_atm.readPAngleA();
-  o["AngB_raw"] = (int)g_atm.readPAngleB();
-  o["AngC_raw"] = (int)g_atm.readPAngleC();
+  JSONVar P, Q, S, Pf, Ph;
+  for (int i = 0; i < 4; i++) {
+    P[i]  = m.P_W[i];
+    Q[i]  = m.Q_var[i];
+    S[i]  = m.S_VA[i];
+    Pf[i] = m.Pfund_W[i];
+    Ph[i] = m.Pharm_W[i];
+  }
+  o["P_W"]     = P;       // A,B,C,Tot
+  o["Q_var"]   = Q;
+  o["S_VA"]    = S;
+  o["Pfund_W"] = Pf;
+  o["Pharm_W"] = Ph;
+
+  JSONVar thdU, thdI;
+  for (int i = 0; i < 3; i++) {
+    thdU[i] = m.THDN_U[i] * 0.01;
+    thdI[i] = m.THDN_I[i] * 0.01;
+  }
+  o["THDN_U_pct"] = thdU;
+  o["THDN_I_pct"] = thdI;
+
+  o["PF_A_raw"] = (int)m.PFmean[0];
+  o["PF_B_raw"] = (int)m.PFmean[1];
+  o["PF_C_raw"] = (int)m.PFmean[2];
+  o["PF_T_raw"] = (int)m.PFmean[3];
 
-  o["Freq_x100"] = (int)g_atm.readFreq_x100();
-  o["Temp_C"]    = (int)g_atm.readTempC();
+  o["AngA_raw"] = (int)m.PAngle[0];
+  o["AngB_raw"] = (int)m.PAngle[1];
+  o["AngC_raw"] = (int)m.PAngle[2];
+
+  o["Freq_x100"] = (int)m.Freq_x100;
+  o["Temp_C"]    = (int)m.TempC;
 
-  M90DiagRegs d = g_atm.readDiag();
   JSONVar diag;
-  diag["EMMState0"]     = (int)d.EMMState0;
-  diag["EMMState1"]     = (int)d.EMMState1;
-  diag["EMMIntState0"]  = (int)d.EMMIntState0;
-  diag["EMMIntState1"]  = (int)d.EMMIntState1;
-  diag["CRCErrStatus"]  = (int)d.CRCErrStatus;
-  diag["LastSPIData"]   = (int)d.LastSPIData;
+  diag["EMMState0"]     = (int)m.diag.EMMState0;
+  diag["EMMState1"]     = (int)m.diag.EMMState1;
+  diag["EMMIntState0"]  = (int)m.diag.EMMIntState0;
+  diag["EMMIntState1"]  = (int)m.diag.EMMIntState1;
+  diag["CRCErrStatus"]  = (int)m.diag.CRCErrStatus;
+  diag["LastSPIData"]   = (int)m.diag.LastSPIData;
   o["diag"] = diag;
 
+  // bus timing (replaces a separate benchmark sketch)
+  o["snap_us"] = (int)m.read_us;
+  o["age_ms"]  = (int)((micros() - m.t_us) / 1000);
+  o["spi_hz"]  = (int)g_atm.spiHz();
+
   return o;
 }
 
@@ -342,6 +1513,16 @@ static void processModbusCommandPulses() {
       desiredRelay[r] = false;
     }
   }
+  for (int ch = 0; ch < CH_COUNT; ch++) {
+    if (mb.Coil(CMD_ALARM_ACK_BASE + ch)) {
+      mb.setCoil(CMD_ALARM_ACK_BASE + ch, false);
+      alarmsAckChannel((uint8_t)ch);
+    }
+  }
+  if (mb.Coil(CMD_TREND_RESET)) {
+    mb.setCoil(CMD_TREND_RESET, false);
+    trendWindowReset();
+  }
 }
 
 // ================== WebSerial handlers (ABSOLUTELY NO send/hardware) ==================
@@ -376,6 +1557,7 @@ static void handleRelayCfg(JSONVar obj) {
     if (JSON.typeof(inv[i]) != "undefined")  rlyCfg[i].inverted = (bool)inv[i];
   }
   dirtyRelayCfg = true;
+  cfgTouch();
   pendingMsgText = "OK: Relays updated";
   pendingMsg = true;
 }
@@ -388,6 +1570,7 @@ static void handleBtnCfg(JSONVar obj) {
     btnCfg[i].action = (uint8_t)((v==0 || v==5 || v==6) ? v : 0);
   }
   dirtyBtnCfg = true;
+  cfgTouch();
   pendingMsgText = "OK: Buttons updated";
   pendingMsg = true;
 }
@@ -399,10 +1582,11 @@ static void handleLedCfg(JSONVar obj) {
     if (JSON.typeof(m[i]) != "undefined") ledCfg[i].mode   = (uint8_t)constrain((int)m[i], 0, 1);
     if (JSON.typeof(s[i]) != "undefined") {
       int sv = (int)s[i];
-      ledCfg[i].source = (uint8_t)((sv==0 || sv==5 || sv==6) ? sv : 0);
+      ledCfg[i].source = (uint8_t)(ledSourceValid(sv) ? sv : 0);
     }
   }
   dirtyLedCfg = true;
+  cfgTouch();
   pendingMsgText = "OK: LEDs updated";
   pendingMsg = true;
 }
@@ -416,23 +1600,132 @@ static void handleAtmBase(JSONVar obj) {
 }
 static void handleAtmA(JSONVar obj) {
   atmUpdatePhaseFromJson(0, obj);
-  queueAtmApply();
+  queueAtmCalApply();
   pendingMsgText = "OK: Phase A queued";
   pendingMsg = true;
 }
 static void handleAtmB(JSONVar obj) {
   atmUpdatePhaseFromJson(1, obj);
-  queueAtmApply();
+  queueAtmCalApply();
   pendingMsgText = "OK: Phase B queued";
   pendingMsg = true;
 }
 static void handleAtmC(JSONVar obj) {
   atmUpdatePhaseFromJson(2, obj);
-  queueAtmApply();
+  queueAtmCalApply();
   pendingMsgText = "OK: Phase C queued";
   pendingMsg = true;
 }
 
+static void handleMeter(JSONVar obj) {
+  if (obj.hasOwnProperty("sample_ms")) g_meter_ms = clampMeterMs((int)obj["sample_ms"]);
+  dirtyAtmCfg = true;
+  cfgTouch();
+  pendingMsgText = "OK: Meter rate updated";
+  pendingMsg = true;
+}
+
+// {"ch":0..3, "cfg":{"ack":bool, "0".."2":{enabled,metric,min,max,hyst,on_ms,off_ms}}}
+static volatile bool alarmAckPending[CH_COUNT] = {false,false,false,false};
+static void handleAlarmsCfg(JSONVar v) {
+  const int ch = v.hasOwnProperty("ch") ? (int)v["ch"] : -1;
+  if (ch < 0 || ch >= CH_COUNT) { pendingMsgText = "AlarmsCfg: bad channel"; pendingMsg = true; return; }
+  JSONVar cfg = v.hasOwnProperty("cfg") ? v["cfg"] : v;
+
+  if (cfg.hasOwnProperty("ack")) g_alarmCfg[ch].ackRequired = (bool)cfg["ack"];
+  for (int k = 0; k < AK_COUNT; k++) {
+    if (!cfg.hasOwnProperty(String(k))) continue;
+    JSONVar j = cfg[String(k)];
+    AlarmRule& r = g_alarmCfg[ch].rule[k];
+    if (j.hasOwnProperty("enabled")) r.enabled    = (bool)j["enabled"];
+    if (j.hasOwnProperty("metric"))  r.metric     = (uint8_t)constrain((int)j["metric"], 0, AM_COUNT - 1);
+    if (j.hasOwnProperty("min"))     r.min        = (int32_t)(double)j["min"];
+    if (j.hasOwnProperty("max"))     r.max        = (int32_t)(double)j["max"];
+    if (j.hasOwnProperty("hyst"))    r.hyst       = max((int32_t)0, (int32_t)(double)j["hyst"]);
+    if (j.hasOwnProperty("on_ms"))   r.onDelayMs  = clamp_u16((int)j["on_ms"]);
+    if (j.hasOwnProperty("off_ms"))  r.offDelayMs = clamp_u16((int)j["off_ms"]);
+  }
+  dirtyAlarmCfg = true;
+  cfgTouch();
+  pendingMsgText = "OK: Alarms updated";
+  pendingMsg = true;
+}
+
+// {"ch":n} or {} for all channels
+static void handleAlarmsAck(JSONVar v) {
+  const int ch = v.hasOwnProperty("ch") ? (int)v["ch"] : -1;
+  for (int c = 0; c < CH_COUNT; c++) if (ch < 0 || ch == c) alarmAckPending[c] = true;
+  pendingMsgText = "OK: Alarms acknowledged";
+  pendingMsg = true;
+}
+
+// {"ch":[c0,c1], "mask":[m0,m1]}  mask bit0=Alarm,1=Warning,2=Event; 0 = relay not alarm-driven
+static void handleAlarmRelay(JSONVar obj) {
+  JSONVar c = obj["ch"];
+  JSONVar m = obj["mask"];
+  for (int i = 0; i < NUM_RLY; i++) {
+    if (JSON.typeof(c[i]) != "undefined") rlyAlarm[i].ch        = (uint8_t)constrain((int)c[i], 0, CH_COUNT - 1);
+    if (JSON.typeof(m[i]) != "undefined") rlyAlarm[i].kindsMask = (uint8_t)((int)m[i] & 0b111);
+  }
+  dirtyAlarmCfg = true;
+  cfgTouch();
+  pendingMsgText = "OK: Alarm relays updated";
+  pendingMsg = true;
+}
+
+static volatile bool pendingEvtAll = false;
+static volatile bool evtClearPending = false;
+static void handleEventsGet(JSONVar) { pendingEvtAll = true; }
+static void handleEventsClear(JSONVar) {
+  evtClearPending = true;
+  pendingMsgText = "OK: Event log cleared";
+  pendingMsg = true;
+}
+
+// {"tier":0..2, "ch":-1|0..11, "n":buckets}  (ch -1 = all channels)
+static volatile bool pendingTrend = false;
+static volatile bool trendResetPending = false;
+static uint8_t  trendReqTier = TT_1S;
+static int8_t   trendReqCh   = TR_PT;
+static uint16_t trendReqN    = 0;
+static void handleTrendGet(JSONVar v) {
+  trendReqTier = v.hasOwnProperty("tier") ? (uint8_t)constrain((int)v["tier"], 0, TT_COUNT - 1) : (uint8_t)TT_1S;
+  trendReqCh   = v.hasOwnProperty("ch")   ? (int8_t)constrain((int)v["ch"], -1, TR_CH - 1)     : (int8_t)TR_PT;
+  trendReqN    = v.hasOwnProperty("n")    ? clamp_u16((int)v["n"])                              : 0;
+  pendingTrend = true;
+}
+static void handleTrendReset(JSONVar) {
+  trendResetPending = true;
+  pendingMsgText = "OK: Trend window reset";
+  pendingMsg = true;
+}
+
+// {"cmd":"offset"|"gain"|"abort", "n":16, "phases":7, "u_ref":230.0, "i_ref":5.0, "uoffset":false}
+static volatile bool calCmdPending = false;
+static uint8_t  calCmd = 0;            // 1 offset, 2 gain, 3 abort
+static uint8_t  calCmdPhases = 7;
+static uint16_t calCmdN = 16;
+static float    calCmdURef = 0, calCmdIRef = 0;
+static bool     calCmdDoU = false;
+static void handleAtmCal(JSONVar obj) {
+  const String cmd = obj.hasOwnProperty("cmd") ? (const char*)obj["cmd"] : "";
+  if      (cmd == "offset") calCmd = 1;
+  else if (cmd == "gain")   calCmd = 2;
+  else if (cmd == "abort")  calCmd = 3;
+  else { pendingMsgText = "atmCal: cmd must be offset|gain|abort"; pendingMsg = true; return; }
+  calCmdN      = obj.hasOwnProperty("n")      ? (uint16_t)constrain((int)obj["n"], 1, (int)CAL_N_MAX) : 16;
+  calCmdPhases = obj.hasOwnProperty("phases") ? (uint8_t)((int)obj["phases"] & 0b111) : 0b111;
+  calCmdURef   = obj.hasOwnProperty("u_ref")  ? (float)(double)obj["u_ref"] : 0.0f;
+  calCmdIRef   = obj.hasOwnProperty("i_ref")  ? (float)(double)obj["i_ref"] : 0.0f;
+  calCmdDoU    = obj.hasOwnProperty("uoffset") ? (bool)obj["uoffset"] : false;
+  if (calCmd == 2 && calCmdURef <= 0 && calCmdIRef <= 0) {
+    pendingMsgText = "atmCal: gain needs u_ref and/or i_ref"; pendingMsg = true; return;
+  }
+  calCmdPending = true;
+  pendingMsgText = "OK: Calibration queued";
+  pendingMsg = true;
+}
+
 // Legacy support (optional)
 static void handleAtmCfgLegacy(JSONVar obj) {
   atmUpdateBaseFromJson(obj);
@@ -459,6 +1752,9 @@ void setup() {
 
   setDefaults();
 
+  fsOk = LittleFS.begin();
+  const bool cfgLoaded = loadConfigFS();
+
   // Serial2 / Modbus
   Serial2.setTX(TX2);
   Serial2.setRX(RX2);
@@ -471,10 +1767,41 @@ void setup() {
   for (uint16_t i=0;i<NUM_BTN;i++) mb.addIsts(ISTS_BTN_BASE + i);
   for (uint16_t i=0;i<NUM_RLY;i++) mb.addIsts(ISTS_RLY_BASE + i);
   for (uint16_t i=0;i<NUM_LED;i++) mb.addIsts(ISTS_LED_BASE + i);
+  for (uint16_t i=0;i<CH_COUNT*AK_COUNT;i++) mb.addIsts(ISTS_ALARM_BASE + i);
+
+  // Input registers (live metering)
+  for (uint16_t i=0;i<3;i++) { mb.addIreg(IREG_URMS_BASE + i); mb.addIreg(IREG_IRMS_BASE + i); mb.addIreg(IREG_ANG_BASE + i); }
+  for (uint16_t i=0;i<4;i++) mb.addIreg(IREG_PF_BASE + i);
+  for (uint16_t i=0;i<8;i++) {
+    mb.addIreg(IREG_P_BASE + i); mb.addIreg(IREG_Q_BASE + i); mb.addIreg(IREG_S_BASE + i);
+    mb.addIreg(IREG_PFUND_BASE + i); mb.addIreg(IREG_PHARM_BASE + i);
+  }
+  for (uint16_t i=0;i<6;i++) mb.addIreg(IREG_THDU_BASE + i);
+  mb.addIreg(IREG_FREQ);
+  mb.addIreg(IREG_TEMP);
+  for (uint16_t i=0;i<6;i++) mb.addIreg(IREG_DIAG_BASE + i);
+
+  // Input registers (event log)
+  for (uint16_t i=0;i<2 + IREG_EVT_N*6;i++) mb.addIreg(IREG_EVT_COUNT + i);
+
+  // Input registers (trend window + history view)
+  for (uint16_t i=0;i<TR_CH*6 + 2;i++) mb.addIreg(IREG_TRW_BASE + i);
+  for (uint16_t i=0;i<2 + IREG_TRH_N*6;i++) mb.addIreg(IREG_TRH_SEQ + i);
+
+  // Holding registers
+  mb.addHreg(HREG_METER_MS, g_meter_ms);
+  meterHregLast = g_meter_ms;
+  mb.addHreg(HREG_TREND_TIER, trSelTier);
+  mb.addHreg(HREG_TREND_CH,   trSelCh);
+
+  // Input registers (energies, 20 x u32)
+  for (uint16_t i=0;i<ECH_COUNT*EK_COUNT*2;i++) mb.addIreg(IREG_E_BASE + i);
 
   // Coils (pulse commands)
   for (uint16_t i=0;i<NUM_RLY;i++){ mb.addCoil(CMD_RLY_ON_BASE  + i); mb.setCoil(CMD_RLY_ON_BASE  + i, false); }
   for (uint16_t i=0;i<NUM_RLY;i++){ mb.addCoil(CMD_RLY_OFF_BASE + i); mb.setCoil(CMD_RLY_OFF_BASE + i, false); }
+  for (uint16_t i=0;i<CH_COUNT;i++){ mb.addCoil(CMD_ALARM_ACK_BASE + i); mb.setCoil(CMD_ALARM_ACK_BASE + i, false); }
+  mb.addCoil(CMD_TREND_RESET); mb.setCoil(CMD_TREND_RESET, false);
 
   updateModbusStatusJson();
 
@@ -492,6 +1819,15 @@ void setup() {
   WebSerial.on("atmB",     handleAtmB);
   WebSerial.on("atmC",     handleAtmC);
   WebSerial.on("atmCfg",   handleAtmCfgLegacy);
+  WebSerial.on("meter",    handleMeter);
+  WebSerial.on("alarmsCfg",  handleAlarmsCfg);
+  WebSerial.on("alarmsAck",  handleAlarmsAck);
+  WebSerial.on("alarmRelay", handleAlarmRelay);
+  WebSerial.on("atmCal",     handleAtmCal);
+  WebSerial.on("eventsGet",  handleEventsGet);
+  WebSerial.on("eventsClear", handleEventsClear);
+  WebSerial.on("trendGet",   handleTrendGet);
+  WebSerial.on("trendReset", handleTrendReset);
 
   // ---- SPI1 + ATM init ----
   SPI1.setSCK(ATM_SCK);
@@ -504,8 +1840,30 @@ void setup() {
   atmApplyFromCfg_NOW();
   atmBusy = false;
 
+  // restore energy totals; begin() just cleared the chip registers
+  energyMcRefresh();
+  energyJnlLoad();
+  energyPublish();
+  lastEnergyPoll = millis();
+  trendInit();
+  meterTick();
+  lastMeterTick = millis();
+
+  // event capture: begin() cleared the latches; arm IRQ lines
+#if ATM_IRQ0_PIN >= 0
+  pinMode(ATM_IRQ0_PIN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(ATM_IRQ0_PIN), atmIrqIsr, RISING);
+#endif
+#if ATM_IRQ1_PIN >= 0
+  pinMode(ATM_IRQ1_PIN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(ATM_IRQ1_PIN), atmIrqIsr, RISING);
+#endif
+  evtPublishModbus();
+  trendPublishWindow();
+  trendPublishHistory();
+
   // Defer this message to loop (safe)
-  pendingMsgText = "Boot OK (stable): callbacks do not send; all sends happen in loop";
+  pendingMsgText = cfgLoaded ? "Boot OK: configuration restored" : "Boot OK: defaults (no saved configuration)";
   pendingMsg = true;
   pendingEchoAll = true;
 }
@@ -524,7 +1882,9 @@ void loop() {
   if (atmApplyPending && !atmBusy && (now - atmLastApplyMs >= atmApplyMinIntervalMs)) {
     atmApplyPending = false;
     atmBusy = true;
+    energyPoll();               // drain before the soft reset in begin()
     atmApplyFromCfg_NOW();
+    energyMcRefresh();
     atmBusy = false;
     atmLastApplyMs = now;
 
@@ -533,11 +1893,67 @@ void loop() {
     pendingMsg = true;
   }
 
+  // 3') Gain/offset-only apply and calibration commands (no begin())
+  if (atmCalPending && !atmBusy && !atmApplyPending) {
+    atmCalPending = false;
+    atmApplyCalOnly_NOW();
+    pendingMsgText = "OK: Calibration applied";
+    pendingMsg = true;
+  }
+  if (calCmdPending && !atmBusy) {
+    calCmdPending = false;
+    if (calCmd == 3) { if (calJob.state != CAL_IDLE) calAbort("cal: aborted"); }
+    else calStart(calCmd == 1 ? CALM_OFFSET : CALM_GAIN, calCmdPhases, calCmdN, calCmdURef, calCmdIRef, calCmdDoU);
+  }
+
+  // 3a) Live metering snapshot at g_meter_ms
+  if (!atmBusy && (now - lastMeterTick >= g_meter_ms)) {
+    lastMeterTick = now;
+    meterTick();
+  }
+
+  // 3a') Power-quality events (IRQ edge or EVT_POLL_MS)
+  if (!atmBusy) evtService();
+  if (evtClearPending) {
+    evtClearPending = false;
+    evtSeq = evtSentSeq = 0;
+    evtPublishModbus();
+  }
+
+  // 3b) Energy drain on a fixed schedule + journal checkpoint
+  if (!atmBusy && (now - lastEnergyPoll >= ENERGY_POLL_MS)) {
+    lastEnergyPoll += ENERGY_POLL_MS;
+    if (now - lastEnergyPoll >= ENERGY_POLL_MS) lastEnergyPoll = now;  // resync after a stall
+    energyPoll();
+    energyJnlCheckpoint(false);
+  }
+
+  // 3c) Trend buckets (1 s tick, rolls up into 1 min / 15 min)
+  trendService();
+  if (trendResetPending) {
+    trendResetPending = false;
+    trendWindowReset();
+  }
+
   // 4) Modbus tasking
   if (!mbBusy) {
     mb.task();
     processModbusCommandPulses();
+    serviceMeterHreg();
+    serviceTrendHreg();
+  }
+
+  // 4b) Alarm acks queued by WebSerial
+  for (int ch = 0; ch < CH_COUNT; ch++) {
+    if (alarmAckPending[ch]) { alarmAckPending[ch] = false; alarmsAckChannel((uint8_t)ch); }
+  }
+
+  // 4c) Config autosave (debounced) and one step of an in-flight save/journal append
+  if (cfgDirty && cfgSaveState == CS_IDLE && eJnlState == EJ_IDLE && (now - lastCfgTouchMs >= CFG_AUTOSAVE_MS)) {
+    cfgDirty = false;
+    cfgSaveStart();
   }
+  fsStep();
 
   // 5) Blink scheduler
   if (now - lastBlinkToggle >= blinkPeriodMs) {
@@ -565,6 +1981,7 @@ void loop() {
   bool relayLogical[NUM_RLY];
   for (int i = 0; i < NUM_RLY; i++) {
     bool logical = desiredRelay[i];
+    if (rlyAlarm[i].kindsMask) logical = alarmAnyActive(rlyAlarm[i].ch, rlyAlarm[i].kindsMask);
     if (!rlyCfg[i].enabled) logical = false;
 
     bool phys = logical;
@@ -584,6 +2001,8 @@ void loop() {
     if (src == 5 || src == 6) {
       int r = src - 5;
       srcActive = (r >= 0 && r < NUM_RLY) ? relayLogical[r] : false;
+    } else if (src >= 10) {
+      srcActive = alarmLedSource(src);
     }
 
     bool physLed = (ledCfg[i].mode == 0) ? srcActive : (srcActive && blinkPhase);
@@ -607,6 +2026,36 @@ void loop() {
     pendingAtmCfg = false;
     WebSerial.send("atmCfg", atmCfgToJson());
   }
+  if (dirtyAlarmCfg) {
+    dirtyAlarmCfg = false;
+    WebSerial.send("AlarmsCfg",     alarmsCfgToJson());
+    WebSerial.send("AlarmRelayCfg", relayAlarmToJson());
+  }
+  if (calResultPending) {
+    calResultPending = false;
+    WebSerial.send("atmCalResult", calResultToJson());
+    WebSerial.send("atmCfg", atmCfgToJson());
+  }
+  if (calErr) {
+    WebSerial.send("message", calErr);
+    calErr = nullptr;
+  }
+  if (pendingEvtAll) {
+    pendingEvtAll = false;
+    WebSerial.send("pqEvents", evtListToJson(0));
+    evtSentSeq = evtSeq;
+  } else if (evtSentSeq != evtSeq) {
+    WebSerial.send("pqEvents", evtListToJson(evtSentSeq));
+    evtSentSeq = evtSeq;
+  }
+  if (pendingTrend) {
+    pendingTrend = false;
+    WebSerial.send("trend", trendToJson(trendReqTier, trendReqCh, trendReqN));
+  }
+  if (alarmStateChanged) {
+    alarmStateChanged = false;
+    WebSerial.send("AlarmsState", alarmsStateToJson());
+  }
   if (pendingMsg && pendingMsgText) {
     pendingMsg = false;
     WebSerial.send("message", pendingMsgText);
@@ -632,9 +2081,10 @@ void loop() {
     for (int i = 0; i < NUM_LED; i++) ledStateList[i] = ledPhysState[i];
     WebSerial.send("LedStateList", ledStateList);
 
-    if (!atmBusy) {
+    if (g_snapValid) {
       WebSerial.send("atmLive", atmLiveToJson());
     }
+    WebSerial.send("energy", energyToJson());
 
     if (dirtyRelayCfg) {
       WebSerial.send("relayEnableList", relayEnableListToJson());
@@ -0,0 +1,72 @@
+// ================================================
+// File: enm_alarm.h
+// ENM-223 alarm engine: rule types and the per-sample step
+// No Arduino dependency so recorded snapshot sequences can be replayed on a host
+// (tests/enm_alarm_test.cpp).
+// ================================================
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include <ATM90E32Core.h>
+
+enum : uint8_t { CH_L1=0, CH_L2, CH_L3, CH_TOT, CH_COUNT };
+enum : uint8_t { AK_ALARM=0, AK_WARNING, AK_EVENT, AK_COUNT };
+enum AlarmMetric : uint8_t {
+  AM_VOLTAGE=0, AM_CURRENT, AM_P_ACTIVE, AM_Q_REACTIVE, AM_S_APPARENT, AM_FREQ, AM_COUNT
+};
+// Units: V 0.01, I 0.001, P/Q/S whole W/var/VA, F 0.01 Hz. Out of band = v<min || v>max;
+// once raised it clears only inside [min+hyst, max-hyst].
+struct AlarmRule {
+  bool     enabled;
+  uint8_t  metric;
+  int32_t  min;
+  int32_t  max;
+  int32_t  hyst;
+  uint16_t onDelayMs;
+  uint16_t offDelayMs;
+};
+// tEdgeMs is on the millis() clock: delays are measured by unsigned difference,
+// so they hold across the 49.7-day wrap.
+struct AlarmRuntime { bool conditionNow; bool active; bool latched; bool pending; uint32_t tEdgeMs; };
+
+static inline int32_t alarmMetricValue(uint8_t ch, uint8_t metric, const MeterSnapshot& m) {
+  const int c = (ch < 3) ? ch : 3;
+  switch (metric) {
+    case AM_VOLTAGE:    return (ch < 3) ? lroundf(m.Urms_V[ch] * 100.0f)
+                                        : lroundf((m.Urms_V[0] + m.Urms_V[1] + m.Urms_V[2]) * (100.0f / 3.0f));
+    case AM_CURRENT:    return (ch < 3) ? lroundf(m.Irms_A[ch] * 1000.0f)
+                                        : lroundf((m.Irms_A[0] + m.Irms_A[1] + m.Irms_A[2]) * 1000.0f);
+    case AM_P_ACTIVE:   return lroundf(m.P_W[c]);
+    case AM_Q_REACTIVE: return lroundf(m.Q_var[c]);
+    case AM_S_APPARENT: return lroundf(m.S_VA[c]);
+    case AM_FREQ:       return (int32_t)m.Freq_x100;
+    default:            return 0;
+  }
+}
+
+// One rule, one sample: band + hysteresis -> on/off delay -> latch. Returns true if 'active' changed.
+static inline bool alarmStep(const AlarmRule& r, AlarmRuntime& rt, bool ackRequired, int32_t v, uint32_t nowMs) {
+  bool raw = false;
+  if (r.enabled) {
+    if (rt.conditionNow) raw = (v < r.min + r.hyst) || (v > r.max - r.hyst);
+    else                 raw = (v < r.min) || (v > r.max);
+  }
+
+  if (raw != rt.conditionNow) {
+    if (!rt.pending) { rt.pending = true; rt.tEdgeMs = nowMs; }
+    const uint16_t dly = raw ? r.onDelayMs : r.offDelayMs;
+    if ((uint32_t)(nowMs - rt.tEdgeMs) >= dly) { rt.conditionNow = raw; rt.pending = false; }
+  } else {
+    rt.pending = false;
+  }
+
+  const bool was = rt.active;
+  if (ackRequired) {
+    if (rt.conditionNow) { rt.latched = true; rt.active = true; }
+    else if (!rt.latched) rt.active = false;
+  } else {
+    rt.active  = rt.conditionNow;
+    rt.latched = false;
+  }
+  return rt.active != was;
+}
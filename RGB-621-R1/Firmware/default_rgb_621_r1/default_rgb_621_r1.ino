@@ -4,7 +4,12 @@
 #include <Arduino_JSON.h>
 #include <LittleFS.h>
 #include <utility>
+#include <math.h>
 #include "hardware/watchdog.h"
+#include "hardware/pwm.h"       // PWM slices for the LED outputs
+#include "hardware/irq.h"
+#include "hardware/gpio.h"
+#include "hardware/clocks.h"    // clock_get_hz()
 
 // ================== UART2 (RS-485 / Modbus) ==================
 #define TX2 4
@@ -73,8 +78,31 @@ bool desiredRelay[NUM_RLY] = {false};
 uint32_t rlyPulseUntil[NUM_RLY] = {0};
 const uint32_t PULSE_MS = 500; // default pulse width
 
-// PWM levels 0..255 (R,G,B,WW,CW)
-uint16_t pwmLevel[NUM_PWM] = {0,0,0,0,0}; // store as 16-bit for Modbus HR, but clamp to 0..255
+// PWM levels 0..255 (R,G,B,WW,CW) — 8-bit view of pwmTarget16 for HR 400..404 / UI
+uint16_t pwmLevel[NUM_PWM] = {0,0,0,0,0};
+
+// ================== PWM engine state ==================
+// Targets are 16-bit perceptual levels; the wrap ISR fades pwmCur32 (16.16)
+// toward them and maps through pwmLut to the 15-bit duty.
+enum : uint8_t { CURVE_LINEAR = 0, CURVE_CIE = 1 };
+static const uint16_t PWM_TOP      = 32767;  // 15-bit duty: ~3.8 kHz @125 MHz, ~4.6 kHz @150 MHz
+static const uint16_t PWM_LUT_N    = 257;    // perceptual -> duty, 256 segments
+static const uint32_t PWM_TICK_HZ  = 1000;   // fade step rate (derived from the PWM wrap)
+static const uint16_t FADE_MS_MAX  = 60000;
+static const uint16_t CCT_WW_K     = 2700;   // white LED strips at the two ends of the CCT range
+static const uint16_t CCT_CW_K     = 6500;
+
+uint16_t          pwmLutBuf[2][PWM_LUT_N];             // built off-line, swapped under noInterrupts()
+const uint16_t* volatile pwmLut = pwmLutBuf[0];       // read by pwmWrapIsr
+volatile uint16_t pwmTarget16[NUM_PWM] = {0,0,0,0,0};
+volatile uint32_t pwmCur32[NUM_PWM]    = {0,0,0,0,0};
+volatile uint32_t pwmStep32[NUM_PWM]   = {0,0,0,0,0};
+uint16_t pwmFadeMs  = 500;          // duration of each level change (0 = instant)
+uint8_t  pwmCurve   = CURVE_CIE;    // perceptual curve applied to all channels
+uint16_t cctKelvin  = 4000;         // WW/CW mix, applied when HR 440/441 are written
+uint16_t cctBriX10  = 0;            // white brightness 0..1000 (0.1 %)
+uint32_t pwmTickHz  = PWM_TICK_HZ;  // actual tick after integer decimation of the wrap rate
+uint8_t  pwmTickDiv = 1;
 
 // ================== Web Serial ==================
 SimpleWebSerial WebSerial;
@@ -99,14 +127,32 @@ struct PersistConfig {
   LedCfg  ledCfg[NUM_LED];
   BtnCfg  btnCfg[NUM_BTN];
   bool    desiredRelay[NUM_RLY];
-  uint16_t pwmLevel[NUM_PWM]; // store 0..255
+  uint16_t pwmLevel16[NUM_PWM]; // perceptual 0..65535
+  uint16_t pwmFadeMs;
+  uint8_t  pwmCurve;
+  uint16_t cctKelvin;
+  uint16_t cctBriX10;
+  uint8_t mb_address;
+  uint32_t mb_baud;
+  uint32_t crc32;
+} __attribute__((packed));
+
+// v2 layout (8-bit levels), migrated on load
+struct PersistConfigV2 {
+  uint32_t magic;  uint16_t version;  uint16_t size;
+  InCfg   diCfg[NUM_DI];
+  RlyCfg  rlyCfg[NUM_RLY];
+  LedCfg  ledCfg[NUM_LED];
+  BtnCfg  btnCfg[NUM_BTN];
+  bool    desiredRelay[NUM_RLY];
+  uint16_t pwmLevel[NUM_PWM]; // 0..255
   uint8_t mb_address;
   uint32_t mb_baud;
   uint32_t crc32;
 } __attribute__((packed));
 
 static const uint32_t CFG_MAGIC   = 0x52474231UL; // '1BGR'
-static const uint16_t CFG_VERSION = 0x0002;
+static const uint16_t CFG_VERSION = 0x0003;
 static const char*    CFG_PATH    = "/cfg_rgb.bin";
 
 volatile bool   cfgDirty        = false;
@@ -132,7 +178,8 @@ void setDefaults() {
   for (int i = 0; i < NUM_LED; i++) ledCfg[i] = { 0 /*steady*/, 0 /*source: None*/ };
   for (int i = 0; i < NUM_BTN; i++) btnCfg[i] = { 0 };
   for (int i = 0; i < NUM_RLY; i++) { desiredRelay[i] = false; rlyPulseUntil[i] = 0; }
-  for (int i = 0; i < NUM_PWM; i++) pwmLevel[i] = 0;
+  for (int i = 0; i < NUM_PWM; i++) { pwmLevel[i] = 0; pwmTarget16[i] = 0; }
+  pwmFadeMs = 500; pwmCurve = CURVE_CIE; cctKelvin = 4000; cctBriX10 = 0;
   g_mb_address = 3; g_mb_baud = 19200;
 }
 
@@ -143,7 +190,8 @@ void captureToPersist(PersistConfig &pc) {
   memcpy(pc.ledCfg,       ledCfg,       sizeof(ledCfg));
   memcpy(pc.btnCfg,       btnCfg,       sizeof(btnCfg));
   memcpy(pc.desiredRelay, desiredRelay, sizeof(desiredRelay));
-  memcpy(pc.pwmLevel,     pwmLevel,     sizeof(pwmLevel));
+  for (int i = 0; i < NUM_PWM; i++) pc.pwmLevel16[i] = pwmTarget16[i];
+  pc.pwmFadeMs = pwmFadeMs; pc.pwmCurve = pwmCurve; pc.cctKelvin = cctKelvin; pc.cctBriX10 = cctBriX10;
   pc.mb_address = g_mb_address; pc.mb_baud = g_mb_baud;
   pc.crc32 = 0; pc.crc32 = crc32_update(0, (const uint8_t*)&pc, sizeof(PersistConfig));
 }
@@ -159,11 +207,31 @@ bool applyFromPersist(const PersistConfig &pc) {
   memcpy(ledCfg,       pc.ledCfg,       sizeof(ledCfg));
   memcpy(btnCfg,       pc.btnCfg,       sizeof(btnCfg));
   memcpy(desiredRelay, pc.desiredRelay, sizeof(desiredRelay));
-  memcpy(pwmLevel,     pc.pwmLevel,     sizeof(pwmLevel));
+  for (int i = 0; i < NUM_PWM; i++) pwmTarget16[i] = pc.pwmLevel16[i];
+  pwmFadeMs = min(pc.pwmFadeMs, FADE_MS_MAX);
+  pwmCurve  = (pc.pwmCurve <= CURVE_CIE) ? pc.pwmCurve : CURVE_CIE;
+  cctKelvin = constrain(pc.cctKelvin, CCT_WW_K, CCT_CW_K);
+  cctBriX10 = min(pc.cctBriX10, (uint16_t)1000);
   g_mb_address = pc.mb_address; g_mb_baud = pc.mb_baud;
   return true;
 }
 
+bool applyFromPersistV2(const PersistConfigV2 &o) {
+  if (o.magic != CFG_MAGIC || o.size != sizeof(PersistConfigV2) || o.version != 0x0002) return false;
+  PersistConfigV2 tmp = o; uint32_t crc = tmp.crc32; tmp.crc32 = 0;
+  if (crc32_update(0, (const uint8_t*)&tmp, sizeof(tmp)) != crc) return false;
+
+  setDefaults();
+  memcpy(diCfg,        o.diCfg,        sizeof(diCfg));
+  memcpy(rlyCfg,       o.rlyCfg,       sizeof(rlyCfg));
+  memcpy(ledCfg,       o.ledCfg,       sizeof(ledCfg));
+  memcpy(btnCfg,       o.btnCfg,       sizeof(btnCfg));
+  memcpy(desiredRelay, o.desiredRelay, sizeof(desiredRelay));
+  for (int i = 0; i < NUM_PWM; i++) pwmTarget16[i] = (uint16_t)(min(o.pwmLevel[i], (uint16_t)255) * 257u);
+  g_mb_address = o.mb_address; g_mb_baud = o.mb_baud;
+  return true;
+}
+
 bool saveConfigFS() {
   PersistConfig pc{}; captureToPersist(pc);
   File f = LittleFS.open(CFG_PATH, "w");
@@ -184,6 +252,12 @@ bool saveConfigFS() {
 }
 bool loadConfigFS() {
   File f = LittleFS.open(CFG_PATH, "r"); if (!f) { WebSerial.send("message", "load: open failed"); return false; }
+  if (f.size() == sizeof(PersistConfigV2)) {
+    PersistConfigV2 o{}; size_t n = f.read((uint8_t*)&o, sizeof(o)); f.close();
+    if (n != sizeof(o) || !applyFromPersistV2(o)) { WebSerial.send("message", "load: v2 config invalid"); return false; }
+    WebSerial.send("message", "load: migrated v2 config"); cfgDirty = true; lastCfgTouchMs = millis();
+    return true;
+  }
   if (f.size() != sizeof(PersistConfig)) { WebSerial.send("message", String("load: size ")+f.size()+" != "+sizeof(PersistConfig)); f.close(); return false; }
   PersistConfig pc{}; size_t n = f.read((uint8_t*)&pc, sizeof(pc)); f.close();
   if (n != sizeof(pc)) { WebSerial.send("message", "load: short read"); return false; }
@@ -215,9 +289,14 @@ enum : uint16_t {
 
 // Holding Registers (FC=03/06/16) for PWM levels (0..255)
 enum : uint16_t {
-  HR_PWM_BASE = 400, // 400..404 : R,G,B,WW,CW
-  HR_MB_ADDR  = 480, // Modbus address
-  HR_MB_BAUD  = 481  // Modbus baud
+  HR_PWM_BASE   = 400, // 400..404 : R,G,B,WW,CW (0..255)
+  HR_PWM16_BASE = 420, // 420..424 : R,G,B,WW,CW (0..65535, full resolution)
+  HR_FADE_MS    = 430, // fade time for every level change, ms (0 = instant)
+  HR_CURVE      = 431, // 0 = linear, 1 = CIE L* (perceptual)
+  HR_CCT_K      = 440, // white colour temperature, K (CCT_WW_K..CCT_CW_K)
+  HR_CCT_BRI    = 441, // white brightness 0..1000 (0.1 %); writing 440/441 sets WW/CW
+  HR_MB_ADDR    = 480, // Modbus address
+  HR_MB_BAUD    = 481  // Modbus baud
 };
 
 // ================== Fw decls ==================
@@ -230,8 +309,12 @@ JSONVar LedConfigListFromCfg();
 void sendAllEchoesOnce();
 void processModbusCommandPulses();
 void applyActionToTarget(uint8_t target, uint8_t action, uint32_t now);
-void applyPwmFromHoldingRegs();
-void analogWriteClamp(uint8_t pin, uint16_t level);
+bool pwmEngineBegin();
+void buildPwmLut();
+void setPwmTarget16(uint8_t ch, uint16_t t16);
+void applyPwmFromState();
+void applyCctMix();
+void servicePwmHoldingRegs(uint32_t now);
 
 // ================== Setup ==================
 void setup() {
@@ -242,9 +325,6 @@ void setup() {
   for (uint8_t i=0;i<NUM_RLY;i++)  { pinMode(RELAY_PINS[i], OUTPUT); digitalWrite(RELAY_PINS[i], LOW); } // OFF
   for (uint8_t i=0;i<NUM_LED;i++)  { pinMode(LED_PINS[i],   OUTPUT);  digitalWrite(LED_PINS[i],   LOW); } // OFF
   for (uint8_t i=0;i<NUM_BTN;i++)  pinMode(BTN_PINS[i],   INPUT_PULLUP);   // active-LOW
-  // PWM pins init
-  for (uint8_t i=0;i<NUM_PWM;i++) analogWrite(PWM_PINS[i], 0);
-
   setDefaults();
 
   // Guarded FS init
@@ -269,7 +349,8 @@ void setup() {
   for (uint16_t i=0;i<NUM_DI;i++)  { mb.addCoil(CMD_DI_DIS_BASE  + i);  mb.setCoil(CMD_DI_DIS_BASE  + i, false); }
 
   // ==== Modbus holding registers for PWM + MB settings ====
-  for (uint16_t i=0;i<NUM_PWM;i++) { mb.addHreg(HR_PWM_BASE + i); mb.Hreg(HR_PWM_BASE + i, pwmLevel[i]); }
+  for (uint16_t i=0;i<NUM_PWM;i++) { mb.addHreg(HR_PWM_BASE + i); mb.addHreg(HR_PWM16_BASE + i); }
+  mb.addHreg(HR_FADE_MS); mb.addHreg(HR_CURVE); mb.addHreg(HR_CCT_K); mb.addHreg(HR_CCT_BRI);
   mb.addHreg(HR_MB_ADDR); mb.Hreg(HR_MB_ADDR, g_mb_address);
   mb.addHreg(HR_MB_BAUD); mb.Hreg(HR_MB_BAUD, (uint16_t)g_mb_baud);
 
@@ -282,11 +363,13 @@ void setup() {
   WebSerial.on("Config",  handleUnifiedConfig);
   WebSerial.on("command", handleCommand);
 
-  WebSerial.send("message", "Boot OK (RGB+CCT via Modbus HR 400..404; DI actions None/Toggle/Pulse; LED source: None/Overridden R1)");
-  sendAllEchoesOnce();
+  // PWM engine: start dark, then fade to the restored levels
+  const bool pwmOk = pwmEngineBegin();
+  applyPwmFromState();
 
-  // Apply restored PWM levels to outputs
-  applyPwmFromHoldingRegs();
+  WebSerial.send("message", "Boot OK (RGB+CCT via Modbus HR 400..404 / 420..424; DI actions None/Toggle/Pulse; LED source: None/Overridden R1)");
+  if (!pwmOk) WebSerial.send("message", "ERROR: PWM engine init failed");
+  sendAllEchoesOnce();
 }
 
 // ================== Filesystem init ==================
@@ -340,14 +423,13 @@ void handleCommand(JSONVar obj) {
   } else if (act == "save") {
     if (saveConfigFS()) WebSerial.send("message", "Configuration saved"); else WebSerial.send("message", "ERROR: Save failed");
   } else if (act == "load") {
-    if (loadConfigFS()) { WebSerial.send("message", "Configuration loaded"); sendAllEchoesOnce(); applyModbusSettings(g_mb_address, g_mb_baud); applyPwmFromHoldingRegs(); }
+    if (loadConfigFS()) { WebSerial.send("message", "Configuration loaded"); sendAllEchoesOnce(); applyModbusSettings(g_mb_address, g_mb_baud); applyPwmFromState(); }
     else WebSerial.send("message", "ERROR: Load failed/invalid");
   } else if (act == "factory") {
-    setDefaults(); if (saveConfigFS()) { WebSerial.send("message", "Factory defaults restored & saved"); sendAllEchoesOnce(); applyModbusSettings(g_mb_address, g_mb_baud); applyPwmFromHoldingRegs(); }
+    setDefaults(); if (saveConfigFS()) { WebSerial.send("message", "Factory defaults restored & saved"); sendAllEchoesOnce(); applyModbusSettings(g_mb_address, g_mb_baud); applyPwmFromState(); }
     else WebSerial.send("message", "ERROR: Save after factory reset failed");
   } else if (act == "off") {
-    for (int i=0;i<NUM_PWM;i++){ pwmLevel[i]=0; mb.Hreg(HR_PWM_BASE+i,0); }
-    applyPwmFromHoldingRegs();
+    for (int i=0;i<NUM_PWM;i++) setPwmTarget16(i, 0);
     cfgDirty = true; lastCfgTouchMs = millis();
     WebSerial.send("message", "All PWM channels set to 0");
   } else {
@@ -379,29 +461,32 @@ void handleValues(JSONVar values) {
   if (baud) { baud = constrain(baud, 9600, 115200); g_mb_baud = (uint32_t)baud; }
   applyModbusSettings(g_mb_address, g_mb_baud);
 
-  // Optionally accept direct PWM payloads: {"rgb":[r,g,b],"cct":[ww,cw]} (0..255)
+  // Optional lighting payloads:
+  //   {"rgb":[r,g,b],"cct":[ww,cw]} (0..255), {"fadeMs":n}, {"curve":0|1},
+  //   {"white":{"k":2700..6500,"bri":0..1000}} (WW/CW mix)
+  if (values.hasOwnProperty("fadeMs")) pwmFadeMs = (uint16_t)constrain((int)values["fadeMs"], 0, (int)FADE_MS_MAX);
+  if (values.hasOwnProperty("curve"))  { pwmCurve = (uint8_t)constrain((int)values["curve"], 0, 1); buildPwmLut(); }
   if (values.hasOwnProperty("rgb")) {
     JSONVar arr = values["rgb"];
     if (arr.length() >= 3) {
-      pwmLevel[0] = (uint16_t)constrain((int)arr[0], 0, 255);
-      pwmLevel[1] = (uint16_t)constrain((int)arr[1], 0, 255);
-      pwmLevel[2] = (uint16_t)constrain((int)arr[2], 0, 255);
-      mb.Hreg(HR_PWM_BASE+0, pwmLevel[0]);
-      mb.Hreg(HR_PWM_BASE+1, pwmLevel[1]);
-      mb.Hreg(HR_PWM_BASE+2, pwmLevel[2]);
+      for (int i = 0; i < 3; i++) setPwmTarget16(i, (uint16_t)(constrain((int)arr[i], 0, 255) * 257));
     }
   }
   if (values.hasOwnProperty("cct")) {
     JSONVar arr = values["cct"];
     if (arr.length() >= 2) {
-      pwmLevel[3] = (uint16_t)constrain((int)arr[0], 0, 255);
-      pwmLevel[4] = (uint16_t)constrain((int)arr[1], 0, 255);
-      mb.Hreg(HR_PWM_BASE+3, pwmLevel[3]);
-      mb.Hreg(HR_PWM_BASE+4, pwmLevel[4]);
+      setPwmTarget16(3, (uint16_t)(constrain((int)arr[0], 0, 255) * 257));
+      setPwmTarget16(4, (uint16_t)(constrain((int)arr[1], 0, 255) * 257));
     }
   }
+  if (values.hasOwnProperty("white")) {
+    JSONVar w = values["white"];
+    if (w.hasOwnProperty("k"))   cctKelvin = (uint16_t)constrain((int)w["k"], (int)CCT_WW_K, (int)CCT_CW_K);
+    if (w.hasOwnProperty("bri")) cctBriX10 = (uint16_t)constrain((int)w["bri"], 0, 1000);
+    applyCctMix();
+  }
+  mb.Hreg(HR_FADE_MS, pwmFadeMs); mb.Hreg(HR_CURVE, pwmCurve); mb.Hreg(HR_CCT_K, cctKelvin); mb.Hreg(HR_CCT_BRI, cctBriX10);
 
-  applyPwmFromHoldingRegs();
   WebSerial.send("message", "Values updated");
   cfgDirty = true; lastCfgTouchMs = millis();
 }
@@ -501,18 +586,137 @@ void applyActionToTarget(uint8_t target, uint8_t action, uint32_t now) {
   cfgDirty = true; lastCfgTouchMs = now;
 }
 
-// ================== PWM helpers ==================
-void analogWriteClamp(uint8_t pin, uint16_t level) {
-  if (level > 255) level = 255;
-  analogWrite(pin, (uint8_t)level);
+// ================== PWM engine ==================
+// GPIO8..12 sit on slices 4..6. All three run the same 15-bit wrap and are
+// started together, so their counters stay in phase. The slice of PWM_PINS[0]
+// raises the wrap IRQ; every pwmTickDiv wraps (~PWM_TICK_HZ) the ISR steps each
+// fade and writes all five compare values just after a wrap. The compare
+// registers are double-buffered, so the whole set latches at the next wrap.
+static inline uint16_t level8From16(uint16_t t) { return (uint16_t)(((uint32_t)t + 128u) / 257u); }
+
+// Fills the buffer the ISR is not using, then swaps the pointer
+void buildPwmLut() {
+  uint16_t* lut = (pwmLut == pwmLutBuf[0]) ? pwmLutBuf[1] : pwmLutBuf[0];
+  for (uint16_t i = 0; i < PWM_LUT_N; i++) {
+    const float x = (float)i / (PWM_LUT_N - 1);
+    float y = x;
+    if (pwmCurve == CURVE_CIE) { const float L = x * 100.0f; y = (L > 8.0f) ? powf((L + 16.0f) / 116.0f, 3.0f) : (L / 903.3f); }
+    lut[i] = (uint16_t)lroundf(y * PWM_TOP);
+  }
+  noInterrupts(); pwmLut = lut; interrupts();
+}
+
+// 16-bit perceptual level -> duty (0..PWM_TOP), linear between LUT points
+static inline uint16_t pwmDuty(const uint16_t* lut, uint16_t in) {
+  const uint16_t i = in >> 8, fr = in & 0xFF;
+  const int32_t a = lut[i], b = lut[i + 1];
+  uint16_t d = (uint16_t)(a + (((b - a) * fr) >> 8));
+  if (d == 0 && in != 0) d = 1;                       // lowest level still emits
+  return d;
 }
 
-void applyPwmFromHoldingRegs() {
-  for (int i=0;i<NUM_PWM;i++) {
-    uint16_t val = (uint16_t)mb.Hreg(HR_PWM_BASE + i);
-    if (val > 255) val = 255;
-    pwmLevel[i] = val;
-    analogWriteClamp(PWM_PINS[i], val);
+void pwmWrapIsr() {
+  static uint8_t div = 0;
+  pwm_clear_irq(pwm_gpio_to_slice_num(PWM_PINS[0]));
+  if (++div < pwmTickDiv) return;
+  div = 0;
+  const uint16_t* lut = pwmLut;
+  for (uint8_t i = 0; i < NUM_PWM; i++) {
+    const uint32_t tgt = (uint32_t)pwmTarget16[i] << 16, step = pwmStep32[i];
+    uint32_t cur = pwmCur32[i];
+    if (cur != tgt) {
+      if (cur < tgt) cur = (tgt - cur > step) ? cur + step : tgt;
+      else           cur = (cur - tgt > step) ? cur - step : tgt;
+      pwmCur32[i] = cur;
+    }
+    pwm_set_gpio_level(PWM_PINS[i], pwmDuty(lut, (uint16_t)(cur >> 16)));
+  }
+}
+
+bool pwmEngineBegin() {
+  buildPwmLut();
+  pwm_config cfg = pwm_get_default_config();
+  pwm_config_set_wrap(&cfg, PWM_TOP);
+  pwm_config_set_clkdiv_int(&cfg, 1);
+  uint32_t mask = 0;
+  for (uint8_t i = 0; i < NUM_PWM; i++) {
+    gpio_set_function(PWM_PINS[i], GPIO_FUNC_PWM);
+    const uint slice = pwm_gpio_to_slice_num(PWM_PINS[i]);
+    if (!(mask & (1u << slice))) { pwm_init(slice, &cfg, false); mask |= 1u << slice; }
+    pwm_set_gpio_level(PWM_PINS[i], 0);
+    pwmCur32[i] = 0;
+  }
+  const uint32_t wrapHz = clock_get_hz(clk_sys) / (PWM_TOP + 1u);
+  pwmTickDiv = (uint8_t)constrain((int)((wrapHz + PWM_TICK_HZ / 2) / PWM_TICK_HZ), 1, 255);
+  pwmTickHz  = wrapHz / pwmTickDiv;
+
+  const uint irqSlice = pwm_gpio_to_slice_num(PWM_PINS[0]);
+#ifdef PWM_DEFAULT_IRQ_NUM
+  const uint irqNum = PWM_DEFAULT_IRQ_NUM();
+#else
+  const uint irqNum = PWM_IRQ_WRAP;
+#endif
+  pwm_clear_irq(irqSlice);
+  pwm_set_irq_enabled(irqSlice, true);
+  irq_set_exclusive_handler(irqNum, pwmWrapIsr);
+  irq_set_enabled(irqNum, true);
+  pwm_set_mask_enabled(mask);                         // start all slices on the same cycle
+  return wrapHz > 0;
+}
+
+// Mirror one channel into HR 400+ch (8-bit) and 420+ch (16-bit)
+static uint16_t hrSeen8[NUM_PWM], hrSeen16[NUM_PWM];
+static inline void mirrorPwmHreg(uint8_t ch) {
+  hrSeen8[ch]  = pwmLevel[ch];    mb.Hreg(HR_PWM_BASE + ch,   hrSeen8[ch]);
+  hrSeen16[ch] = pwmTarget16[ch]; mb.Hreg(HR_PWM16_BASE + ch, hrSeen16[ch]);
+}
+
+// New target for one channel; the ISR fades there over pwmFadeMs
+void setPwmTarget16(uint8_t ch, uint16_t t16) {
+  if (ch >= NUM_PWM) return;
+  const uint32_t tgt = (uint32_t)t16 << 16, cur = pwmCur32[ch];
+  const uint32_t d = (cur > tgt) ? cur - tgt : tgt - cur;
+  const uint32_t n = (uint32_t)pwmFadeMs * pwmTickHz / 1000u;
+  const uint32_t step = (n > 1) ? (uint32_t)(((uint64_t)d + n - 1) / n) : 0xFFFFFFFFu;
+  noInterrupts(); pwmStep32[ch] = step ? step : 1; pwmTarget16[ch] = t16; interrupts();
+  pwmLevel[ch] = level8From16(t16);
+  mirrorPwmHreg(ch);
+}
+
+// Re-issue stored targets and curve (boot / load / factory) and refresh every mirror
+void applyPwmFromState() {
+  buildPwmLut();
+  for (uint8_t i = 0; i < NUM_PWM; i++) setPwmTarget16(i, pwmTarget16[i]);
+  mb.Hreg(HR_FADE_MS, pwmFadeMs); mb.Hreg(HR_CURVE, pwmCurve);
+  mb.Hreg(HR_CCT_K, cctKelvin);   mb.Hreg(HR_CCT_BRI, cctBriX10);
+}
+
+// CCT + brightness -> WW/CW, mixed linearly in mired so the sum stays at brightness
+void applyCctMix() {
+  const float mK = 1e6f / cctKelvin, mW = 1e6f / CCT_WW_K, mC = 1e6f / CCT_CW_K;
+  const float fc = constrain((mW - mK) / (mW - mC), 0.0f, 1.0f);
+  const float b  = cctBriX10 / 1000.0f * 65535.0f;
+  setPwmTarget16(3, (uint16_t)lroundf(b * (1.0f - fc)));
+  setPwmTarget16(4, (uint16_t)lroundf(b * fc));
+}
+
+// Modbus writes to the lighting registers; one write starts a full transition
+void servicePwmHoldingRegs(uint32_t now) {
+  bool changed = false;
+  for (uint8_t i = 0; i < NUM_PWM; i++) {
+    const uint16_t v16 = (uint16_t)mb.Hreg(HR_PWM16_BASE + i), v8 = (uint16_t)mb.Hreg(HR_PWM_BASE + i);
+    if (v16 != hrSeen16[i])   { setPwmTarget16(i, v16); changed = true; }
+    else if (v8 != hrSeen8[i]) { setPwmTarget16(i, (uint16_t)(min(v8, (uint16_t)255) * 257u)); changed = true; }
+  }
+  const uint16_t fm = min((uint16_t)mb.Hreg(HR_FADE_MS), FADE_MS_MAX);
+  if (fm != pwmFadeMs) { pwmFadeMs = fm; changed = true; }
+  const uint8_t cv = (uint8_t)min((uint16_t)mb.Hreg(HR_CURVE), (uint16_t)CURVE_CIE);
+  if (cv != pwmCurve) { pwmCurve = cv; buildPwmLut(); changed = true; }
+  const uint16_t k = constrain((uint16_t)mb.Hreg(HR_CCT_K), CCT_WW_K, CCT_CW_K), bri = min((uint16_t)mb.Hreg(HR_CCT_BRI), (uint16_t)1000);
+  if (k != cctKelvin || bri != cctBriX10) { cctKelvin = k; cctBriX10 = bri; applyCctMix(); changed = true; }
+  if (changed) {
+    mb.Hreg(HR_FADE_MS, pwmFadeMs); mb.Hreg(HR_CURVE, pwmCurve); mb.Hreg(HR_CCT_K, cctKelvin); mb.Hreg(HR_CCT_BRI, cctBriX10);
+    cfgDirty = true; lastCfgTouchMs = now;
   }
 }
 
@@ -523,14 +727,8 @@ void loop() {
   mb.task();                     // Modbus polling
   processModbusCommandPulses();  // consume pulses
 
-  // Monitor for external Modbus writes to PWM registers
-  static uint16_t prevPwm[NUM_PWM] = {0,0,0,0,0};
-  bool pwmChanged = false;
-  for (int i=0;i<NUM_PWM;i++) {
-    uint16_t v = (uint16_t)mb.Hreg(HR_PWM_BASE+i);
-    if (v != prevPwm[i]) { prevPwm[i] = v; pwmChanged = true; }
-  }
-  if (pwmChanged) { applyPwmFromHoldingRegs(); cfgDirty = true; lastCfgTouchMs = now; }
+  // Modbus writes to PWM / fade / CCT registers
+  servicePwmHoldingRegs(now);
 
   // Blink phase (for LED blink mode)
   if (now - lastBlinkToggle >= blinkPeriodMs) { lastBlinkToggle = now; blinkPhase = !blinkPhase; }
@@ -1,5 +1,5 @@
 #include "enm_modbus.h"
-#include "atm90e32.h"
+#include <ATM90E32.h>
 namespace enm223 {
 
 static ModbusSerial mb(Serial2, SLAVE_ID, TXEN_PIN);
@@ -3,8 +3,9 @@
 #include <ModbusSerial.h>
 #include <Arduino_JSON.h>
 
+struct M90DiagRegs;   // ATM90E32.h (shared driver)
+
 namespace enm223 {
-struct M90DiagRegs; 
 // ================= Pins & constants =================
 constexpr int  TX2_PIN   = 4;
 constexpr int  RX2_PIN   = 5;
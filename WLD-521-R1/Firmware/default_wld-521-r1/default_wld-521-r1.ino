@@ -13,6 +13,8 @@
 #include <OneWire.h>
 #include <utility>
 #include "hardware/watchdog.h"   // NOTE: keep it if your board supports it
+#include "pico/time.h"           // time_us_32()
+#include "src/pulse_capture.h"   // glitch filter + ISR -> loop ring (host-tested)
 
 // ================== UART2 (RS-485 / Modbus) ==================
 #define TX2 4
@@ -47,8 +49,21 @@ RlyCfg rlyCfg[NUM_RLY];
 bool diState[NUM_DI] = {0};
 bool diPrev[NUM_DI]  = {0};
 uint32_t diCounter[NUM_DI]   = {0};
-uint32_t diLastEdgeMs[NUM_DI]= {0};
-const uint32_t CNT_DEBOUNCE_MS = 20;
+uint32_t diLastEdgeUs[NUM_DI]= {0};   // timestamp of last counted edge (time_us_32)
+
+// ===== Pulse capture (GPIO ISR -> lock-free ring) =====
+// Counter inputs are captured on every edge by a GPIO interrupt, not by loop()
+// polling, so 1-Wire reads, LittleFS saves or WebSerial bursts cannot lose pulses.
+// Glitch filter and ring live in src/pulse_capture.h. The ISR is the single
+// producer, loop() the single consumer (drainPulseCapture()).
+const uint32_t DI_GLITCH_US_DEFAULT = 2000;   // 2 ms: reed bounce off, hall meters up to ~250 Hz
+const uint32_t DI_GLITCH_US_MAX     = 100000;
+uint32_t diGlitchUs[NUM_DI];
+
+PulseRing         pulseRing;
+volatile PulseIn  pulseIn[NUM_DI];               // ISR-owned edge state and counters
+uint32_t          pulseSeenCount[NUM_DI] = {0};  // loop-side copy of pulseIn[].count
+uint32_t          pulseDropsSeen[NUM_DI] = {0};  // loop-side copy of pulseIn[].drops
 
 // ===== NEW: Relay control source & desired states =====
 enum RlyCtrl : uint8_t { RCTRL_LOCAL=0, RCTRL_MODBUS=1 };
@@ -68,9 +83,38 @@ float    flowCalibAccum[NUM_DI];
 uint32_t flowCounterBase[NUM_DI];
 
 float    flowRateLmin[NUM_DI];
-uint32_t lastPulseSnapshot[NUM_DI];
 uint32_t nextRateTickMs = 0;
 
+// ===== Flow rate estimator (inter-pulse periods) =====
+// Rate = pulses / sum(last N periods), updated on every drained pulse; between
+// pulses the rate is bounded by 1 pulse / time-since-last-pulse so a stopping
+// flow decays immediately, and drops to 0 after flowZeroMs without pulses.
+static const uint8_t  FLOW_AVG_MAX          = 16;
+static const uint8_t  FLOW_AVG_DEFAULT      = 4;
+static const uint32_t FLOW_ZERO_MS_DEFAULT  = 3000;
+static const uint32_t FLOW_ZERO_MS_MIN      = 200;
+static const uint32_t FLOW_ZERO_MS_MAX      = 60000;
+static const uint16_t FLOW_PUBLISH_MS_DEFAULT = 250;
+static const uint16_t FLOW_PUBLISH_MS_MIN   = 50;
+static const uint16_t FLOW_PUBLISH_MS_MAX   = 5000;
+
+uint8_t  flowAvgPulses[NUM_DI];               // smoothing window (pulses)
+uint32_t flowZeroMs[NUM_DI];                  // zero-flow timeout
+uint16_t flowPublishMs = FLOW_PUBLISH_MS_DEFAULT;  // rate publish cadence (Modbus/WebSerial)
+uint32_t nextFlowPublishMs = 0;
+
+uint32_t flowPerUs[NUM_DI][FLOW_AVG_MAX];     // last periods (µs)
+uint32_t flowPerSum[NUM_DI];
+uint8_t  flowPerIdx[NUM_DI], flowPerN[NUM_DI];
+bool     flowHaveEdge[NUM_DI];
+bool     flowGap[NUM_DI];                     // timestamps lost before the next one: no period from it
+float    flowPps[NUM_DI];                     // latest smoothed pulses/s (pre-calibration)
+
+inline void flowRateReset(uint8_t i){
+  flowPerSum[i]=0; flowPerIdx[i]=0; flowPerN[i]=0;
+  flowHaveEdge[i]=false; flowGap[i]=false; flowPps[i]=0.0f; flowRateLmin[i]=0.0f;
+}
+
 // ===== Heat energy per-DI =====
 bool     heatEnabled[NUM_DI];
 uint64_t heatAddrA[NUM_DI], heatAddrB[NUM_DI];
@@ -79,8 +123,17 @@ double   heatTA[NUM_DI], heatTB[NUM_DI], heatDT[NUM_DI];
 double   heatPowerW[NUM_DI];
 double   heatEnergyJ[NUM_DI];
 
-uint32_t nextOneWireConvertMs = 0;
-bool     oneWireBusy = false;
+// Resolved g_owDb slots for heatAddrA/B (-1 = not in DB) and cached "0x…" strings.
+// Rebuilt by owBindingsRebuild() only when the DB or a heat address changes.
+int8_t   heatSlotA[NUM_DI], heatSlotB[NUM_DI];
+char     heatAddrAHex[NUM_DI][19], heatAddrBHex[NUM_DI][19];
+
+// Sample-synchronous integrator (heatIntegrate): energy advances by the metered
+// volume between two temperature samples times the trapezoid of ΔT across them.
+uint32_t heatLastCount[NUM_DI];          // diCounter at the previous sample
+double   heatLastDT[NUM_DI];             // ΔT at the previous sample (NAN = no valid pair)
+uint32_t heatSampleMsA[NUM_DI], heatSampleMsB[NUM_DI];   // owLastGoodMs of the pair last integrated
+
 
 // ================== Web Serial ==================
 SimpleWebSerial WebSerial;
@@ -225,20 +278,99 @@ struct PersistConfigV7 {
   uint32_t crc32;
 } __attribute__((packed));
 
-using PersistConfig = PersistConfigV7;
+// V8: add per-input pulse glitch filter (µs)
+struct PersistConfigV8 {
+  uint32_t magic;  uint16_t version;  uint16_t size;
+
+  InCfg   diCfg[NUM_DI];
+  RlyCfg  rlyCfg[NUM_RLY];
+  bool    localDesiredRelay[NUM_RLY];
+
+  uint8_t  mb_address;
+  uint32_t mb_baud;
+
+  uint32_t flowPPL[NUM_DI];
+  float    flowCalibRate[NUM_DI];
+  float    flowCalibAccum[NUM_DI];
+  uint32_t flowCounterBase[NUM_DI];
+
+  bool     heatEnabled[NUM_DI];
+  uint64_t heatAddrA[NUM_DI];
+  uint64_t heatAddrB[NUM_DI];
+  float    heatCp[NUM_DI];
+  float    heatRho[NUM_DI];
+  float    heatCalib[NUM_DI];
+  double   heatEnergyJ[NUM_DI];
+
+  // LEDs + Buttons
+  LedCfg   ledCfg[NUM_LED];
+  BtnCfg   btnCfg[NUM_BTN];
+
+  uint8_t  relayCtrlMode[NUM_RLY]; // 0=Local,1=Modbus
+
+  // NEW: pulse capture glitch filter per DI
+  uint32_t diGlitchUs[NUM_DI];
+
+  uint32_t crc32;
+} __attribute__((packed));
+
+// V9: add flow rate estimator settings
+struct PersistConfigV9 {
+  uint32_t magic;  uint16_t version;  uint16_t size;
+
+  InCfg   diCfg[NUM_DI];
+  RlyCfg  rlyCfg[NUM_RLY];
+  bool    localDesiredRelay[NUM_RLY];
+
+  uint8_t  mb_address;
+  uint32_t mb_baud;
+
+  uint32_t flowPPL[NUM_DI];
+  float    flowCalibRate[NUM_DI];
+  float    flowCalibAccum[NUM_DI];
+  uint32_t flowCounterBase[NUM_DI];
+
+  bool     heatEnabled[NUM_DI];
+  uint64_t heatAddrA[NUM_DI];
+  uint64_t heatAddrB[NUM_DI];
+  float    heatCp[NUM_DI];
+  float    heatRho[NUM_DI];
+  float    heatCalib[NUM_DI];
+  double   heatEnergyJ[NUM_DI];
+
+  // LEDs + Buttons
+  LedCfg   ledCfg[NUM_LED];
+  BtnCfg   btnCfg[NUM_BTN];
+
+  uint8_t  relayCtrlMode[NUM_RLY]; // 0=Local,1=Modbus
+
+  uint32_t diGlitchUs[NUM_DI];
+
+  // NEW: period-based flow rate estimator
+  uint8_t  flowAvgPulses[NUM_DI];
+  uint32_t flowZeroMs[NUM_DI];
+  uint16_t flowPublishMs;
+
+  uint32_t crc32;
+} __attribute__((packed));
+
+using PersistConfig = PersistConfigV9;
 
 static const uint32_t CFG_MAGIC       = 0x31524C57UL; // 'WLR1'
 static const uint16_t CFG_VERSION_V5  = 0x0005;
 static const uint16_t CFG_VERSION_V6  = 0x0006;
-static const uint16_t CFG_VERSION     = 0x0007;  // <— bumped to V7
+static const uint16_t CFG_VERSION_V7  = 0x0007;
+static const uint16_t CFG_VERSION_V8  = 0x0008;
+static const uint16_t CFG_VERSION     = 0x0009;  // <— bumped to V9
 static const char*    CFG_PATH        = "/cfg.bin";
 
 // ---- 1-Wire DB ----
 static const char* ONEWIRE_DB_PATH = "/ow_sensors.json";
 static const size_t MAX_OW_SENSORS = 32;
-struct OwRec { uint64_t addr; String name; };
+struct OwRec { uint64_t addr; String name; uint8_t res; };   // res: DS18B20 resolution 9..12 bit
 OwRec  g_owDb[MAX_OW_SENSORS];
 size_t g_owCount = 0;
+char   owAddrHex[MAX_OW_SENSORS][19];   // cached hex64 of g_owDb[i].addr
 
 // === 1-Wire last-good cache & error tracking ===
 double   owLastGoodTemp[MAX_OW_SENSORS];
@@ -246,6 +378,54 @@ uint32_t owLastGoodMs[MAX_OW_SENSORS];
 uint32_t owErrCount[MAX_OW_SENSORS];
 const uint32_t OW_FAIL_HIDE_MS = 15000;
 
+// === 1-Wire scheduler (non-blocking, one bus primitive per loop pass) ===
+enum OwState : uint8_t { OWS_IDLE=0, OWS_CFG=1, OWS_CONVERT=2, OWS_WAIT=3, OWS_READ=4 };
+const uint32_t OW_CYCLE_MS    = 1000;   // start-to-start period of convert+read cycles
+const uint8_t  OW_RES_DEFAULT = 12;
+struct OwSched {
+  OwState  st;
+  uint8_t  step;          // byte step inside the current bus transaction
+  uint8_t  idx;           // sensor index (g_owDb) being configured/read
+  uint8_t  retry;
+  uint8_t  rom[8];
+  uint8_t  data[9];
+  uint32_t waitUntilMs;
+  uint32_t nextCycleMs;
+};
+OwSched g_ow;
+bool    owResPending[MAX_OW_SENSORS];   // scratchpad config write queued
+
+// === Heat energy journal ===
+// Append-only checkpoints in two alternating files. A file is only truncated
+// after the other one holds the newest record, so a power cut never loses both.
+static const char* const HEAT_JNL_PATH[2] = { "/heat_a.jnl", "/heat_b.jnl" };
+static const uint32_t HEAT_JNL_MAGIC    = 0x4A544857UL; // 'WHTJ'
+static const uint16_t HEAT_JNL_MAX_RECS = 128;          // records per file before rotating
+static const uint32_t HEAT_JNL_MIN_MS   = 60000;        // never append more often than this
+static const uint32_t HEAT_JNL_MAX_MS   = 900000;       // append at least this often while energy moves
+static const double   HEAT_JNL_STEP_J   = 3600.0;       // ...or once any channel moved 1 Wh
+struct HeatJnlRec {
+  uint32_t magic;
+  uint32_t seq;
+  double   energyJ[NUM_DI];
+  uint32_t crc32;
+} __attribute__((packed));
+uint32_t heatJnlSeq = 0;
+uint8_t  heatJnlFile = 0;
+uint16_t heatJnlRecs = 0;
+uint32_t heatJnlLastMs = 0;
+uint32_t heatJnlWrites = 0;
+double   heatJnlLastJ[NUM_DI];
+
+// === Loop timing diagnostics (worst-case loop() stall) ===
+const uint32_t LOOP_STAT_WIN_MS = 10000;
+uint32_t loopPrevStartUs = 0;
+uint32_t loopMaxUs       = 0;   // since boot / diag reset
+uint32_t loopMaxWinUs    = 0;   // current window
+uint32_t loopMaxLastWinUs= 0;   // last completed window (published)
+uint32_t loopWinStartMs  = 0;
+uint32_t owStepMaxUs     = 0;   // longest single 1-Wire scheduler step
+
 volatile bool   cfgDirty       = false;
 uint32_t        lastCfgTouchMs = 0;
 const uint32_t  CFG_AUTOSAVE_MS = 1500;
@@ -261,11 +441,12 @@ uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len) {
 }
 inline bool timeAfter32(uint32_t a, uint32_t b) { return (int32_t)(a - b) >= 0; }
 
-String hex64(uint64_t v) {
-  char buf[19]; buf[0]='0'; buf[1]='x';
+void hex64To(uint64_t v, char buf[19]) {
+  buf[0]='0'; buf[1]='x';
   for (int i=0;i<16;i++) { uint8_t nib=(v >> ((15-i)*4)) & 0xF; buf[2+i]=(nib<10)?('0'+nib):('A'+(nib-10)); }
-  buf[18]=0; return String(buf);
+  buf[18]=0;
 }
+String hex64(uint64_t v) { char buf[19]; hex64To(v, buf); return String(buf); }
 uint64_t romBytesToU64(const uint8_t *addr) { uint64_t v=0; for (int i=7;i>=0;i--) { v = (v<<8) | addr[i]; } return v; }
 bool parseHex64(const char* s, uint64_t &out) {
   if (!s) return false;
@@ -384,13 +565,15 @@ void setDefaults() {
   }
 
   for (int i=0;i<NUM_DI;i++){
-    diCounter[i]=0; diLastEdgeMs[i]=0;
+    diCounter[i]=0; diLastEdgeUs[i]=0;
+    diGlitchUs[i]     = DI_GLITCH_US_DEFAULT;
+    flowAvgPulses[i]  = FLOW_AVG_DEFAULT;
+    flowZeroMs[i]     = FLOW_ZERO_MS_DEFAULT;
     flowPulsesPerL[i] = 450;
     flowCalibRate[i]  = 1.0f;
     flowCalibAccum[i] = 1.0f;
     flowCounterBase[i]= 0;
-    flowRateLmin[i]   = 0.0f;
-    lastPulseSnapshot[i] = 0;
+    flowRateReset(i);
 
     heatEnabled[i]=false;
     heatAddrA[i]=0; heatAddrB[i]=0;
@@ -411,8 +594,9 @@ void setDefaults() {
   btnCfg[2].action = BTN_NONE;
   btnCfg[3].action = BTN_NONE;
 
-  oneWireBusy=false; nextOneWireConvertMs=millis();
+  owSchedAbort();
   nextRateTickMs = millis() + 1000;
+  flowPublishMs = FLOW_PUBLISH_MS_DEFAULT;
   g_mb_address=3; g_mb_baud=19200;
 
 }
@@ -443,6 +627,14 @@ void captureToPersist(PersistConfig &pc){
   // relay control mode
   for (int i=0;i<NUM_RLY;i++) pc.relayCtrlMode[i] = (uint8_t)rlyCtrlMode[i];
 
+  // pulse glitch filter
+  memcpy(pc.diGlitchUs, diGlitchUs, sizeof(diGlitchUs));
+
+  // flow rate estimator
+  memcpy(pc.flowAvgPulses, flowAvgPulses, sizeof(flowAvgPulses));
+  memcpy(pc.flowZeroMs,    flowZeroMs,    sizeof(flowZeroMs));
+  pc.flowPublishMs = flowPublishMs;
+
   pc.crc32=0;
   pc.crc32=crc32_update(0,(const uint8_t*)&pc,sizeof(PersistConfig));
 }
@@ -468,8 +660,7 @@ bool applyFromPersistV5(const PersistConfigV5 &pc){
     flowCalibRate[i]  = (isnan(pc.flowCalibRate[i]) || pc.flowCalibRate[i]<=0) ? 1.0f : pc.flowCalibRate[i];
     flowCalibAccum[i] = (isnan(pc.flowCalibAccum[i])|| pc.flowCalibAccum[i]<=0)? 1.0f : pc.flowCalibAccum[i];
     flowCounterBase[i]= pc.flowCounterBase[i];
-    flowRateLmin[i]   = 0.0f;
-    lastPulseSnapshot[i] = 0;
+    flowRateReset(i);
 
     heatEnabled[i] = pc.heatEnabled[i];
     heatAddrA[i]   = pc.heatAddrA[i];
@@ -483,6 +674,9 @@ bool applyFromPersistV5(const PersistConfigV5 &pc){
   // Seed LED/BTN defaults for migration
   for (int i=0;i<NUM_LED;i++){ ledCfg[i].mode=0; ledCfg[i].source=(i==0)?LEDSRC_R1:(i==1)?LEDSRC_R2:LEDSRC_NONE; }
   btnCfg[0].action=BTN_TOGGLE_R1; btnCfg[1].action=BTN_TOGGLE_R2; btnCfg[2].action=BTN_NONE; btnCfg[3].action=BTN_NONE;
+  for (int i=0;i<NUM_DI;i++) diGlitchUs[i]=DI_GLITCH_US_DEFAULT;
+  for (int i=0;i<NUM_DI;i++){ flowAvgPulses[i]=FLOW_AVG_DEFAULT; flowZeroMs[i]=FLOW_ZERO_MS_DEFAULT; }
+  flowPublishMs = FLOW_PUBLISH_MS_DEFAULT;
 
   nextRateTickMs = millis() + 1000;
   return true;
@@ -508,8 +702,7 @@ bool applyFromPersistV6(const PersistConfigV6 &pc){
     flowCalibRate[i]  = (isnan(pc.flowCalibRate[i]) || pc.flowCalibRate[i]<=0) ? 1.0f : pc.flowCalibRate[i];
     flowCalibAccum[i] = (isnan(pc.flowCalibAccum[i])|| pc.flowCalibAccum[i]<=0)? 1.0f : pc.flowCalibAccum[i];
     flowCounterBase[i]= pc.flowCounterBase[i];
-    flowRateLmin[i]   = 0.0f;
-    lastPulseSnapshot[i] = 0;
+    flowRateReset(i);
 
     heatEnabled[i] = pc.heatEnabled[i];
     heatAddrA[i]   = pc.heatAddrA[i];
@@ -521,6 +714,89 @@ bool applyFromPersistV6(const PersistConfigV6 &pc){
   }
   memcpy(ledCfg, pc.ledCfg, sizeof(ledCfg));
   memcpy(btnCfg, pc.btnCfg, sizeof(btnCfg));
+  for (int i=0;i<NUM_DI;i++) diGlitchUs[i]=DI_GLITCH_US_DEFAULT;
+  for (int i=0;i<NUM_DI;i++){ flowAvgPulses[i]=FLOW_AVG_DEFAULT; flowZeroMs[i]=FLOW_ZERO_MS_DEFAULT; }
+  flowPublishMs = FLOW_PUBLISH_MS_DEFAULT;
+
+  nextRateTickMs = millis() + 1000;
+  return true;
+}
+
+// ----- migrate V7 -> RAM (adds glitch filter defaults) -----
+bool applyFromPersistV7(const PersistConfigV7 &pc){
+  if (pc.magic!=CFG_MAGIC || pc.size!=sizeof(PersistConfigV7)) return false;
+  PersistConfigV7 tmp=pc; uint32_t crc=tmp.crc32; tmp.crc32=0;
+  if (crc32_update(0,(const uint8_t*)&tmp,sizeof(tmp))!=crc) return false;
+  if (pc.version!=CFG_VERSION_V7) return false;
+
+  memcpy(diCfg, pc.diCfg, sizeof(diCfg));
+  memcpy(rlyCfg, pc.rlyCfg, sizeof(rlyCfg));
+  memcpy(localDesiredRelay, pc.localDesiredRelay, sizeof(localDesiredRelay));
+  modbusDesiredRelay[0]=modbusDesiredRelay[1]=false;
+
+  g_mb_address=pc.mb_address; g_mb_baud=pc.mb_baud;
+
+  for (int i=0;i<NUM_DI;i++){
+    flowPulsesPerL[i] = pc.flowPPL[i] ? pc.flowPPL[i] : 1;
+    flowCalibRate[i]  = (isnan(pc.flowCalibRate[i]) || pc.flowCalibRate[i]<=0) ? 1.0f : pc.flowCalibRate[i];
+    flowCalibAccum[i] = (isnan(pc.flowCalibAccum[i])|| pc.flowCalibAccum[i]<=0)? 1.0f : pc.flowCalibAccum[i];
+    flowCounterBase[i]= pc.flowCounterBase[i];
+    flowRateReset(i);
+
+    heatEnabled[i] = pc.heatEnabled[i];
+    heatAddrA[i]   = pc.heatAddrA[i];
+    heatAddrB[i]   = pc.heatAddrB[i];
+    heatCp[i]      = (isnan(pc.heatCp[i]) || pc.heatCp[i]<=0) ? 4186.0f : pc.heatCp[i];
+    heatRho[i]     = (isnan(pc.heatRho[i])|| pc.heatRho[i]<=0)? 1.0f    : pc.heatRho[i];
+    heatCalib[i]   = (isnan(pc.heatCalib[i])||pc.heatCalib[i]<=0)?1.0f  : pc.heatCalib[i];
+    heatEnergyJ[i] = isfinite(pc.heatEnergyJ[i]) ? pc.heatEnergyJ[i] : 0.0;
+  }
+  memcpy(ledCfg, pc.ledCfg, sizeof(ledCfg));
+  memcpy(btnCfg, pc.btnCfg, sizeof(btnCfg));
+  for (int i=0;i<NUM_RLY;i++) rlyCtrlMode[i] = (pc.relayCtrlMode[i]==1)?RCTRL_MODBUS:RCTRL_LOCAL;
+  for (int i=0;i<NUM_DI;i++) diGlitchUs[i]=DI_GLITCH_US_DEFAULT;
+  for (int i=0;i<NUM_DI;i++){ flowAvgPulses[i]=FLOW_AVG_DEFAULT; flowZeroMs[i]=FLOW_ZERO_MS_DEFAULT; }
+  flowPublishMs = FLOW_PUBLISH_MS_DEFAULT;
+
+  nextRateTickMs = millis() + 1000;
+  return true;
+}
+
+// ----- migrate V8 -> RAM (adds flow estimator defaults) -----
+bool applyFromPersistV8(const PersistConfigV8 &pc){
+  if (pc.magic!=CFG_MAGIC || pc.size!=sizeof(PersistConfigV8)) return false;
+  PersistConfigV8 tmp=pc; uint32_t crc=tmp.crc32; tmp.crc32=0;
+  if (crc32_update(0,(const uint8_t*)&tmp,sizeof(tmp))!=crc) return false;
+  if (pc.version!=CFG_VERSION_V8) return false;
+
+  memcpy(diCfg, pc.diCfg, sizeof(diCfg));
+  memcpy(rlyCfg, pc.rlyCfg, sizeof(rlyCfg));
+  memcpy(localDesiredRelay, pc.localDesiredRelay, sizeof(localDesiredRelay));
+  modbusDesiredRelay[0]=modbusDesiredRelay[1]=false;
+
+  g_mb_address=pc.mb_address; g_mb_baud=pc.mb_baud;
+
+  for (int i=0;i<NUM_DI;i++){
+    flowPulsesPerL[i] = pc.flowPPL[i] ? pc.flowPPL[i] : 1;
+    flowCalibRate[i]  = (isnan(pc.flowCalibRate[i]) || pc.flowCalibRate[i]<=0) ? 1.0f : pc.flowCalibRate[i];
+    flowCalibAccum[i] = (isnan(pc.flowCalibAccum[i])|| pc.flowCalibAccum[i]<=0)? 1.0f : pc.flowCalibAccum[i];
+    flowCounterBase[i]= pc.flowCounterBase[i];
+    flowRateReset(i);
+
+    heatEnabled[i] = pc.heatEnabled[i];
+    heatAddrA[i]   = pc.heatAddrA[i];
+    heatAddrB[i]   = pc.heatAddrB[i];
+    heatCp[i]      = (isnan(pc.heatCp[i]) || pc.heatCp[i]<=0) ? 4186.0f : pc.heatCp[i];
+    heatRho[i]     = (isnan(pc.heatRho[i])|| pc.heatRho[i]<=0)? 1.0f    : pc.heatRho[i];
+    heatCalib[i]   = (isnan(pc.heatCalib[i])||pc.heatCalib[i]<=0)?1.0f  : pc.heatCalib[i];
+    heatEnergyJ[i] = isfinite(pc.heatEnergyJ[i]) ? pc.heatEnergyJ[i] : 0.0;
+  }
+  memcpy(ledCfg, pc.ledCfg, sizeof(ledCfg));
+  memcpy(btnCfg, pc.btnCfg, sizeof(btnCfg));
+  for (int i=0;i<NUM_RLY;i++) rlyCtrlMode[i] = (pc.relayCtrlMode[i]==1)?RCTRL_MODBUS:RCTRL_LOCAL;
+  for (int i=0;i<NUM_DI;i++) diGlitchUs[i] = (pc.diGlitchUs[i]<=DI_GLITCH_US_MAX) ? pc.diGlitchUs[i] : DI_GLITCH_US_DEFAULT;
+  for (int i=0;i<NUM_DI;i++){ flowAvgPulses[i]=FLOW_AVG_DEFAULT; flowZeroMs[i]=FLOW_ZERO_MS_DEFAULT; }
+  flowPublishMs = FLOW_PUBLISH_MS_DEFAULT;
 
   nextRateTickMs = millis() + 1000;
   return true;
@@ -544,8 +820,7 @@ bool applyFromPersist(const PersistConfig &pc){
     flowCalibRate[i]  = (isnan(pc.flowCalibRate[i]) || pc.flowCalibRate[i]<=0) ? 1.0f : pc.flowCalibRate[i];
     flowCalibAccum[i] = (isnan(pc.flowCalibAccum[i])|| pc.flowCalibAccum[i]<=0)? 1.0f : pc.flowCalibAccum[i];
     flowCounterBase[i]= pc.flowCounterBase[i];
-    flowRateLmin[i]   = 0.0f;
-    lastPulseSnapshot[i] = 0;
+    flowRateReset(i);
 
     heatEnabled[i] = pc.heatEnabled[i];
     heatAddrA[i]   = pc.heatAddrA[i];
@@ -558,6 +833,12 @@ bool applyFromPersist(const PersistConfig &pc){
   memcpy(ledCfg, pc.ledCfg, sizeof(ledCfg));
   memcpy(btnCfg, pc.btnCfg, sizeof(btnCfg));
   for (int i=0;i<NUM_RLY;i++) rlyCtrlMode[i] = (pc.relayCtrlMode[i]==1)?RCTRL_MODBUS:RCTRL_LOCAL;
+  for (int i=0;i<NUM_DI;i++) diGlitchUs[i] = (pc.diGlitchUs[i]<=DI_GLITCH_US_MAX) ? pc.diGlitchUs[i] : DI_GLITCH_US_DEFAULT;
+  for (int i=0;i<NUM_DI;i++){
+    flowAvgPulses[i] = (pc.flowAvgPulses[i]>=1 && pc.flowAvgPulses[i]<=FLOW_AVG_MAX) ? pc.flowAvgPulses[i] : FLOW_AVG_DEFAULT;
+    flowZeroMs[i]    = (pc.flowZeroMs[i]>=FLOW_ZERO_MS_MIN && pc.flowZeroMs[i]<=FLOW_ZERO_MS_MAX) ? pc.flowZeroMs[i] : FLOW_ZERO_MS_DEFAULT;
+  }
+  flowPublishMs = (pc.flowPublishMs>=FLOW_PUBLISH_MS_MIN && pc.flowPublishMs<=FLOW_PUBLISH_MS_MAX) ? pc.flowPublishMs : FLOW_PUBLISH_MS_DEFAULT;
 
   nextRateTickMs = millis() + 1000;
   return true;
@@ -583,18 +864,30 @@ bool loadConfigFS(){
     PersistConfigV5 pc{}; size_t n=f.read((uint8_t*)&pc,sizeof(pc)); f.close();
     if(n!=sizeof(pc)){ WebSerial.send("message","load: short read (v5)"); return false; }
     if(!applyFromPersistV5(pc)){ WebSerial.send("message","load: v5 magic/version/crc mismatch"); return false; }
-    WebSerial.send("message","Loaded legacy config v5 → migrated to v7 (LED/BTN defaults + Local control).");
+    WebSerial.send("message","Loaded legacy config v5 → migrated to v9 (LED/BTN defaults + Local control).");
     return true;
   } else if (sz==sizeof(PersistConfigV6)){
     PersistConfigV6 pc{}; size_t n=f.read((uint8_t*)&pc,sizeof(pc)); f.close();
     if(n!=sizeof(pc)){ WebSerial.send("message","load: short read (v6)"); return false; }
     if(!applyFromPersistV6(pc)){ WebSerial.send("message","load: v6 magic/version/crc mismatch"); return false; }
-    WebSerial.send("message","Loaded legacy config v6 → migrated to v7 (relay control mode defaults to Local).");
+    WebSerial.send("message","Loaded legacy config v6 → migrated to v9 (relay control mode defaults to Local).");
+    return true;
+  } else if (sz==sizeof(PersistConfigV7)){
+    PersistConfigV7 pc{}; size_t n=f.read((uint8_t*)&pc,sizeof(pc)); f.close();
+    if(n!=sizeof(pc)){ WebSerial.send("message","load: short read (v7)"); return false; }
+    if(!applyFromPersistV7(pc)){ WebSerial.send("message","load: v7 magic/version/crc mismatch"); return false; }
+    WebSerial.send("message","Loaded legacy config v7 → migrated to v9 (pulse glitch filter defaults).");
+    return true;
+  } else if (sz==sizeof(PersistConfigV8)){
+    PersistConfigV8 pc{}; size_t n=f.read((uint8_t*)&pc,sizeof(pc)); f.close();
+    if(n!=sizeof(pc)){ WebSerial.send("message","load: short read (v8)"); return false; }
+    if(!applyFromPersistV8(pc)){ WebSerial.send("message","load: v8 magic/version/crc mismatch"); return false; }
+    WebSerial.send("message","Loaded legacy config v8 → migrated to v9 (flow rate estimator defaults).");
     return true;
   } else if (sz==sizeof(PersistConfig)){
     PersistConfig pc{}; size_t n=f.read((uint8_t*)&pc,sizeof(pc)); f.close();
-    if(n!=sizeof(pc)){ WebSerial.send("message","load: short read (v7)"); return false; }
-    if(!applyFromPersist(pc)){ WebSerial.send("message","load: v7 magic/version/crc mismatch"); return false; }
+    if(n!=sizeof(pc)){ WebSerial.send("message","load: short read (v9)"); return false; }
+    if(!applyFromPersist(pc)){ WebSerial.send("message","load: v9 magic/version/crc mismatch"); return false; }
     return true;
   } else {
     WebSerial.send("message",String("load: unexpected size ")+sz); f.close(); return false;
@@ -648,23 +941,35 @@ enum : uint16_t {
   HREG_HEAT_POWER_BASE  = 124, // 5×(S32)  W            (2 regs each) = 10 regs
   HREG_HEAT_EN_WH_BASE  = 134, // 5×(U32)  Wh ×1000     (2 regs each) = 10 regs
   HREG_HEAT_DT_BASE     = 144, // 5×(S32)  °C ×1000     (2 regs each) = 10 regs
-  HREG_OW_TEMP_BASE     = 154  // 10×(S32) °C ×1000     (2 regs each) = 20 regs
+  HREG_OW_TEMP_BASE     = 154, // 10×(S32) °C ×1000     (2 regs each) = 20 regs
   // Total: 1-173 (continuous)
+
+  // Diagnostics (U32, µs)
+  HREG_DIAG_LOOP_MAX_WIN = 180, // worst loop() interval, last 10 s window
+  HREG_DIAG_LOOP_MAX     = 182, // worst loop() interval since boot/reset
+  HREG_DIAG_OW_STEP_MAX  = 184  // longest 1-Wire scheduler step since boot/reset
 };
 
 // ================== 1-Wire DB helpers ==================
 int owdbIndexOf(uint64_t addr){ for(size_t i=0;i<g_owCount;i++) if(g_owDb[i].addr==addr) return (int)i; return -1; }
-inline uint32_t owdbPosOf(uint64_t addr){
-  int idx = owdbIndexOf(addr);
-  return (idx >= 0) ? (uint32_t)(idx + 1) : 0;
+// Re-resolves heat slots and address strings; call after any g_owDb / heatAddr change.
+void owBindingsRebuild(){
+  for (size_t i=0;i<g_owCount;i++) hex64To(g_owDb[i].addr, owAddrHex[i]);
+  for (int i=0;i<NUM_DI;i++){
+    heatSlotA[i] = heatAddrA[i] ? (int8_t)owdbIndexOf(heatAddrA[i]) : -1;
+    heatSlotB[i] = heatAddrB[i] ? (int8_t)owdbIndexOf(heatAddrB[i]) : -1;
+    if (heatAddrA[i]) hex64To(heatAddrA[i], heatAddrAHex[i]); else heatAddrAHex[i][0]=0;
+    if (heatAddrB[i]) hex64To(heatAddrB[i], heatAddrBHex[i]); else heatAddrBHex[i][0]=0;
+  }
 }
 JSONVar owdbBuildArray(){
   JSONVar arr;
   for(size_t i=0;i<g_owCount;i++){
     JSONVar o;
     o["pos"]  = (double)(i + 1);
-    o["addr"] = hex64(g_owDb[i].addr);
+    o["addr"] = owAddrHex[i];
     o["name"] = g_owDb[i].name.c_str();
+    o["res"]  = (double)g_owDb[i].res;
     arr[i] = o;
   }
   return arr;
@@ -672,7 +977,7 @@ JSONVar owdbBuildArray(){
 JSONVar owdbBuildIndexMap(){
   JSONVar map;
   for(size_t i=0;i<g_owCount;i++){
-    map[ hex64(g_owDb[i].addr) ] = (double)(i + 1);
+    map[ owAddrHex[i] ] = (double)(i + 1);
   }
   return map;
 }
@@ -692,9 +997,13 @@ bool owdbLoad(){
   for (unsigned i=0; i<arr.length() && g_owCount<MAX_OW_SENSORS; i++){
     const char* a=(const char*)arr[i]["addr"]; const char* n=(const char*)arr[i]["name"];
     if(!a||!n) continue; uint64_t v; if(!parseHex64(a,v)) continue;
-    g_owDb[g_owCount].addr=v; g_owDb[g_owCount].name=String(n); g_owCount++;
+    uint8_t res = OW_RES_DEFAULT;
+    if (JSON.typeof(arr[i]["res"])=="number") res = (uint8_t)constrain((int)arr[i]["res"], 9, 12);
+    g_owDb[g_owCount].addr=v; g_owDb[g_owCount].name=String(n); g_owDb[g_owCount].res=res; g_owCount++;
   }
-  for (size_t i=0;i<MAX_OW_SENSORS;i++){ owLastGoodTemp[i]=NAN; owLastGoodMs[i]=0; owErrCount[i]=0; }
+  for (size_t i=0;i<MAX_OW_SENSORS;i++){ owLastGoodTemp[i]=NAN; owLastGoodMs[i]=0; owErrCount[i]=0; owResPending[i]=false; }
+  owSchedAbort();
+  owBindingsRebuild();
   return true;
 }
 bool owdbAddOrUpdate(uint64_t addr, const char* name){
@@ -707,9 +1016,14 @@ bool owdbAddOrUpdate(uint64_t addr, const char* name){
     return ok;
   }
   if (g_owCount >= MAX_OW_SENSORS) return false;
+  owSchedAbort();
   g_owDb[g_owCount].addr = addr;
   g_owDb[g_owCount].name = String(name);
+  g_owDb[g_owCount].res  = OW_RES_DEFAULT;
+  owResPending[g_owCount] = false;
+  owLastGoodTemp[g_owCount] = NAN; owLastGoodMs[g_owCount] = 0; owErrCount[g_owCount] = 0;
   g_owCount++;
+  owBindingsRebuild();
   bool ok = owdbSave();
   if (ok) owdbSendList();
   return ok;
@@ -717,8 +1031,13 @@ bool owdbAddOrUpdate(uint64_t addr, const char* name){
 bool owdbRemove(uint64_t addr){
   int idx = owdbIndexOf(addr);
   if (idx < 0) return false;
-  for (size_t i = idx + 1; i < g_owCount; i++) g_owDb[i - 1] = g_owDb[i];
+  owSchedAbort();
+  for (size_t i = idx + 1; i < g_owCount; i++){
+    g_owDb[i - 1] = g_owDb[i]; owResPending[i - 1] = owResPending[i];
+    owLastGoodTemp[i - 1] = owLastGoodTemp[i]; owLastGoodMs[i - 1] = owLastGoodMs[i]; owErrCount[i - 1] = owErrCount[i];
+  }
   g_owCount--;
+  owBindingsRebuild();
   bool ok = owdbSave();
   if (ok) owdbSendList();
   return ok;
@@ -742,51 +1061,172 @@ void doOneWireScan();
 bool applyHeatCfgObjectToIndex(int idx, JSONVar o);
 
 // ---- DS18B20 helpers ----
-bool ds18b20StartConvertAll(){
-  oneWire.reset();
-  oneWire.skip();
-  oneWire.write(0x44, 1);
+inline uint8_t ds18b20CfgByte(uint8_t res){ return (uint8_t)(((constrain(res,9,12) - 9) << 5) | 0x1F); }
+inline uint32_t ds18b20ConvMs(uint8_t family, uint8_t res){
+  if (family == 0x10) return 750;               // DS18S20: fixed 750 ms
+  switch (res){ case 9: return 94; case 10: return 188; case 11: return 375; default: return 750; }
+}
+void romFromU64(uint64_t v, uint8_t rom[8]){ for (int i=0;i<8;i++){ rom[i]=(uint8_t)(v & 0xFF); v >>= 8; } }
+bool ds18b20Decode(const uint8_t rom[8], const uint8_t data[9], double &outC){
+  if (OneWire::crc8(data,8) != data[8]) return false;
+  int16_t raw = ((int16_t)data[1] << 8) | data[0];
+  if (rom[0] == 0x10) {
+    raw <<= 3;
+    if (data[7] == 0x10) raw = (raw & 0xFFF0) + 12 - data[6];
+  } else {
+    uint8_t cfg = (data[4] & 0x60);
+    if (cfg == 0x00)      raw &= ~0x7;
+    else if (cfg == 0x20) raw &= ~0x3;
+    else if (cfg == 0x40) raw &= ~0x1;
+  }
+  double t = (double)raw / 16.0;
+  if (t == 85.0 || t < -55.0 || t > 125.0) return false;
+  outC = t;
   return true;
 }
-bool ds18b20ReadTempC(uint64_t rom, double &outC){
-  if (!rom) return false;
-  uint8_t addr[8]; uint64_t v=rom;
-  for (int i=0;i<8;i++){ addr[i]=(uint8_t)(v & 0xFF); v >>= 8; }
-  auto try_once = [&](double &tOut)->bool{
-    if (!oneWire.reset()) return false;
-    oneWire.select(addr);
-    oneWire.write(0xBE);
-    uint8_t data[9];
-    for (int i=0;i<9;i++) data[i]=oneWire.read();
-    if (OneWire::crc8(data,8) != data[8]) return false;
-    int16_t raw = ((int16_t)data[1] << 8) | data[0];
-    if (addr[0] == 0x10) {
-      raw <<= 3;
-      if (data[7] == 0x10) raw = (raw & 0xFFF0) + 12 - data[6];
-    } else {
-      uint8_t cfg = (data[4] & 0x60);
-      if (cfg == 0x00)      raw &= ~0x7;
-      else if (cfg == 0x20) raw &= ~0x3;
-      else if (cfg == 0x40) raw &= ~0x1;
+
+// ================== 1-Wire scheduler ==================
+// Each call performs at most one bus primitive (reset or one byte, ~0.5–1 ms) so
+// mb.task() keeps running between steps. Cycle:
+//   OWS_CFG     -> read scratchpad, write it back with the new resolution (TH/TL
+//                  kept) for sensors with owResPending
+//   OWS_CONVERT -> reset, skip ROM, Convert T (all sensors in parallel)
+//   OWS_WAIT    -> wait for the slowest configured resolution (94..750 ms)
+//   OWS_READ    -> round-robin: reset, match ROM, read scratchpad, 1 retry
+void owSchedAbort(){
+  g_ow.st = OWS_IDLE; g_ow.step = 0; g_ow.idx = 0; g_ow.retry = 0;
+}
+uint32_t owConvWaitMs(){
+  uint32_t w = 0;
+  for (size_t i=0;i<g_owCount;i++){
+    // config write still pending (skipped this cycle): sensor may still be at 12 bit
+    uint32_t c = ds18b20ConvMs((uint8_t)(g_owDb[i].addr & 0xFF), owResPending[i] ? 12 : g_owDb[i].res);
+    if (c > w) w = c;
+  }
+  return w ? w : 750;
+}
+// Shared reset + match-ROM prefix: steps 0..9. Returns false if no presence pulse.
+bool owAddrStep(uint8_t step){
+  if (step == 0) return oneWire.reset() != 0;
+  if (step == 1){ oneWire.write(0x55); return true; }
+  oneWire.write(g_ow.rom[step - 2]);
+  return true;
+}
+void owSchedFinish(uint32_t now){
+  for (int i=0;i<NUM_DI;i++){
+    double ta=NAN, tb=NAN;
+    const int ia = heatSlotA[i];
+    const int ib = heatSlotB[i];
+    if (ia>=0 && ia<(int)g_owCount && owLastGoodMs[ia] && (now-owLastGoodMs[ia] <= OW_FAIL_HIDE_MS)) ta = owLastGoodTemp[ia];
+    if (ib>=0 && ib<(int)g_owCount && owLastGoodMs[ib] && (now-owLastGoodMs[ib] <= OW_FAIL_HIDE_MS)) tb = owLastGoodTemp[ib];
+    heatTA[i]=ta; heatTB[i]=tb;
+  }
+  heatIntegrate();      // fresh temperature sample closes the flow window
+  publishOneWireTemps();
+}
+void owSchedStep(uint32_t now){
+  switch (g_ow.st){
+    case OWS_IDLE:
+      if (g_owCount == 0 || !timeAfter32(now, g_ow.nextCycleMs)) return;
+      g_ow.nextCycleMs = now + OW_CYCLE_MS;
+      g_ow.st = OWS_CFG; g_ow.idx = 0; g_ow.step = 0;
+      return;
+
+    case OWS_CFG: {
+      while (g_ow.idx < g_owCount && !owResPending[g_ow.idx]) g_ow.idx++;
+      if (g_ow.idx >= g_owCount){ g_ow.st = OWS_CONVERT; g_ow.step = 0; return; }
+      if (g_ow.step == 0){
+        romFromU64(g_owDb[g_ow.idx].addr, g_ow.rom);
+        if (g_ow.rom[0] == 0x10){ owResPending[g_ow.idx] = false; g_ow.idx++; return; }  // no config register
+      }
+      // steps 0..19: read the scratchpad so the write keeps the user's TH/TL
+      // alarm bytes; 20..33: write TH, TL, config. Skipped (retried next cycle)
+      // if the sensor is absent or the read fails its CRC.
+      const uint8_t st = g_ow.step;
+      if (st <= 9 || (st >= 20 && st <= 29)){
+        if (!owAddrStep(st >= 20 ? st - 20 : st)){ g_ow.idx++; g_ow.step = 0; return; }
+      }
+      else if (st == 10) oneWire.write(0xBE);                        // read scratchpad
+      else if (st <= 19){
+        g_ow.data[st - 11] = oneWire.read();
+        if (st == 19 && OneWire::crc8(g_ow.data, 8) != g_ow.data[8]){ g_ow.idx++; g_ow.step = 0; return; }
+      }
+      else if (st == 30) oneWire.write(0x4E);                        // write scratchpad
+      else if (st == 31) oneWire.write(g_ow.data[2]);                // TH as read
+      else if (st == 32) oneWire.write(g_ow.data[3]);                // TL as read
+      else {
+        oneWire.write(ds18b20CfgByte(g_owDb[g_ow.idx].res));
+        owResPending[g_ow.idx] = false;
+        g_ow.idx++; g_ow.step = 0;
+        return;
+      }
+      g_ow.step++;
+      return;
     }
-    double t = (double)raw / 16.0;
-    if (t == 85.0 || t < -55.0 || t > 125.0) return false;
-    tOut = t;
-    return true;
-  };
-  double t;
-  if (try_once(t)) { outC=t; return true; }
-  delayMicroseconds(200);
-  if (try_once(t)) { outC=t; return true; }
-  return false;
+
+    case OWS_CONVERT:
+      if (g_ow.step == 0){
+        if (!oneWire.reset()){ g_ow.st = OWS_IDLE; return; }         // nobody on the bus
+      }
+      else if (g_ow.step == 1) oneWire.skip();
+      else {
+        oneWire.write(0x44, 1);
+        g_ow.waitUntilMs = now + owConvWaitMs();
+        g_ow.st = OWS_WAIT; g_ow.step = 0;
+        return;
+      }
+      g_ow.step++;
+      return;
+
+    case OWS_WAIT:
+      if (!timeAfter32(now, g_ow.waitUntilMs)) return;
+      g_ow.st = OWS_READ; g_ow.idx = 0; g_ow.step = 0; g_ow.retry = 0;
+      return;
+
+    case OWS_READ: {
+      if (g_ow.idx >= g_owCount){ g_ow.st = OWS_IDLE; owSchedFinish(now); return; }
+      const uint8_t i  = g_ow.idx;
+      const uint8_t st = g_ow.step;
+      bool fail = false, done = false;
+      if (st == 0){
+        if (!g_owDb[i].addr){ fail = true; }
+        else { romFromU64(g_owDb[i].addr, g_ow.rom); fail = !owAddrStep(0); }
+      }
+      else if (st <= 9)  owAddrStep(st);
+      else if (st == 10) oneWire.write(0xBE);                        // read scratchpad
+      else {
+        g_ow.data[st - 11] = oneWire.read();
+        if (st == 19){
+          double t;
+          if (ds18b20Decode(g_ow.rom, g_ow.data, t)){
+            owLastGoodTemp[i] = t;
+            owLastGoodMs[i]   = now;
+            owErrCount[i]     = 0;
+            if (g_ow.rom[0] != 0x10 && (g_ow.data[4] & 0x60) != (ds18b20CfgByte(g_owDb[i].res) & 0x60))
+              owResPending[i] = true;                                 // sensor lost its resolution (power cycle)
+            done = true;
+          } else fail = true;
+        }
+      }
+      if (fail){
+        if (g_ow.retry == 0 && g_owDb[i].addr){ g_ow.retry = 1; g_ow.step = 0; return; }
+        if (owErrCount[i] < 0xFFFFFFFF) owErrCount[i]++;
+        done = true;
+      }
+      if (done){ g_ow.idx++; g_ow.step = 0; g_ow.retry = 0; return; }
+      g_ow.step++;
+      return;
+    }
+  }
 }
+
 void publishOneWireTemps(){
   JSONVar owTemps, owErrs, owTempsList;
   uint32_t now = millis();
   for (size_t i=0; i<g_owCount; i++){
     bool fresh = (owLastGoodMs[i] != 0) && (now - owLastGoodMs[i] <= OW_FAIL_HIDE_MS);
     double t = fresh ? owLastGoodTemp[i] : NAN;
-    String addrHex = hex64(g_owDb[i].addr);
+    const char* addrHex = owAddrHex[i];
 
     owTemps[addrHex] = isfinite(t) ? t : NAN;
     owErrs[addrHex]  = (double)owErrCount[i];
@@ -808,9 +1248,187 @@ void buildCachedOwTemps(JSONVar &owTemps, JSONVar &owErrs){
   for (size_t i=0;i<g_owCount; i++){
     bool fresh = (owLastGoodMs[i] != 0) && (now - owLastGoodMs[i] <= OW_FAIL_HIDE_MS);
     double t = fresh ? owLastGoodTemp[i] : NAN;
-    owTemps[hex64(g_owDb[i].addr)] = isfinite(t) ? t : NAN;
-    owErrs[hex64(g_owDb[i].addr)]  = (double)owErrCount[i];
+    owTemps[owAddrHex[i]] = isfinite(t) ? t : NAN;
+    owErrs[owAddrHex[i]]  = (double)owErrCount[i];
+  }
+}
+
+// ================== Pulse capture ISR ==================
+// Runs on every edge of DI1..DI5 (CHANGE). Only counter inputs are counted (and
+// only they can reject); the level/action logic for the other types stays in loop().
+void di_isr_common(uint8_t i){
+  const uint32_t t = time_us_32();
+  const bool active = ((digitalRead(DI_PINS[i])==HIGH) != diCfg[i].inverted);
+  const bool counting = diCfg[i].enabled && diCfg[i].type==IT_WCOUNTER;
+  if (pulseEdge(pulseIn[i], active, t, diGlitchUs[i], counting)) pulsePush(pulseRing, pulseIn[i], i, t);
+}
+void di_isr_0(){ di_isr_common(0); }
+void di_isr_1(){ di_isr_common(1); }
+void di_isr_2(){ di_isr_common(2); }
+void di_isr_3(){ di_isr_common(3); }
+void di_isr_4(){ di_isr_common(4); }
+
+void pulseCaptureBegin(){
+  static void (*const isrs[NUM_DI])() = { di_isr_0, di_isr_1, di_isr_2, di_isr_3, di_isr_4 };
+  const uint32_t t = time_us_32();
+  for (uint8_t i=0;i<NUM_DI;i++){
+    pulseIn[i].active      = ((digitalRead(DI_PINS[i])==HIGH) != diCfg[i].inverted);
+    pulseIn[i].idleSinceUs = t;
+    pulseSeenCount[i] = pulseIn[i].count;
+    pulseDropsSeen[i] = pulseIn[i].drops;
+    attachInterrupt(digitalPinToInterrupt(DI_PINS[i]), isrs[i], CHANGE);
+  }
+}
+
+// Per-pulse hook, called from loop() context for every timestamp drained from the ring.
+void onFlowPulse(uint8_t i, uint32_t tUs){
+  if (flowHaveEdge[i] && !flowGap[i]){
+    const uint32_t per = tUs - diLastEdgeUs[i];
+    if (per > 0 && per <= flowZeroMs[i]*1000UL){
+      uint8_t win = flowAvgPulses[i]; if (win<1 || win>FLOW_AVG_MAX) win = FLOW_AVG_DEFAULT;
+      while (flowPerN[i] >= win){            // full window: drop oldest
+        uint8_t oldest = (uint8_t)((flowPerIdx[i] + FLOW_AVG_MAX - flowPerN[i]) % FLOW_AVG_MAX);
+        flowPerSum[i] -= flowPerUs[i][oldest];
+        flowPerN[i]--;
+      }
+      flowPerUs[i][flowPerIdx[i]] = per;
+      flowPerSum[i] += per;
+      flowPerIdx[i] = (uint8_t)((flowPerIdx[i] + 1) % FLOW_AVG_MAX);
+      flowPerN[i]++;
+      flowPps[i] = (float)((double)flowPerN[i] * 1e6 / (double)flowPerSum[i]);
+    } else {
+      // first pulse after an idle gap: restart the window
+      flowPerSum[i]=0; flowPerIdx[i]=0; flowPerN[i]=0; flowPps[i]=0.0f;
+    }
+  }
+  flowHaveEdge[i] = true;
+  flowGap[i] = false;
+  diLastEdgeUs[i] = tUs;
+}
+
+// Publishes flowRateLmin[] from the period estimator (called at flowPublishMs cadence).
+void flowRatePublish(){
+  const uint32_t nowUs = time_us_32();
+  for (uint8_t i=0;i<NUM_DI;i++){
+    if (!flowHaveEdge[i]){ flowRateLmin[i] = 0.0f; continue; }
+    const uint32_t since = nowUs - diLastEdgeUs[i];
+    if (since > flowZeroMs[i]*1000UL){ flowRateReset(i); continue; }
+    if (flowPerN[i]==0){ flowRateLmin[i] = 0.0f; continue; }   // single pulse, no period yet
+    double pps = (double)flowPps[i];
+    if (since > 0 && pps * (double)since > 1e6) pps = 1e6 / (double)since;   // overdue pulse: decay
+    const uint32_t ppl = flowPulsesPerL[i] ? flowPulsesPerL[i] : 1;
+    flowRateLmin[i] = (float)((pps / (double)ppl) * 60.0 * (double)flowCalibRate[i]);
+  }
+}
+
+// loop()-side consumer: folds ISR counts into diCounter and drains edge timestamps.
+// Lost timestamps (ring full during a long loop pass) must not become one long period.
+void drainPulseCapture(){
+  for (uint8_t i=0;i<NUM_DI;i++){
+    const uint32_t c = pulseIn[i].count;
+    diCounter[i] += (c - pulseSeenCount[i]);
+    pulseSeenCount[i] = c;
+  }
+  pulseDrain(pulseRing, pulseIn, pulseDropsSeen, NUM_DI,
+             [](uint8_t i, uint32_t tUs){ onFlowPulse(i, tUs); },
+             [](uint8_t i){ flowGap[i] = true; });
+}
+
+// ================== Heat energy ==================
+// Sample-synchronous: ΔE = ΔV · ρ · cp · ½(ΔT_prev + ΔT_now) · calib, where ΔV
+// is the metered volume between two temperature samples. It steps only when
+// both sensors of a channel delivered a new reading (owSchedFinish, ~1 s), so
+// ΔT is never reused across windows; a missed read just widens the window.
+void heatIntegrateSync(){
+  for (int i=0;i<NUM_DI;i++){ heatLastCount[i] = diCounter[i]; heatLastDT[i] = NAN; }
+}
+void heatIntegrate(){
+  for (int i=0;i<NUM_DI;i++){
+    const uint32_t c = diCounter[i];
+    if (diCfg[i].type!=IT_WCOUNTER || !heatEnabled[i] ||
+        !isfinite(heatTA[i]) || !isfinite(heatTB[i])) {
+      heatLastCount[i]=c; heatDT[i]=0.0; heatLastDT[i]=NAN;
+      continue;
+    }
+    // finite heatTA/TB imply both slots are bound
+    const uint32_t sa = owLastGoodMs[heatSlotA[i]], sb = owLastGoodMs[heatSlotB[i]];
+    if (sa==heatSampleMsA[i] || sb==heatSampleMsB[i]) continue;                   // no new pair yet
+    heatSampleMsA[i]=sa; heatSampleMsB[i]=sb;
+
+    const uint32_t dp = (c >= heatLastCount[i]) ? (c - heatLastCount[i]) : 0;   // counter reset -> resync
+    heatLastCount[i] = c;
+    const double dT = heatTA[i] - heatTB[i];
+    heatDT[i] = dT;
+    if (dp){
+      const double k   = (double)heatRho[i] * (double)heatCp[i] * (double)heatCalib[i];   // J/(L·K)
+      const uint32_t ppl = flowPulsesPerL[i] ? flowPulsesPerL[i] : 1;
+      const double dV  = ((double)dp / (double)ppl) * (double)flowCalibAccum[i];       // L
+      const double dTw = isfinite(heatLastDT[i]) ? 0.5 * (heatLastDT[i] + dT) : dT;
+      heatEnergyJ[i] += dV * k * dTw;
+    }
+    heatLastDT[i] = dT;
+  }
+}
+// Display power from the current flow rate and the latest ΔT (flow publish cadence)
+void heatPowerUpdate(){
+  for (int i=0;i<NUM_DI;i++){
+    if (diCfg[i].type!=IT_WCOUNTER || !heatEnabled[i] || !isfinite(heatLastDT[i])) { heatPowerW[i]=0.0; continue; }
+    const double m_dot = ((double)flowRateLmin[i] / 60.0) * (double)heatRho[i];        // kg/s
+    heatPowerW[i] = m_dot * (double)heatCp[i] * heatDT[i] * (double)heatCalib[i];
+  }
+}
+
+bool heatJnlAppend(){
+  HeatJnlRec r{}; r.magic = HEAT_JNL_MAGIC; r.seq = heatJnlSeq + 1;
+  for (int i=0;i<NUM_DI;i++) r.energyJ[i] = heatEnergyJ[i];
+  r.crc32 = 0; r.crc32 = crc32_update(0,(const uint8_t*)&r,sizeof(r));
+
+  bool rotate = (heatJnlRecs >= HEAT_JNL_MAX_RECS);
+  uint8_t fi = rotate ? (uint8_t)(heatJnlFile ^ 1) : heatJnlFile;
+  File f = LittleFS.open(HEAT_JNL_PATH[fi], rotate ? "w" : "a");
+  if (!f) return false;
+  size_t n = f.write((const uint8_t*)&r, sizeof(r)); f.close();
+  if (n != sizeof(r)) return false;
+
+  heatJnlSeq = r.seq; heatJnlFile = fi; heatJnlRecs = rotate ? 1 : (uint16_t)(heatJnlRecs + 1);
+  heatJnlLastMs = millis(); heatJnlWrites++;
+  for (int i=0;i<NUM_DI;i++) heatJnlLastJ[i] = heatEnergyJ[i];
+  return true;
+}
+// Restores heatEnergyJ from the newest valid record of either file.
+bool heatJnlLoad(){
+  bool found = false;
+  for (uint8_t fi=0; fi<2; fi++){
+    File f = LittleFS.open(HEAT_JNL_PATH[fi], "r");
+    if (!f) continue;
+    uint16_t recs = 0;
+    HeatJnlRec r{};
+    while (f.read((uint8_t*)&r, sizeof(r)) == sizeof(r)){
+      recs++;
+      HeatJnlRec tmp = r; uint32_t crc = tmp.crc32; tmp.crc32 = 0;
+      if (r.magic != HEAT_JNL_MAGIC || crc32_update(0,(const uint8_t*)&tmp,sizeof(tmp)) != crc) continue;
+      if (found && (int32_t)(r.seq - heatJnlSeq) <= 0) continue;
+      found = true; heatJnlSeq = r.seq; heatJnlFile = fi;
+      for (int i=0;i<NUM_DI;i++) heatEnergyJ[i] = isfinite(r.energyJ[i]) ? r.energyJ[i] : 0.0;
+    }
+    f.close();
+    if (found && heatJnlFile == fi) heatJnlRecs = recs;
   }
+  for (int i=0;i<NUM_DI;i++) heatJnlLastJ[i] = heatEnergyJ[i];
+  heatJnlLastMs = millis();
+  return found;
+}
+// Rate-limited checkpoint; force=true for user-visible changes (reset, save).
+void heatJnlCheckpoint(bool force){
+  const uint32_t now = millis();
+  if (!force){
+    if ((uint32_t)(now - heatJnlLastMs) < HEAT_JNL_MIN_MS) return;
+    double moved = 0.0;
+    for (int i=0;i<NUM_DI;i++){ double d = fabs(heatEnergyJ[i] - heatJnlLastJ[i]); if (d > moved) moved = d; }
+    if (moved <= 0.0) return;
+    if (moved < HEAT_JNL_STEP_J && (uint32_t)(now - heatJnlLastMs) < HEAT_JNL_MAX_MS) return;
+  }
+  if (!heatJnlAppend()) WebSerial.send("message","heat journal: write failed");
 }
 
 // ================== Setup ==================
@@ -829,10 +1447,15 @@ void setup(){
   if(!initFilesystemAndConfig()){ WebSerial.send("message","FATAL: Filesystem/config init failed"); }
   if(owdbLoad()) WebSerial.send("message","1-Wire DB loaded from flash");
   else           WebSerial.send("message","1-Wire DB missing/invalid (will create on first save)");
+  owBindingsRebuild();
+  if (heatJnlLoad()) WebSerial.send("message","Heat energy restored from journal");
+  heatIntegrateSync();
 
 
   publishOneWireTemps();
 
+  pulseCaptureBegin();
+
   Serial2.setTX(TX2); Serial2.setRX(RX2);
   Serial2.begin(g_mb_baud); mb.config(g_mb_baud); setSlaveIdIfAvailable(mb, g_mb_address);
   mb.setAdditionalServerData("WLD-521-R1");
@@ -889,6 +1512,9 @@ void setup(){
     mb.addHreg(b+0,0); mb.addHreg(b+1,0);
   }
 
+  // Diagnostics
+  for (uint16_t r=HREG_DIAG_LOOP_MAX_WIN; r<HREG_DIAG_OW_STEP_MAX+2; r++) mb.addHreg(r,0);
+
   modbusStatus["address"]=g_mb_address; modbusStatus["baud"]=g_mb_baud; modbusStatus["state"]=0;
 
   WebSerial.on("values",  handleValues);
@@ -949,6 +1575,7 @@ bool applyHeatCfgObjectToIndex(int idx, JSONVar o){
   if (jsonGetDouble(o,"rho",dv) && dv>0) heatRho[idx]=(float)dv;
   if (jsonGetDouble(o,"calib",dv) && dv>0) heatCalib[idx]=(float)dv;
 
+  owBindingsRebuild();
   return true;
 }
 
@@ -995,12 +1622,11 @@ void handleUnifiedConfig(JSONVar obj){
     changed = true;
   }
   else if (type=="counterResetList"){
-    uint32_t now = millis();
     for (int i=0;i<NUM_DI && i<list.length();i++){
       if ((bool)list[i]){
         diCounter[i]=0;
-        diLastEdgeMs[i]=now;
-        lastPulseSnapshot[i]=0;
+        diLastEdgeUs[i]=0;
+        flowRateReset(i);
         flowCounterBase[i]=0;
       }
     }
@@ -1031,6 +1657,40 @@ void handleUnifiedConfig(JSONVar obj){
     WebSerial.send("message","Flow: pulsesPerLiter updated");
     changed = true;
   }
+  else if (type=="flowGlitchUs"){
+    for (int i=0;i<NUM_DI && i<list.length(); i++){
+      long v = (long)(double)list[i];
+      if (v < 0) v = 0;
+      if (v > (long)DI_GLITCH_US_MAX) v = DI_GLITCH_US_MAX;
+      diGlitchUs[i] = (uint32_t)v;
+    }
+    WebSerial.send("message","Flow: pulse glitch filter (us) updated");
+    changed = true;
+  }
+  else if (type=="flowSmoothN"){
+    for (int i=0;i<NUM_DI && i<list.length(); i++){
+      int v = (int)list[i];
+      flowAvgPulses[i] = (uint8_t)constrain(v, 1, (int)FLOW_AVG_MAX);
+      flowRateReset(i);
+    }
+    WebSerial.send("message","Flow: rate smoothing window (pulses) updated");
+    changed = true;
+  }
+  else if (type=="flowZeroTimeoutMs"){
+    for (int i=0;i<NUM_DI && i<list.length(); i++){
+      long v = (long)(double)list[i];
+      flowZeroMs[i] = (uint32_t)constrain(v, (long)FLOW_ZERO_MS_MIN, (long)FLOW_ZERO_MS_MAX);
+    }
+    WebSerial.send("message","Flow: zero-flow timeout updated");
+    changed = true;
+  }
+  else if (type=="flowPublishMs"){
+    double v = 0.0;
+    if (!jsonGetDouble(obj, "value", v) && list.length()>0) v = (double)list[0];
+    flowPublishMs = (uint16_t)constrain((long)v, (long)FLOW_PUBLISH_MS_MIN, (long)FLOW_PUBLISH_MS_MAX);
+    WebSerial.send("message", String("Flow: rate publish interval = ")+String(flowPublishMs)+" ms");
+    changed = true;
+  }
   else if (type=="flowCalib"){
     for (int i=0;i<NUM_DI && i<list.length(); i++){
       double v = (double)list[i];
@@ -1077,8 +1737,8 @@ void handleUnifiedConfig(JSONVar obj){
         line += "enabled="; line += (heatEnabled[i] ? "true" : "false");
         line += " A=";      line += (heatAddrA[i] ? hex64(heatAddrA[i]) : "''");
         line += " B=";      line += (heatAddrB[i] ? hex64(heatAddrB[i]) : "''");
-        line += " posA=";   line += String(owdbPosOf(heatAddrA[i]));
-        line += " posB=";   line += String(owdbPosOf(heatAddrB[i]));
+        line += " posA=";   line += String(heatSlotA[i]+1);
+        line += " posB=";   line += String(heatSlotB[i]+1);
         line += " cp=";     line += String(heatCp[i], 0);
         line += " rho=";    line += String(heatRho[i], 3);
         line += " calib=";  line += String(heatCalib[i], 4);
@@ -1091,6 +1751,7 @@ void handleUnifiedConfig(JSONVar obj){
     for (int i=0;i<NUM_DI && i<list.length(); i++){
       if ((bool)list[i]) heatEnergyJ[i]=0.0;
     }
+    heatJnlCheckpoint(true);
     WebSerial.send("message","Heat: energy counters reset");
     changed = true;
   }
@@ -1111,8 +1772,8 @@ void handleUnifiedConfig(JSONVar obj){
     line += "enabled="; line += (heatEnabled[di] ? "true" : "false");
     line += " A=";      line += (heatAddrA[di] ? hex64(heatAddrA[di]) : "''");
     line += " B=";      line += (heatAddrB[di] ? hex64(heatAddrB[di]) : "''");
-    line += " posA=";   line += String(owdbPosOf(heatAddrA[di]));
-    line += " posB=";   line += String(owdbPosOf(heatAddrB[di]));
+    line += " posA=";   line += String(heatSlotA[di]+1);
+    line += " posB=";   line += String(heatSlotB[di]+1);
     line += " cp=";     line += String(heatCp[di], 0);
     line += " rho=";    line += String(heatRho[di], 3);
     line += " calib=";  line += String(heatCalib[di], 4);
@@ -1150,16 +1811,17 @@ void handleCommand(JSONVar obj){
   const char* actC=(const char*)obj["action"]; if(!actC){ WebSerial.send("message","command: missing 'action'"); return; }
   String act=String(actC); act.toLowerCase();
 
-  if (act=="save"){ if (saveConfigFS()) WebSerial.send("message","Configuration saved"); else WebSerial.send("message","ERROR: Save failed"); return; }
-  if (act=="load"){ if (loadConfigFS()){ WebSerial.send("message","Configuration loaded"); sendAllEchoesOnce(); applyModbusSettings(g_mb_address,g_mb_baud); }
+  if (act=="save"){ heatJnlCheckpoint(true); if (saveConfigFS()) WebSerial.send("message","Configuration saved"); else WebSerial.send("message","ERROR: Save failed"); return; }
+  if (act=="load"){ if (loadConfigFS()){ owBindingsRebuild(); heatJnlLoad(); heatIntegrateSync(); WebSerial.send("message","Configuration loaded"); sendAllEchoesOnce(); applyModbusSettings(g_mb_address,g_mb_baud); }
                     else WebSerial.send("message","ERROR: Load failed/invalid"); return; }
   if (act=="factory"){
-    setDefaults(); saveConfigFS();
+    setDefaults(); saveConfigFS(); owBindingsRebuild(); heatIntegrateSync(); heatJnlCheckpoint(true);
     WebSerial.send("message","Factory defaults restored & saved");
     sendAllEchoesOnce(); applyModbusSettings(g_mb_address,g_mb_baud);
     return;
   }
   if (act=="scan"||act=="scan1wire"||act=="scan_1wire"||act=="scan1w"){ doOneWireScan(); return; }
+  if (act=="diag_reset"){ loopTimingReset(); WebSerial.send("message","Loop timing statistics reset"); return; }
 
 
   // flow/heat helpers kept
@@ -1211,7 +1873,7 @@ void handleCommand(JSONVar obj){
   if (act=="heat_reset"){
     int di=-1; if (obj.hasOwnProperty("di")) di=(int)obj["di"];
     if (di>=1 && di<=NUM_DI) di-=1;
-    if (di>=0 && di<NUM_DI){ heatEnergyJ[di]=0.0; WebSerial.send("message", String("heat_reset: DI")+String(di+1)); }
+    if (di>=0 && di<NUM_DI){ heatEnergyJ[di]=0.0; heatJnlCheckpoint(true); WebSerial.send("message", String("heat_reset: DI")+String(di+1)); }
     else WebSerial.send("message","heat_reset: invalid 'di'");
     return;
   }
@@ -1225,7 +1887,7 @@ void handleOneWire(JSONVar obj){
   String act=String(actC); act.toLowerCase();
 
   if (act=="list"){ owdbSendList(); return; }
-  if (act=="clear"){ g_owCount=0; if(owdbSave()) WebSerial.send("message","onewire: cleared"); else WebSerial.send("message","onewire: clear save failed"); owdbSendList(); return; }
+  if (act=="clear"){ owSchedAbort(); g_owCount=0; owBindingsRebuild(); if(owdbSave()) WebSerial.send("message","onewire: cleared"); else WebSerial.send("message","onewire: clear save failed"); owdbSendList(); return; }
 
   uint64_t addr=0;
   if (!jsonGetAddr64(obj, "addr_u64_str", addr)){ WebSerial.send("message","onewire: invalid or missing address (expect rom_hex or addr_hi/addr_lo)"); return; }
@@ -1238,6 +1900,16 @@ void handleOneWire(JSONVar obj){
     } else {
       WebSerial.send("message","onewire: save failed (maybe full?)"); owdbSendList();
     }
+  } else if (act=="resolution"||act=="res"){
+    double r=0;
+    if (!jsonGetDouble(obj,"res",r) || r<9 || r>12){ WebSerial.send("message","onewire: 'res' must be 9..12"); return; }
+    int idx = owdbIndexOf(addr);
+    if (idx < 0){ WebSerial.send("message","onewire: address not found"); return; }
+    g_owDb[idx].res = (uint8_t)r;
+    owResPending[idx] = true;
+    if (owdbSave()) owdbSendList();
+    String msg; msg.reserve(64); msg += "onewire: "; msg += hex64(addr); msg += " resolution "; msg += String((int)r); msg += " bit";
+    WebSerial.send("message", msg);
   } else if (act=="remove"||act=="delete"){
     if (owdbRemove(addr)) {
       String msg; msg.reserve(64); msg += "onewire: removed "; msg += hex64(addr);
@@ -1288,8 +1960,8 @@ void processModbusCommands(){
     if (mb.Coil(CMD_CNT_RST_BASE+i)) {
       mb.setCoil(CMD_CNT_RST_BASE+i, false);
       diCounter[i]=0;
-      diLastEdgeMs[i]=millis();
-      lastPulseSnapshot[i]=0;
+      diLastEdgeUs[i]=0;
+      flowRateReset(i);
       flowCounterBase[i]=0;
     }
   }
@@ -1310,10 +1982,40 @@ void applyActionToTarget(uint8_t tgt, uint8_t action, uint32_t now){
   cfgDirty=true; lastCfgTouchMs=now;
 }
 
+// ================== Loop timing ==================
+// Start-to-start interval of loop(): includes everything that runs between two
+// passes (core USB/serial servicing, LittleFS saves, WebSerial bursts).
+void loopTimingUpdate(uint32_t nowMs){
+  const uint32_t t = micros();
+  if (loopPrevStartUs){
+    const uint32_t dt = t - loopPrevStartUs;
+    if (dt > loopMaxUs)    loopMaxUs = dt;
+    if (dt > loopMaxWinUs) loopMaxWinUs = dt;
+  }
+  loopPrevStartUs = t;
+  if (nowMs - loopWinStartMs >= LOOP_STAT_WIN_MS){
+    loopMaxLastWinUs = loopMaxWinUs; loopMaxWinUs = 0; loopWinStartMs = nowMs;
+  }
+}
+void loopTimingReset(){
+  loopMaxUs = loopMaxWinUs = loopMaxLastWinUs = 0; owStepMaxUs = 0;
+  loopPrevStartUs = 0; loopWinStartMs = millis();
+}
+
 // ================== Loop ==================
 void loop(){
   unsigned long now=millis();
+  loopTimingUpdate(now);
   mb.task(); processModbusCommands();
+  drainPulseCapture();
+
+  // 1-Wire: one bus primitive per pass
+  {
+    const uint32_t t0 = micros();
+    owSchedStep(now);
+    const uint32_t dt = micros() - t0;
+    if (dt > owStepMaxUs) owStepMaxUs = dt;
+  }
 
   // blink phase
   if(now-lastBlinkToggle>=blinkPeriodMs){ lastBlinkToggle=now; blinkPhase=!blinkPhase; }
@@ -1342,10 +2044,7 @@ void loop(){
     bool rising=(!prev && val);
 
     if (diCfg[i].type==IT_WCOUNTER){
-      if (rising && (now - diLastEdgeMs[i] >= CNT_DEBOUNCE_MS)){
-        diCounter[i]++; diLastEdgeMs[i]=now;
-        // NOTE: Modbus HREG counters removed; keep internal/WebSerial only
-      }
+      // counted by the pulse capture ISR (drainPulseCapture)
     } else {
       uint8_t act=diCfg[i].action;
       if (act==1){ if (rising || (prev && !val)) applyActionToTarget(diCfg[i].target,1,now); }
@@ -1431,62 +2130,17 @@ void loop(){
     ledConfigArray[i]=L;
   }
 
+  // ===== Flow rate publish (period estimator, flowPublishMs cadence) =====
+  if (timeAfter32(now, nextFlowPublishMs)) {
+    nextFlowPublishMs = now + flowPublishMs;
+    flowRatePublish();
+    heatPowerUpdate();
+  }
+
   // ===== 1s tick =====
   if (timeAfter32(now, nextRateTickMs)) {
-    uint32_t dt_ms = 1000;
     nextRateTickMs = now + 1000;
-
-    // OneWire convert / read / cache
-    if (!oneWireBusy) {
-      ds18b20StartConvertAll();
-      oneWireBusy = true;
-      nextOneWireConvertMs = now + 1500;
-    } else if (timeAfter32(now, nextOneWireConvertMs)) {
-      for (size_t i=0; i<g_owCount; i++){
-        double t;
-        if (ds18b20ReadTempC(g_owDb[i].addr, t)) {
-          owLastGoodTemp[i] = t;
-          owLastGoodMs[i]   = now;
-          owErrCount[i]     = 0;
-        } else {
-          if (owErrCount[i] < 0xFFFFFFFF) owErrCount[i]++;
-        }
-      }
-      for (int i=0;i<NUM_DI;i++){
-        double ta=NAN, tb=NAN;
-        int ia = owdbIndexOf(heatAddrA[i]);
-        int ib = owdbIndexOf(heatAddrB[i]);
-        if (ia>=0 && ia<(int)g_owCount && owLastGoodMs[ia] && (now-owLastGoodMs[ia] <= OW_FAIL_HIDE_MS)) ta = owLastGoodTemp[ia];
-        if (ib>=0 && ib<(int)g_owCount && owLastGoodMs[ib] && (now-owLastGoodMs[ib] <= OW_FAIL_HIDE_MS)) tb = owLastGoodTemp[ib];
-        heatTA[i]=ta; heatTB[i]=tb;
-      }
-      publishOneWireTemps();
-      oneWireBusy=false;
-    }
-
-    // Flow: update rate from counters
-    for (int i=0;i<NUM_DI;i++){
-      uint32_t ppl   = flowPulsesPerL[i] ? flowPulsesPerL[i] : 1;
-      uint32_t delta = diCounter[i] - lastPulseSnapshot[i];
-      lastPulseSnapshot[i] = diCounter[i];
-      float liters_last_sec = ((float)delta / (float)ppl) * flowCalibRate[i];
-      flowRateLmin[i] = liters_last_sec * 60.0f;
-    }
-
-    // Heat power & energy integration
-    for (int i=0;i<NUM_DI;i++){
-      double P=0.0; double dT=0.0;
-      if (diCfg[i].type==IT_WCOUNTER && heatEnabled[i] &&
-          isfinite(heatTA[i]) && isfinite(heatTB[i])) {
-        dT = (heatTA[i] - heatTB[i]);
-        double m_dot = ((double)flowRateLmin[i] / 60.0) * (double)heatRho[i]; // kg/s
-        P = m_dot * (double)heatCp[i] * dT;     // W
-        P *= (double)heatCalib[i];
-        heatEnergyJ[i] += P * (dt_ms/1000.0);   // J
-      }
-      heatDT[i]=dT; heatPowerW[i]=P;
-    }
-
+    heatJnlCheckpoint(false);
   }
 
   // ===== Update Modbus Holding Registers =====
@@ -1526,6 +2180,10 @@ void loop(){
     setHreg32s(HREG_OW_TEMP_BASE + (i*2), temp_milli);
   }
 
+  setHreg32(HREG_DIAG_LOOP_MAX_WIN, loopMaxLastWinUs);
+  setHreg32(HREG_DIAG_LOOP_MAX,     loopMaxUs);
+  setHreg32(HREG_DIAG_OW_STEP_MAX,  owStepMaxUs);
+
   if (millis()-lastSend>=sendInterval){
     lastSend=millis();
     WebSerial.check();
@@ -1540,11 +2198,17 @@ void loop(){
     for (int i=0;i<NUM_RLY;i++){ relayEnableList[i]=rlyCfg[i].enabled; relayInvertList[i]=rlyCfg[i].inverted; }
 
     JSONVar flowPPLList, flowCalibList, flowAccumList, flowRateList, flowCalibRateList, flowCalibAccumList;
+    JSONVar flowGlitchList, pulseRejectList, flowSmoothList, flowZeroList;
     for (int i=0;i<NUM_DI;i++){
       uint32_t ppl = flowPulsesPerL[i] ? flowPulsesPerL[i] : 1;
       uint32_t pulses_since = (diCounter[i] >= flowCounterBase[i]) ? (diCounter[i] - flowCounterBase[i]) : 0;
       double accumL = ((double)pulses_since / (double)ppl) * (double)flowCalibAccum[i];
 
+      flowGlitchList[i]      = (double)diGlitchUs[i];
+      pulseRejectList[i]     = (double)pulseIn[i].rejects;
+      flowSmoothList[i]      = (double)flowAvgPulses[i];
+      flowZeroList[i]        = (double)flowZeroMs[i];
+
       flowPPLList[i]         = (double)flowPulsesPerL[i];
       flowCalibList[i]       = (double)flowCalibAccum[i];
       flowCalibRateList[i]   = (double)flowCalibRate[i];
@@ -1559,11 +2223,11 @@ void loop(){
 
     for (int i=0;i<NUM_DI;i++){
       heatEnabledList[i]=heatEnabled[i];
-      heatAddrAList[i]= (heatAddrA[i] ? hex64(heatAddrA[i]) : "");
-      heatAddrBList[i]= (heatAddrB[i] ? hex64(heatAddrB[i]) : "");
+      heatAddrAList[i]= heatAddrAHex[i];
+      heatAddrBList[i]= heatAddrBHex[i];
 
-      heatAddrAPosList[i] = (double)owdbPosOf(heatAddrA[i]);
-      heatAddrBPosList[i] = (double)owdbPosOf(heatAddrB[i]);
+      heatAddrAPosList[i] = (double)(heatSlotA[i]+1);
+      heatAddrBPosList[i] = (double)(heatSlotB[i]+1);
 
       heatCpList[i]=(double)heatCp[i];
       heatRhoList[i]=(double)heatRho[i];
@@ -1599,6 +2263,11 @@ void loop(){
     WebSerial.send("flowCalibAccumList", flowCalibAccumList);
     WebSerial.send("flowAccumList", flowAccumList);
     WebSerial.send("flowRateList",  flowRateList);
+    WebSerial.send("flowGlitchUsList",  flowGlitchList);
+    WebSerial.send("pulseRejectList",   pulseRejectList);
+    WebSerial.send("flowSmoothNList",   flowSmoothList);
+    WebSerial.send("flowZeroTimeoutMsList", flowZeroList);
+    WebSerial.send("flowPublishMs",     JSONVar((double)flowPublishMs));
 
     WebSerial.send("heatEnabledList",   heatEnabledList);
     WebSerial.send("heatAddrAList",     heatAddrAList);
@@ -1629,6 +2298,12 @@ void loop(){
     for (int i=0;i<NUM_RLY;i++){ rcList[i]=(double)((rlyCtrlMode[i]==RCTRL_MODBUS)?1:0); }
     WebSerial.send("relayCtrlMode", rcList);
 
+    JSONVar loopStats;
+    loopStats["loopMaxWinUs"] = (double)loopMaxLastWinUs;
+    loopStats["loopMaxUs"]    = (double)loopMaxUs;
+    loopStats["owStepMaxUs"]  = (double)owStepMaxUs;
+    WebSerial.send("loopStats", loopStats);
+
     owdbSendList();
   }
 
@@ -1659,11 +2334,16 @@ void sendAllEchoesOnce(){
   WebSerial.send("relayInvertList", relayInvertList);
 
   JSONVar flowPPLList, flowCalibList, flowAccumList, flowRateList, flowCalibRateList, flowCalibAccumList;
+  JSONVar flowGlitchList, flowSmoothList, flowZeroList;
   for (int i=0;i<NUM_DI;i++){
     uint32_t ppl = flowPulsesPerL[i] ? flowPulsesPerL[i] : 1;
     uint32_t pulses_since = (diCounter[i] >= flowCounterBase[i]) ? (diCounter[i] - flowCounterBase[i]) : 0;
     double accumL = ((double)pulses_since / (double)ppl) * (double)flowCalibAccum[i];
 
+    flowGlitchList[i]      = (double)diGlitchUs[i];
+    flowSmoothList[i]      = (double)flowAvgPulses[i];
+    flowZeroList[i]        = (double)flowZeroMs[i];
+
     flowPPLList[i]         = (double)flowPulsesPerL[i];
     flowCalibList[i]       = (double)flowCalibAccum[i];
     flowCalibRateList[i]   = (double)flowCalibRate[i];
@@ -1677,17 +2357,21 @@ void sendAllEchoesOnce(){
   WebSerial.send("flowCalibAccumList", flowCalibAccumList);
   WebSerial.send("flowAccumList", flowAccumList);
   WebSerial.send("flowRateList",  flowRateList);
+  WebSerial.send("flowGlitchUsList", flowGlitchList);
+  WebSerial.send("flowSmoothNList",  flowSmoothList);
+  WebSerial.send("flowZeroTimeoutMsList", flowZeroList);
+  WebSerial.send("flowPublishMs",    JSONVar((double)flowPublishMs));
 
   JSONVar heatEnabledList, heatAddrAList, heatAddrBList, heatAddrAPosList, heatAddrBPosList;
   JSONVar heatCpList, heatRhoList, heatCalibList;
   JSONVar heatTAList, heatTBList, heatDTList, heatPowerList, heatEnergyJList, heatEnergyKWhList;
   for (int i=0;i<NUM_DI;i++){
     heatEnabledList[i]=heatEnabled[i];
-    heatAddrAList[i]= (heatAddrA[i] ? hex64(heatAddrA[i]) : "");
-    heatAddrBList[i]= (heatAddrB[i] ? hex64(heatAddrB[i]) : "");
+    heatAddrAList[i]= heatAddrAHex[i];
+    heatAddrBList[i]= heatAddrBHex[i];
 
-    heatAddrAPosList[i] = (double)owdbPosOf(heatAddrA[i]);
-    heatAddrBPosList[i] = (double)owdbPosOf(heatAddrB[i]);
+    heatAddrAPosList[i] = (double)(heatSlotA[i]+1);
+    heatAddrBPosList[i] = (double)(heatSlotB[i]+1);
 
     heatCpList[i]=(double)heatCp[i];
     heatRhoList[i]=(double)heatRho[i];
@@ -1744,6 +2428,7 @@ void sendAllEchoesOnce(){
 
 void doOneWireScan(){
   JSONVar romList; uint8_t addr[8]; int idx=0; int found=0;
+  owSchedAbort();
   oneWire.reset_search();
   while(oneWire.search(addr)){
     if (OneWire::crc8(addr,7)!=addr[7]) continue;
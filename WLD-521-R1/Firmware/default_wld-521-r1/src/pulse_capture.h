@@ -0,0 +1,80 @@
+// ================================================
+// File: pulse_capture.h
+// WLD-521 pulse capture: per-input glitch filter and the ISR -> loop ring
+// No Arduino dependency; tests/wld_pulse_test.cpp replays edge streams through
+// it on a host, with the consumer stalled the way a long loop() pass stalls it.
+// ================================================
+#pragma once
+#include <stdint.h>
+
+// Glitch filter: an active edge is accepted only if the input was inactive for
+// at least glitchUs before it (rejects contact bounce on both edges).
+struct PulseIn {
+  uint32_t idleSinceUs;   // start of the current inactive period
+  uint32_t count;         // accepted edges (authoritative, survives ring overflow)
+  uint32_t rejects;       // counter-mode edges rejected by the glitch filter
+  uint32_t drops;         // timestamps lost because the ring was full
+  bool     active;
+};
+
+struct PulseEvt { uint32_t tUs; uint8_t di; };
+constexpr uint16_t PULSE_RING_SIZE = 256;     // power of two
+// Single producer (GPIO ISR) / single consumer (loop)
+struct PulseRing {
+  PulseEvt          ev[PULSE_RING_SIZE];
+  volatile uint16_t head;                     // written by the producer only
+  volatile uint16_t tail;                     // written by the consumer only
+};
+
+// One edge at t with the post-inversion level. Inputs that are not counting
+// still track their level so the filter is primed when they switch to counter
+// mode, but never count or reject. Returns true for an accepted pulse.
+static inline bool pulseEdge(volatile PulseIn &p, bool active, uint32_t t, uint32_t glitchUs, bool counting){
+  if (!active){
+    if (p.active) p.idleSinceUs = t;
+    p.active = false;
+    return false;
+  }
+  if (p.active) return false;                 // level unchanged (coalesced edges)
+  p.active = true;
+  if (!counting) return false;
+  if ((uint32_t)(t - p.idleSinceUs) < glitchUs){ p.rejects++; return false; }
+  p.count++;
+  return true;
+}
+
+// Producer: queue the timestamp of an accepted pulse; on a full ring the count
+// is kept and only the timestamp is lost.
+static inline void pulsePush(PulseRing &r, volatile PulseIn &p, uint8_t di, uint32_t t){
+  const uint16_t h = r.head;
+  const uint16_t n = (uint16_t)((h + 1) & (PULSE_RING_SIZE - 1));
+  if (n == r.tail){ p.drops++; return; }
+  r.ev[h].tUs = t; r.ev[h].di = di;
+  __sync_synchronize();                       // entry visible before the head moves
+  r.head = n;
+}
+
+// Consumer: delivers queued timestamps in order through onPulse(di, tUs), then
+// onGap(di) for each input that lost timestamps since the last call, so a
+// period estimator restarts instead of reading the hole as one long period.
+// Drops are read after the tail is released: the ring is full from the moment
+// of a drop until then, so every timestamp delivered here precedes it.
+template <class OnPulse, class OnGap>
+static inline void pulseDrain(PulseRing &r, volatile PulseIn *in, uint32_t *dropsSeen, uint8_t n,
+                              OnPulse onPulse, OnGap onGap){
+  uint16_t t = r.tail;
+  const uint16_t h = r.head;
+  __sync_synchronize();                       // entries up to head are complete
+  while (t != h){
+    const PulseEvt e = r.ev[t];
+    t = (uint16_t)((t + 1) & (PULSE_RING_SIZE - 1));
+    if (e.di < n) onPulse(e.di, e.tUs);
+  }
+  __sync_synchronize();
+  r.tail = t;
+  __sync_synchronize();
+  for (uint8_t i = 0; i < n; i++){
+    const uint32_t d = in[i].drops;
+    if (d != dropsSeen[i]){ dropsSeen[i] = d; onGap(i); }
+  }
+}
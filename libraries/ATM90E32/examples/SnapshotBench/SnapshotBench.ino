@@ -0,0 +1,126 @@
+// ================================================
+// File: SnapshotBench.ino
+// ATM90E32 snapshot read: before/after timing on an ENM-223-R1
+// (SPI1: SCK 10, MOSI 11, MISO 12, CS 13, PM0 3, PM1 2)
+// ================================================
+// "Before" is the pre-burst driver's register access, reproduced in
+// legacyRead16(): one SPI transaction per register, 10 us after CS, 4 us
+// between address and data, 10 us after CS release, bytewise transfers,
+// 200 kHz SCK. It is timed for the register set the old atmLive read
+// (27 registers) and for the full kSnapRegs list (73). "After" is
+// ATM90E32::readSnapshot() (73 registers in one transaction, 1 us CS guards,
+// 4 us address->data) at the firmware's 200 kHz, and at an opt-in 1 MHz that
+// only the PLconst read-back validates.
+//
+// Expected from the bus timing (estimates; replace with the printed numbers):
+//   legacy, 27 regs @ 200 kHz   ~5.1 ms   (~190 us/reg: 160 us clocking + 24 us waits)
+//   legacy, 73 regs @ 200 kHz  ~13.9 ms
+//   burst,  73 regs @ 200 kHz  ~12.3 ms   (~169 us/reg)
+//   burst,  73 regs @ 1 MHz     ~3.0 ms   (~41 us/reg)
+// The ENM firmware reports the live figure as atmLive.snap_us / spi_hz.
+#include <Arduino.h>
+#include <SPI.h>
+#include <ATM90E32.h>
+
+static const uint8_t ATM_SCK = 10, ATM_MOSI = 11, ATM_MISO = 12, ATM_CS = 13, ATM_PM1 = 2, ATM_PM0 = 3;
+static const uint32_t kLegacyHz = 200000;
+static const int      kRuns     = 50;
+
+static const M90PhaseCal kCal[3] = { { 0x8000, 0x8000, 0, 0 }, { 0x8000, 0x8000, 0, 0 }, { 0x8000, 0x8000, 0, 0 } };
+
+// Registers the old atmLive read one by one: U/I rms H+LSB, PF, angles, freq, temp, diag
+static const uint16_t kLegacyLive[] = {
+  atm90::reg::UrmsA, atm90::reg::UrmsALSB, atm90::reg::UrmsB, atm90::reg::UrmsBLSB, atm90::reg::UrmsC, atm90::reg::UrmsCLSB,
+  atm90::reg::IrmsA, atm90::reg::IrmsALSB, atm90::reg::IrmsB, atm90::reg::IrmsBLSB, atm90::reg::IrmsC, atm90::reg::IrmsCLSB,
+  atm90::reg::PFmeanA, atm90::reg::PFmeanB, atm90::reg::PFmeanC, atm90::reg::PFmeanT,
+  atm90::reg::PAngleA, atm90::reg::PAngleB, atm90::reg::PAngleC, atm90::reg::Freq, atm90::reg::Temp,
+  atm90::reg::EMMState0, atm90::reg::EMMState1, atm90::reg::EMMIntState0, atm90::reg::EMMIntState1,
+  atm90::reg::CRCErrStatus, atm90::reg::LastSPIData
+};
+static const uint8_t kLegacyLiveN = sizeof(kLegacyLive) / sizeof(kLegacyLive[0]);
+
+static ATM90E32 atm(SPI1, ATM_CS, ATM_PM0, ATM_PM1, 1000000);
+
+// Pre-burst access path (per-register transaction, fixed waits)
+static uint16_t legacyRead16(uint16_t reg) {
+  const uint16_t addr = reg | 0x8000;
+  SPI1.beginTransaction(SPISettings(kLegacyHz, MSBFIRST, SPI_MODE0));
+  digitalWrite(ATM_CS, LOW);
+  delayMicroseconds(10);
+  SPI1.transfer((uint8_t)(addr >> 8));
+  SPI1.transfer((uint8_t)(addr & 0xFF));
+  delayMicroseconds(4);
+  const uint8_t b0 = SPI1.transfer(0x00);
+  const uint8_t b1 = SPI1.transfer(0x00);
+  digitalWrite(ATM_CS, HIGH);
+  delayMicroseconds(10);
+  SPI1.endTransaction();
+  return (uint16_t)((b0 << 8) | b1);
+}
+
+struct Stat { uint32_t minUs, maxUs, sumUs; };
+
+static void statAdd(Stat &s, uint32_t us) {
+  if (us < s.minUs) s.minUs = us;
+  if (us > s.maxUs) s.maxUs = us;
+  s.sumUs += us;
+}
+
+static void statPrint(const char *name, uint8_t regs, const Stat &s) {
+  Serial.printf("%-28s %2u regs  min %6lu us  avg %6lu us  max %6lu us  (%lu us/reg)\n", name, regs,
+                (unsigned long)s.minUs, (unsigned long)(s.sumUs / kRuns), (unsigned long)s.maxUs,
+                (unsigned long)(s.sumUs / kRuns / regs));
+}
+
+static Stat benchLegacy(const uint16_t *regs, uint8_t n) {
+  Stat s = { 0xFFFFFFFFu, 0, 0 };
+  uint16_t v[atm90::reg::kSnapN];
+  for (int k = 0; k < kRuns; k++) {
+    const uint32_t t0 = micros();
+    for (uint8_t i = 0; i < n; i++) v[i] = legacyRead16(regs[i]);
+    statAdd(s, micros() - t0);
+  }
+  (void)v;
+  return s;
+}
+
+static Stat benchSnapshot(ATM90E32 &dev) {
+  Stat s = { 0xFFFFFFFFu, 0, 0 };
+  MeterSnapshot m;
+  for (int k = 0; k < kRuns; k++) {
+    dev.readSnapshot(m);
+    statAdd(s, m.read_us);
+  }
+  return s;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial && millis() < 3000) {}
+
+  SPI1.setSCK(ATM_SCK);
+  SPI1.setTX(ATM_MOSI);
+  SPI1.setRX(ATM_MISO);
+  SPI1.begin();
+
+  // 200 kHz first: begin() at the safe clock, then the burst at the same SCK as the legacy path
+  ATM90E32 slow(SPI1, ATM_CS, ATM_PM0, ATM_PM1, kLegacyHz);
+  slow.begin(50, 1, 25256, kCal);
+  Serial.printf("PLconst 0x%08lX (expect 0x0861C468)\n", (unsigned long)slow.readPLconst());
+
+  const Stat legLive = benchLegacy(kLegacyLive, kLegacyLiveN);
+  const Stat legFull = benchLegacy(atm90::reg::kSnapRegs, atm90::reg::kSnapN);
+  const Stat burstSlow = benchSnapshot(slow);
+
+  atm.begin(50, 1, 25256, kCal);
+  const Stat burstFast = benchSnapshot(atm);
+
+  Serial.println();
+  statPrint("legacy (old atmLive set)", kLegacyLiveN, legLive);
+  statPrint("legacy (snapshot set)", atm90::reg::kSnapN, legFull);
+  statPrint("burst readSnapshot 200k", atm90::reg::kSnapN, burstSlow);
+  Serial.printf("burst readSnapshot @ %lu Hz%s\n", (unsigned long)atm.spiHz(), atm.spiFallback() ? " (fallback)" : "");
+  statPrint("burst readSnapshot", atm90::reg::kSnapN, burstFast);
+}
+
+void loop() {}
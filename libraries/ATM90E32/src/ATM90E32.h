@@ -0,0 +1,61 @@
+// ================================================
+// File: ATM90E32.h
+// ATM90E32 driver for RP2350/RP2040 (Arduino core, SPI, no external libs)
+// Shared by ENM-223-R1 and RGB-621-R1; register map in ATM90E32Regs.h,
+// conversion math and bus-templated driver in ATM90E32Core.h
+// ================================================
+#pragma once
+#include <Arduino.h>
+#include <SPI.h>
+#include "ATM90E32Core.h"
+
+// Frame = 16-bit address (bit15 = read) + 16-bit data, MSB first, CS-framed.
+// Waits: kAddrDataUs between the address and data halves is the 4 us the
+// pre-burst driver (and the vendor reference code it followed) used; it is
+// kept as is. kCsGuardUs after CS assert and after CS release is shortened
+// from that driver's 10 us. The ATM90E32AS SPI timing table is not reproduced
+// in this tree, so none of these are datasheet t-values. That is why the
+// default SCK stays at kSafeSpiHz (200 kHz, the rate these boards have always
+// run); a faster clock is opt-in and only checked by the PLconst read-back
+// in begin(). PM0/PM1 are MCU outputs into the ATM (normal mode = both high).
+struct ArduinoSpiBus {
+  static constexpr uint8_t kCsGuardUs  = 1;
+  static constexpr uint8_t kAddrDataUs = 4;
+
+  SPIClass &spi;
+  uint8_t   cs, pm0, pm1;
+  uint8_t   mode;
+  bool      csActiveHigh;
+
+  void begin() {
+    pinMode(pm0, OUTPUT);
+    pinMode(pm1, OUTPUT);
+    digitalWrite(pm0, HIGH);
+    digitalWrite(pm1, HIGH);
+    delay(5);
+    pinMode(cs, OUTPUT);
+    digitalWrite(cs, csActiveHigh ? LOW : HIGH);
+  }
+  void beginTransaction(uint32_t hz) { spi.beginTransaction(SPISettings(hz, MSBFIRST, mode)); }
+  void endTransaction()              { spi.endTransaction(); }
+  uint16_t frame(uint16_t addr, uint16_t val) {
+    digitalWrite(cs, csActiveHigh ? HIGH : LOW);
+    delayMicroseconds(kCsGuardUs);
+    spi.transfer16(addr);
+    delayMicroseconds(kAddrDataUs);
+    const uint16_t out = spi.transfer16(val);
+    digitalWrite(cs, csActiveHigh ? LOW : HIGH);
+    delayMicroseconds(kCsGuardUs);
+    return out;
+  }
+  void     delayMs(uint32_t ms) { delay(ms); }
+  uint32_t nowUs()              { return micros(); }
+};
+
+class ATM90E32 : public ATM90E32T<ArduinoSpiBus> {
+public:
+  ATM90E32(SPIClass &spi, uint8_t pinCS, uint8_t pinPM0, uint8_t pinPM1,
+           uint32_t spiHz = kSafeSpiHz, uint8_t spiMode = SPI_MODE0,
+           bool csActiveHigh = false)
+  : ATM90E32T<ArduinoSpiBus>(ArduinoSpiBus{ spi, pinCS, pinPM0, pinPM1, spiMode, csActiveHigh }, spiHz) {}
+};
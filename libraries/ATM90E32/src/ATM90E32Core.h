@@ -0,0 +1,303 @@
+// ================================================
+// File: ATM90E32Core.h
+// ATM90E32 driver core: types, conversion math, bus-templated driver
+// No Arduino dependency; the bus is a template parameter so the same
+// code runs against SPI on the module or a mock register file on a host.
+// ================================================
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include "ATM90E32Regs.h"
+
+struct M90PhaseCal {
+  uint16_t Ugain;
+  uint16_t Igain;
+  int16_t  Uoffset;
+  int16_t  Ioffset;
+};
+
+struct M90DiagRegs {
+  uint16_t EMMState0;
+  uint16_t EMMState1;
+  uint16_t EMMIntState0;
+  uint16_t EMMIntState1;
+  uint16_t CRCErrStatus;
+  uint16_t LastSPIData;
+};
+
+// One coherent read of everything atmLive needs (single SPI burst)
+struct MeterSnapshot {
+  float    Urms_V[3];     // A,B,C (H + LSB register)
+  float    Irms_A[3];
+  float    P_W[4];        // A,B,C,T (H + LSB register, signed)
+  float    Q_var[4];
+  float    S_VA[4];
+  float    Pfund_W[4];    // fundamental active power
+  float    Pharm_W[4];    // harmonic active power
+  uint16_t THDN_U[3];     // THD+N voltage A,B,C (0.01 %)
+  uint16_t THDN_I[3];     // THD+N current A,B,C (0.01 %)
+  int16_t  PFmean[4];     // A,B,C,T raw (x0.001)
+  int16_t  PAngle[3];     // A,B,C raw (x0.1 deg)
+  uint16_t Freq_x100;
+  int16_t  TempC;
+  M90DiagRegs diag;
+  uint32_t t_us;          // bus clock at end of burst
+  uint16_t read_us;       // duration of the burst
+};
+
+// ====== Conversion math (pure, host-testable) ======
+namespace atm90 {
+
+constexpr float kUrmsLsb     = 0.01f;    // V per H LSB
+constexpr float kIrmsLsb     = 0.001f;   // A per H LSB
+
+// Mean power (ATM90E32AS datasheet, "Regular Energy and Power Registers":
+// PmeanA..C/QmeanA..C/SmeanA..C 0xB1..0xBB with their *LSB low words 0xC1..0xCB,
+// fundamental/harmonic 0xD1..0xD7 / 0xE1..0xE7). H:LSB read as one signed
+// 32-bit value is 0.00032 W (var, VA) per count at the reference calibration,
+// i.e. 65536 * 0.00032 = 20.97152 W per H LSB. That matches the CircuitSetup
+// and ESPHome ATM90E32 drivers (val32 * 0.00032). The all-phase T registers
+// hold the phase sum / 4, so their count is 4x the phase count.
+constexpr float kPow32Lsb    = 0.00032f;                 // W per count of (H << 16 | LSB)
+constexpr float kPowPhaseLsb = 65536.0f * kPow32Lsb;     // W/var/VA per H LSB
+constexpr float kPowTotalLsb = 4.0f * kPowPhaseLsb;
+
+// H word + upper byte of the LSB register as one value in units of the H LSB
+inline float u24(uint16_t h, uint16_t l) { return (float)h + (float)((l >> 8) & 0xFF) * (1.0f / 256.0f); }
+inline float s24(uint16_t h, uint16_t l) {
+  return (float)(int32_t)(((uint32_t)h << 16) | (l & 0xFF00u)) * (1.0f / 65536.0f);
+}
+
+// Meter constant from PLconst: MC [imp/kWh] = 450e9 / PLconst (0 if out of range)
+constexpr uint32_t mcFromPLconst(uint32_t pl) {
+  return (pl == 0) ? 0
+       : ((450000000000ULL / pl) < 1 || (450000000000ULL / pl) > 10000000ULL) ? 0
+       : (uint32_t)(450000000000ULL / pl);
+}
+static_assert(mcFromPLconst(((uint32_t)reg::kPLconstH << 16) | reg::kPLconstL) == 3200,
+              "default PLconst must give MC 3200 imp/kWh");
+
+// Energy registers count 0.01 CF; 1 CF = 1000/MC Wh
+inline double ticksToWh(uint64_t ticks, uint32_t mc) {
+  return (mc == 0) ? 0.0 : (double)ticks * (10.0 / (double)mc);
+}
+
+// Decode a kSnapRegs dump (r[] in kSnapRegs order) into a snapshot
+inline void decodeSnapshot(const uint16_t r[reg::kSnapN], MeterSnapshot &s) {
+  using namespace reg;
+  for (int p = 0; p < 3; p++) {
+    s.Urms_V[p] = u24(r[SN_URMS + 2*p], r[SN_URMS + 2*p + 1]) * kUrmsLsb;
+    s.Irms_A[p] = u24(r[SN_IRMS + 2*p], r[SN_IRMS + 2*p + 1]) * kIrmsLsb;
+  }
+  for (int i = 0; i < 4; i++) {
+    const float k = (i == 3) ? kPowTotalLsb : kPowPhaseLsb;
+    s.P_W[i]     = s24(r[SN_P    + 2*i], r[SN_P    + 2*i + 1]) * k;
+    s.Q_var[i]   = s24(r[SN_Q    + 2*i], r[SN_Q    + 2*i + 1]) * k;
+    s.S_VA[i]    = s24(r[SN_S    + 2*i], r[SN_S    + 2*i + 1]) * k;
+    s.Pfund_W[i] = s24(r[SN_PF_W + 2*i], r[SN_PF_W + 2*i + 1]) * k;
+    s.Pharm_W[i] = s24(r[SN_PH_W + 2*i], r[SN_PH_W + 2*i + 1]) * k;
+  }
+  for (int p = 0; p < 3; p++) {
+    s.THDN_U[p] = r[SN_THDU + p];
+    s.THDN_I[p] = r[SN_THDI + p];
+  }
+  for (int i = 0; i < 4; i++) s.PFmean[i] = (int16_t)r[SN_PF + i];
+  for (int i = 0; i < 3; i++) s.PAngle[i] = (int16_t)r[SN_ANG + i];
+  s.Freq_x100 = r[SN_FREQ];
+  s.TempC     = (int16_t)r[SN_TEMP];
+  s.diag.EMMState0    = r[SN_DIAG + 0];
+  s.diag.EMMState1    = r[SN_DIAG + 1];
+  s.diag.EMMIntState0 = r[SN_DIAG + 2];
+  s.diag.EMMIntState1 = r[SN_DIAG + 3];
+  s.diag.CRCErrStatus = r[SN_DIAG + 4];
+  s.diag.LastSPIData  = r[SN_DIAG + 5];
+}
+
+// MMode0 for line frequency / energy summing mode
+constexpr uint16_t mmode0(uint16_t lineHz, uint8_t sumAbs) {
+  return (uint16_t)(((0x019Du & ~(1u << 12)) | (lineHz == 60 ? (1u << 12) : 0u)) & ~(0b11u << 3) & ~0b111u)
+       | (uint16_t)((sumAbs ? 0b11u : 0b00u) << 3) | 0b101u;
+}
+
+// SagTh for the line's sag voltage at the given Ucal
+inline uint16_t sagThreshold(uint16_t lineHz, uint16_t ucal) {
+  const double sagV = (lineHz == 60) ? 90.0 : 190.0;
+  return (uint16_t)((sagV * 100.0 * sqrt(2.0)) / (2.0 * (ucal / 32768.0)));
+}
+
+} // namespace atm90
+
+// ====== Driver ======
+// Bus requirements (see ArduinoSpiBus in ATM90E32.h):
+//   void     begin();                            // CS idle, PM pins driven
+//   void     beginTransaction(uint32_t hz);
+//   uint16_t frame(uint16_t addr, uint16_t val); // one CS-framed 32-bit frame
+//   void     endTransaction();
+//   void     delayMs(uint32_t ms);
+//   uint32_t nowUs();
+template <class Bus>
+class ATM90E32T {
+public:
+  static constexpr uint8_t  kEnergyRegs = atm90::reg::kEnergyRegs;
+  static constexpr uint32_t kSafeSpiHz  = 200000;
+
+  explicit ATM90E32T(const Bus &bus, uint32_t spiHz = kSafeSpiHz) : bus_(bus), spiHz_(spiHz) {}
+
+  void begin(uint16_t lineHz, uint8_t sumAbs, uint16_t ucal, const M90PhaseCal cal[3]) {
+    using namespace atm90::reg;
+    lineHz_ = (lineHz == 60) ? 60 : 50;
+    sumAbs_ = sumAbs ? 1 : 0;
+    ucal_   = ucal;
+
+    bus_.begin();
+    bus_.delayMs(5);
+
+    write16(SoftReset, kSoftResetKey);
+    bus_.delayMs(5);
+
+    write16(CfgRegAccEn, kCfgUnlock);
+    write16(MeterEn, 0x0001);
+
+    write16(SagPeakDetCfg, 0x143F);
+    write16(SagTh,    atm90::sagThreshold(lineHz_, ucal_));
+    write16(FreqHiTh, lineHz_ == 60 ? 6100 : 5100);
+    write16(FreqLoTh, lineHz_ == 60 ? 5900 : 4900);
+
+    write16(EMMIntEn0, 0xB76F);
+    write16(EMMIntEn1, 0xDDFD);
+    write16(EMMIntState0, 0x0001);
+    write16(EMMIntState1, 0x0001);
+
+    write16(ZXConfig, 0xD654);
+
+    write16(PLconstH, kPLconstH);
+    write16(PLconstL, kPLconstL);
+
+    write16(MMode0, atm90::mmode0(lineHz_, sumAbs_));
+    write16(MMode1, 0x0000);                  // PGA x1 on IA/IB/IC
+
+    write16(PStartTh, 0x1D4C);
+    write16(QStartTh, 0x1D4C);
+    write16(SStartTh, 0x1D4C);
+    write16(PPhaseTh, 0x02EE);
+    write16(QPhaseTh, 0x02EE);
+    write16(SPhaseTh, 0x02EE);
+
+    applyCalibration(cal);
+
+    write16(CfgRegAccEn, kCfgLock);
+
+    // Validate the chosen SCK: PLconst must read back what we just wrote.
+    // On mismatch drop to the conservative clock and redo the setup once.
+    if (spiHz_ > kSafeSpiHz && readPLconst() != (((uint32_t)kPLconstH << 16) | kPLconstL)) {
+      spiHz_ = kSafeSpiHz;
+      spiFallback_ = true;
+      begin(lineHz, sumAbs, ucal, cal);
+    }
+  }
+
+  void applyCalibration(const M90PhaseCal cal[3]) {
+    using namespace atm90::reg;
+    bus_.beginTransaction(spiHz_);
+    bus_.frame(CfgRegAccEn, kCfgUnlock);
+    for (int p = 0; p < 3; p++) {
+      const uint16_t b = kCalBase[p];
+      bus_.frame(b + 0, cal[p].Ugain);
+      bus_.frame(b + 1, cal[p].Igain);
+      bus_.frame(b + 2, (uint16_t)cal[p].Uoffset);
+      bus_.frame(b + 3, (uint16_t)cal[p].Ioffset);
+    }
+    bus_.frame(CfgRegAccEn, kCfgLock);
+    bus_.endTransaction();
+  }
+
+  uint16_t readReg(uint16_t r)              { return read16(r); }
+  void     writeReg(uint16_t r, uint16_t v) { write16(r, v); }
+
+  M90DiagRegs readDiag() {
+    using namespace atm90::reg;
+    static constexpr uint16_t regs[6] = { EMMState0, EMMState1, EMMIntState0, EMMIntState1, CRCErrStatus, LastSPIData };
+    uint16_t v[6];
+    readRegs(regs, v, 6);
+    return M90DiagRegs{ v[0], v[1], v[2], v[3], v[4], v[5] };
+  }
+
+  // All 20 energy registers in one burst (clear-on-read, 0.01 CF per LSB).
+  // Layout: AP,AN,RP,RN,SA groups of 4 in chip order T,A,B,C.
+  void readEnergyRegs(uint16_t out[kEnergyRegs]) { readBlock(atm90::reg::APenergyT, out, kEnergyRegs); }
+
+  uint32_t readPLconst() {
+    static constexpr uint16_t regs[2] = { atm90::reg::PLconstH, atm90::reg::PLconstL };
+    uint16_t v[2];
+    readRegs(regs, v, 2);
+    return ((uint32_t)v[0] << 16) | v[1];
+  }
+
+  // EMMState0, EMMState1, EMMIntState0, EMMIntState1 (0x71..0x74) in one burst
+  void readEmmStates(uint16_t out[4]) { readBlock(atm90::reg::EMMState0, out, 4); }
+
+  // Clear latched interrupt flags (write-1-to-clear); releases IRQ0/IRQ1
+  void clearIntState(uint16_t s0, uint16_t s1) {
+    using namespace atm90::reg;
+    bus_.beginTransaction(spiHz_);
+    bus_.frame(CfgRegAccEn, kCfgUnlock);
+    if (s0) bus_.frame(EMMIntState0, s0);
+    if (s1) bus_.frame(EMMIntState1, s1);
+    bus_.frame(CfgRegAccEn, kCfgLock);
+    bus_.endTransaction();
+  }
+
+  // Bulk reads: one bus transaction, CS toggled per 32-bit frame (the chip has
+  // no address auto-increment). regs[]/out[] may be any register list.
+  void readRegs(const uint16_t *regs, uint16_t *out, uint8_t n) {
+    bus_.beginTransaction(spiHz_);
+    for (uint8_t i = 0; i < n; i++) out[i] = bus_.frame(regs[i] | 0x8000, 0x0000);
+    bus_.endTransaction();
+  }
+  void readBlock(uint16_t startReg, uint16_t *out, uint8_t n) {
+    bus_.beginTransaction(spiHz_);
+    for (uint8_t i = 0; i < n; i++) out[i] = bus_.frame((uint16_t)(startReg + i) | 0x8000, 0x0000);
+    bus_.endTransaction();
+  }
+
+  void readSnapshot(MeterSnapshot &s) {
+    uint16_t r[atm90::reg::kSnapN];
+    const uint32_t t0 = bus_.nowUs();
+    readRegs(atm90::reg::kSnapRegs, r, atm90::reg::kSnapN);
+    const uint32_t t1 = bus_.nowUs();
+    atm90::decodeSnapshot(r, s);
+    s.t_us    = t1;
+    s.read_us = (uint16_t)((t1 - t0) > 65535u ? 65535u : (t1 - t0));
+  }
+
+  // SCK actually in use (falls back to kSafeSpiHz if read-back at spiHz fails)
+  uint32_t spiHz()       const { return spiHz_; }
+  bool     spiFallback() const { return spiFallback_; }
+
+  // Config currently applied
+  uint16_t lineHz() const { return lineHz_; }
+  uint8_t  sumAbs() const { return sumAbs_; }
+  uint16_t ucal()   const { return ucal_; }
+
+  Bus &bus() { return bus_; }
+
+private:
+  uint16_t read16(uint16_t r) {
+    bus_.beginTransaction(spiHz_);
+    const uint16_t v = bus_.frame(r | 0x8000, 0x0000);
+    bus_.endTransaction();
+    return v;
+  }
+  void write16(uint16_t r, uint16_t v) {
+    bus_.beginTransaction(spiHz_);
+    bus_.frame(r, v);
+    bus_.endTransaction();
+  }
+
+  Bus      bus_;
+  uint32_t spiHz_;
+  bool     spiFallback_ = false;
+  uint16_t lineHz_ = 50;
+  uint8_t  sumAbs_ = 1;
+  uint16_t ucal_   = 25256;
+};
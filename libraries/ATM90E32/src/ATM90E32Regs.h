@@ -0,0 +1,118 @@
+// ================================================
+// File: ATM90E32Regs.h
+// ATM90E32 register map (compile-time tables)
+// Pure constexpr data, no Arduino dependency
+// ================================================
+#pragma once
+#include <stdint.h>
+
+namespace atm90 {
+namespace reg {
+
+// ---- Status / configuration ----
+constexpr uint16_t MeterEn       = 0x00;
+constexpr uint16_t SagPeakDetCfg = 0x05;
+constexpr uint16_t ZXConfig      = 0x07;
+constexpr uint16_t SagTh         = 0x08;
+constexpr uint16_t FreqLoTh      = 0x0C;
+constexpr uint16_t FreqHiTh      = 0x0D;
+constexpr uint16_t PLconstH      = 0x31;
+constexpr uint16_t PLconstL      = 0x32;
+constexpr uint16_t MMode0        = 0x33;
+constexpr uint16_t MMode1        = 0x34;
+constexpr uint16_t PStartTh      = 0x35;
+constexpr uint16_t QStartTh      = 0x36;
+constexpr uint16_t SStartTh      = 0x37;
+constexpr uint16_t PPhaseTh      = 0x38;
+constexpr uint16_t QPhaseTh      = 0x39;
+constexpr uint16_t SPhaseTh      = 0x3A;
+constexpr uint16_t SoftReset     = 0x70;
+constexpr uint16_t EMMState0     = 0x71;
+constexpr uint16_t EMMState1     = 0x72;
+constexpr uint16_t EMMIntState0  = 0x73;
+constexpr uint16_t EMMIntState1  = 0x74;
+constexpr uint16_t EMMIntEn0     = 0x75;
+constexpr uint16_t EMMIntEn1     = 0x76;
+constexpr uint16_t LastSPIData   = 0x78;
+constexpr uint16_t CRCErrStatus  = 0x79;
+constexpr uint16_t CfgRegAccEn   = 0x7F;
+
+// ---- Calibration (per phase: Ugain, Igain, Uoffset, Ioffset) ----
+constexpr uint16_t UgainA = 0x61, IgainA = 0x62, UoffsetA = 0x63, IoffsetA = 0x64;
+constexpr uint16_t UgainB = 0x65, IgainB = 0x66, UoffsetB = 0x67, IoffsetB = 0x68;
+constexpr uint16_t UgainC = 0x69, IgainC = 0x6A, UoffsetC = 0x6B, IoffsetC = 0x6C;
+constexpr uint16_t kCalBase[3] = { UgainA, UgainB, UgainC };   // +0 Ug, +1 Ig, +2 Uo, +3 Io
+
+// ---- Energy (clear-on-read, 0.01 CF per LSB; chip order T,A,B,C) ----
+constexpr uint16_t APenergyT = 0x80, APenergyA = 0x81, APenergyB = 0x82, APenergyC = 0x83;
+constexpr uint16_t ANenergyT = 0x84, ANenergyA = 0x85, ANenergyB = 0x86, ANenergyC = 0x87;
+constexpr uint16_t RPenergyT = 0x88, RPenergyA = 0x89, RPenergyB = 0x8A, RPenergyC = 0x8B;
+constexpr uint16_t RNenergyT = 0x8C, RNenergyA = 0x8D, RNenergyB = 0x8E, RNenergyC = 0x8F;
+constexpr uint16_t SAenergyT = 0x90, SAenergyA = 0x91, SAenergyB = 0x92, SAenergyC = 0x93;
+constexpr uint8_t  kEnergyRegs = 20;
+
+// ---- Mean power (H word; LSB registers carry 8 more bits in [15:8]) ----
+constexpr uint16_t PmeanT = 0xB0, PmeanA = 0xB1, PmeanB = 0xB2, PmeanC = 0xB3;
+constexpr uint16_t QmeanT = 0xB4, QmeanA = 0xB5, QmeanB = 0xB6, QmeanC = 0xB7;
+constexpr uint16_t SmeanT = 0xB8, SmeanA = 0xB9, SmeanB = 0xBA, SmeanC = 0xBB;
+constexpr uint16_t PmeanTLSB  = 0xC0, PmeanALSB = 0xC1, PmeanBLSB = 0xC2, PmeanCLSB = 0xC3;
+constexpr uint16_t QmeanTLSB  = 0xC4, QmeanALSB = 0xC5, QmeanBLSB = 0xC6, QmeanCLSB = 0xC7;
+constexpr uint16_t SAmeanTLSB = 0xC8, SmeanALSB = 0xC9, SmeanBLSB = 0xCA, SmeanCLSB = 0xCB;
+
+// ---- Fundamental / harmonic active power ----
+constexpr uint16_t PmeanTF = 0xD0, PmeanAF = 0xD1, PmeanBF = 0xD2, PmeanCF = 0xD3;
+constexpr uint16_t PmeanTH = 0xD4, PmeanAH = 0xD5, PmeanBH = 0xD6, PmeanCH = 0xD7;
+constexpr uint16_t PmeanTFLSB = 0xE0, PmeanAFLSB = 0xE1, PmeanBFLSB = 0xE2, PmeanCFLSB = 0xE3;
+constexpr uint16_t PmeanTHLSB = 0xE4, PmeanAHLSB = 0xE5, PmeanBHLSB = 0xE6, PmeanCHLSB = 0xE7;
+
+// ---- THD+N (0.01 %) ----
+constexpr uint16_t THDNUA = 0xF1, THDNUB = 0xF2, THDNUC = 0xF3;
+constexpr uint16_t THDNIA = 0xF5, THDNIB = 0xF6, THDNIC = 0xF7;
+
+// ---- PF / angle / frequency / temperature ----
+constexpr uint16_t PFmeanT = 0xBC, PFmeanA = 0xBD, PFmeanB = 0xBE, PFmeanC = 0xBF;
+constexpr uint16_t PAngleA = 0xF9, PAngleB = 0xFA, PAngleC = 0xFB;
+constexpr uint16_t Freq    = 0xF8;
+constexpr uint16_t Temp    = 0xFC;
+
+// ---- RMS ----
+constexpr uint16_t UrmsA    = 0xD9, UrmsB    = 0xDA, UrmsC    = 0xDB;
+constexpr uint16_t IrmsA    = 0xDD, IrmsB    = 0xDE, IrmsC    = 0xDF;
+constexpr uint16_t UrmsALSB = 0xE9, UrmsBLSB = 0xEA, UrmsCLSB = 0xEB;
+constexpr uint16_t IrmsALSB = 0xED, IrmsBLSB = 0xEE, IrmsCLSB = 0xEF;
+
+// ---- Snapshot read list ----
+// H/LSB pairs adjacent so each 24-bit value is read a few us apart.
+// Power arrays are decoded as A,B,C,T; the chip orders them T,A,B,C.
+constexpr uint16_t kSnapRegs[] = {
+  UrmsA, UrmsALSB, UrmsB, UrmsBLSB, UrmsC, UrmsCLSB,                                  //  0
+  IrmsA, IrmsALSB, IrmsB, IrmsBLSB, IrmsC, IrmsCLSB,                                  //  6
+  PmeanA, PmeanALSB, PmeanB, PmeanBLSB, PmeanC, PmeanCLSB, PmeanT, PmeanTLSB,         // 12
+  QmeanA, QmeanALSB, QmeanB, QmeanBLSB, QmeanC, QmeanCLSB, QmeanT, QmeanTLSB,         // 20
+  SmeanA, SmeanALSB, SmeanB, SmeanBLSB, SmeanC, SmeanCLSB, SmeanT, SAmeanTLSB,        // 28
+  PmeanAF, PmeanAFLSB, PmeanBF, PmeanBFLSB, PmeanCF, PmeanCFLSB, PmeanTF, PmeanTFLSB, // 36
+  PmeanAH, PmeanAHLSB, PmeanBH, PmeanBHLSB, PmeanCH, PmeanCHLSB, PmeanTH, PmeanTHLSB, // 44
+  THDNUA, THDNUB, THDNUC, THDNIA, THDNIB, THDNIC,                                     // 52
+  PFmeanA, PFmeanB, PFmeanC, PFmeanT,                                                 // 58
+  PAngleA, PAngleB, PAngleC,                                                          // 62
+  Freq, Temp,                                                                         // 65
+  EMMState0, EMMState1, EMMIntState0, EMMIntState1, CRCErrStatus, LastSPIData         // 67
+};
+constexpr uint8_t kSnapN = sizeof(kSnapRegs) / sizeof(kSnapRegs[0]);
+static_assert(kSnapN == 73, "snapshot register list out of sync with decoder");
+
+// Offsets into a kSnapRegs dump (used by the decoder)
+enum : uint8_t {
+  SN_URMS = 0, SN_IRMS = 6, SN_P = 12, SN_Q = 20, SN_S = 28, SN_PF_W = 36, SN_PH_W = 44,
+  SN_THDU = 52, SN_THDI = 55, SN_PF = 58, SN_ANG = 62, SN_FREQ = 65, SN_TEMP = 66, SN_DIAG = 67
+};
+
+// ---- Setup values written by begin() ----
+constexpr uint16_t kPLconstH     = 0x0861;     // PLconst = 0x0861C468 (MC 3200 imp/kWh)
+constexpr uint16_t kPLconstL     = 0xC468;
+constexpr uint16_t kCfgUnlock    = 0x55AA;
+constexpr uint16_t kCfgLock      = 0x0000;
+constexpr uint16_t kSoftResetKey = 0x789A;
+
+} // namespace reg
+} // namespace atm90
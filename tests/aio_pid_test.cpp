@@ -0,0 +1,271 @@
+// AIO-422 PID law against a first-order-plus-dead-time plant
+//   tau·dy/dt = K·u(t − θ) − y      (y = PV %, u = output %)
+// run at the default 200 ms cycle. Covers the setpoint step response, setpoint
+// weighting, conditional anti-windup on a saturating step (compared with a
+// plain clamped integrator), feed-forward against a measured load, a two-loop
+// cascade in pidEvalOrder(), the derivative-on-measurement filter and the
+// bumpless start. Every closed-loop run reports settling time and IAE
+// (integral of |SP - PV| dt, in %·s). All deterministic: fixed plants, fixed
+// pseudo-noise.
+#include "host_test.h"
+#include <vector>
+#include <pid_law.h>
+
+static const float kDt = 0.2f;                 // PID_PERIOD_MS_DEFAULT
+
+struct Fopdt {
+  float K, tau, y;
+  std::vector<float> line;                     // dead-time delay line, one slot per cycle
+  size_t head;
+  Fopdt(float k, float t, float theta, float y0) : K(k), tau(t), y(y0), line((size_t)(theta / kDt + 0.5f), 0.0f), head(0) {}
+  float step(float u) {
+    float ud = u;
+    if (!line.empty()) { ud = line[head]; line[head] = u; head = (head + 1) % line.size(); }
+    const int sub = 10;                        // integrate the plant finer than the controller
+    for (int s = 0; s < sub; s++) y += (K * ud - y) * (kDt / sub) / tau;
+    return y;
+  }
+};
+
+static PIDState law(float Kp, float Ki, float Kd, float beta, float dTf, uint8_t mode = 0) {
+  PIDState p = {};
+  p.enabled = true; p.mode = mode;
+  p.Kp = Kp; p.Ki = Ki; p.Kd = Kd; p.beta = beta; p.dTf = dTf;
+  p.pvMin = 0; p.pvMax = 100; p.outMin = 0; p.outMax = 4095;
+  return p;
+}
+
+struct Trace { float overshoot; float settleS; float finalErr; float iae; };
+
+// Settling bookkeeping shared by the runs: time after which |e| stays within 1 %
+static void settleTrack(float &settleS, float err, int k) {
+  if (fabsf(err) > 1.0f) settleS = -1.0f;
+  else if (settleS < 0) settleS = (k + 1) * kDt;
+}
+
+// Closed loop: settle at sp0 for 60 s, then step to sp1 and run 'runS' seconds
+static Trace stepResponse(const PIDState &p, Fopdt plant, float sp0, float sp1, float runS) {
+  PidRt r = {};
+  float pv = plant.y, u = plant.y / plant.K, e;
+  for (int k = 0; k < (int)(60.0f / kDt); k++) { u = pidLawStep(p, r, pv, sp0, 0.0f, u, kDt, e); pv = plant.step(u); }
+  Trace t = { 0.0f, -1.0f, 0.0f, 0.0f };
+  const float dir = (sp1 > sp0) ? 1.0f : -1.0f;
+  for (int k = 0; k < (int)(runS / kDt); k++) {
+    u = pidLawStep(p, r, pv, sp1, 0.0f, u, kDt, e);
+    pv = plant.step(u);
+    const float over = dir * (pv - sp1);
+    if (over > t.overshoot) t.overshoot = over;
+    settleTrack(t.settleS, pv - sp1, k);
+    t.iae += fabsf(sp1 - pv) * kDt;
+  }
+  t.finalErr = fabsf(pv - sp1);
+  return t;
+}
+
+int main() {
+  // Plant: K 1, tau 10 s, dead time 2 s. SIMC PI (tau_c = theta): Kp 2.5, Ti 10 s.
+  const Fopdt plant(1.0f, 10.0f, 2.0f, 20.0f);
+
+  // ---- setpoint step 20 -> 30 % (output stays unsaturated) ----
+  const Trace full = stepResponse(law(2.5f, 0.25f, 0.0f, 1.0f, 0.0f), plant, 20.0f, 30.0f, 120.0f);
+  const Trace wtd  = stepResponse(law(2.5f, 0.25f, 0.0f, 0.5f, 0.0f), plant, 20.0f, 30.0f, 120.0f);
+  printf("aio_pid_test: step 20->30 %%, beta=1:   overshoot %.2f %%, settle %.1f s, IAE %.1f %%s\n",
+         full.overshoot, full.settleS, full.iae);
+  printf("  step 20->30 %%, beta=0.5: overshoot %.2f %%, settle %.1f s, IAE %.1f %%s\n",
+         wtd.overshoot, wtd.settleS, wtd.iae);
+  CHECK(full.finalErr < 0.05f);
+  CHECK(full.settleS > 0 && full.settleS < 40.0f);
+  CHECK(full.overshoot < 2.0f);                   // 20 % of the step
+  CHECK(wtd.finalErr < 0.05f);
+  CHECK(wtd.settleS > 0);
+  CHECK(wtd.overshoot < full.overshoot);          // setpoint weighting trims the overshoot
+
+  // ---- reverse acting (cooling: more output, lower PV) ----
+  {
+    Fopdt cool(-1.0f, 10.0f, 2.0f, 0.0f);      // PV = 100 % + plant output
+    PidRt r = {};
+    const PIDState p = law(2.5f, 0.25f, 0.0f, 1.0f, 0.0f, 1);
+    float pv = 100.0f, u = 0.0f, e;
+    for (int k = 0; k < (int)(150.0f / kDt); k++) { u = pidLawStep(p, r, pv, 70.0f, 0.0f, u, kDt, e); pv = 100.0f + cool.step(u); }
+    CHECK_NEAR(pv, 70.0, 0.05);
+    CHECK_NEAR(u, 30.0, 0.1);
+  }
+
+  // ---- anti-windup: step 10 -> 90 % drives the output into 100 % for many
+  //      cycles; compared with a plain integrator clamped to +-100 ----
+  {
+    const PIDState p = law(2.5f, 0.25f, 0.0f, 1.0f, 0.0f);
+    Fopdt aw(1.0f, 10.0f, 2.0f, 10.0f), naive = aw;
+    PidRt r = {};
+    float pvA = 10, pvN = 10, uA = 10, uN = 10, iN = 10, e;
+    (void)pidLawStep(p, r, pvA, 10.0f, 0.0f, uA, kDt, e);       // settled start, integral = 10
+    float overA = 0, overN = 0, settleA = -1, settleN = -1, maxIA = 0, maxIN = 0, iaeA = 0, iaeN = 0;
+    int satCycles = 0;
+    for (int k = 0; k < (int)(150.0f / kDt); k++) {
+      uA = pidLawStep(p, r, pvA, 90.0f, 0.0f, uA, kDt, e);
+      if (uA >= 100.0f) satCycles++;
+      if (r.integral > maxIA) maxIA = r.integral;
+      pvA = aw.step(uA);
+      const float eN = 90.0f - pvN;
+      iN = pidClamp(iN + eN * kDt * p.Ki, -100.0f, 100.0f);
+      uN = pidClamp(p.Kp * eN + iN, 0.0f, 100.0f);
+      pvN = naive.step(uN);
+      if (iN > maxIN) maxIN = iN;
+      if (pvA - 90.0f > overA) overA = pvA - 90.0f;
+      if (pvN - 90.0f > overN) overN = pvN - 90.0f;
+      settleTrack(settleA, pvA - 90.0f, k);
+      settleTrack(settleN, pvN - 90.0f, k);
+      iaeA += fabsf(90.0f - pvA) * kDt;
+      iaeN += fabsf(90.0f - pvN) * kDt;
+    }
+    printf("  step 10->90 %%, anti-windup: %d saturated cycles, peak integral %.1f %%, overshoot %.2f %%, "
+           "settle %.1f s, IAE %.1f %%s\n", satCycles, maxIA, overA, settleA, iaeA);
+    printf("  step 10->90 %%, plain integrator: peak integral %.1f %%, overshoot %.2f %%, settle %.1f s, "
+           "IAE %.1f %%s\n", maxIN, overN, settleN, iaeN);
+    CHECK(satCycles > 20);
+    CHECK(maxIA < 90.0f + 0.5f);                                  // never above the 90 % it settles at
+    CHECK_NEAR(maxIN, 100.0, 1e-3);                               // plain one runs into its clamp
+    CHECK(overA < 0.5f);
+    CHECK(overN > 2.0f);
+    CHECK(settleA > 0 && settleA < 60.0f && settleN > 0);
+    // IAE is reported, not compared: the plain integrator's overshoot still
+    // crosses the band sooner, so the windup cost shows up in overshoot above.
+  }
+
+  // ---- feed-forward: a measured load of 20 % steps in at the actuator (it
+  //      goes through the same dead time). MBPV carries it as 0..10000 and the
+  //      FF path scales it as the firmware does: ffPct = ffGain * MBPV / 100.
+  //      ffGain 0.8 models a 20 % error in the load estimate. ----
+  {
+    float iae[2], settle[2], peak[2];
+    for (int ff = 0; ff < 2; ff++) {
+      PIDState p = law(2.5f, 0.25f, 0.0f, 1.0f, 0.0f);
+      p.ffSource = ff ? 1 : 0; p.ffGain = 0.8f;
+      Fopdt pl(1.0f, 10.0f, 2.0f, 50.0f);
+      PidRt r = {};
+      float pv = 50.0f, u = 50.0f, e;
+      iae[ff] = 0; settle[ff] = -1; peak[ff] = 0;
+      for (int k = 0; k < (int)(180.0f / kDt); k++) {
+        const bool  loaded = (k >= (int)(60.0f / kDt));
+        const float load   = loaded ? 20.0f : 0.0f;
+        const uint16_t mbpv = (uint16_t)(load * 100.0f);
+        const float ffPct  = (p.ffSource >= 1) ? p.ffGain * (float)mbpv / 100.0f : 0.0f;
+        u  = pidLawStep(p, r, pv, 50.0f, ffPct, u, kDt, e);
+        pv = pl.step(u - load);
+        if (!loaded) continue;
+        const int kk = k - (int)(60.0f / kDt);
+        iae[ff] += fabsf(50.0f - pv) * kDt;
+        if (50.0f - pv > peak[ff]) peak[ff] = 50.0f - pv;
+        settleTrack(settle[ff], pv - 50.0f, kk);
+      }
+      CHECK_NEAR(pv, 50.0, 0.05);                                 // integral removes the FF error
+    }
+    printf("  load step 20 %%, feedback only: dip %.2f %%, settle %.1f s, IAE %.1f %%s\n", peak[0], settle[0], iae[0]);
+    printf("  load step 20 %%, FF gain 0.8:   dip %.2f %%, settle %.1f s, IAE %.1f %%s\n", peak[1], settle[1], iae[1]);
+    CHECK(iae[1] < 0.35f * iae[0]);
+    CHECK(peak[1] < 0.35f * peak[0]);
+  }
+
+  // ---- cascade: loop 2 (outer, slow) drives loop 1's setpoint (spSource 6 =
+  //      PID2 OUT). The loops are indexed against their evaluation order, so
+  //      the inner one only sees the outer output of the same cycle if
+  //      pidEvalOrder() puts loop 2 first. Same per-cycle structure as pidStep().
+  //      Inner plant: flow, K 1, tau 1 s. Outer plant: temperature, fed by the
+  //      flow, K 1, tau 20 s, dead time 2 s. ----
+  {
+    PIDState cfg[4] = { law(0.8f, 1.5f, 0.0f, 1.0f, 0.0f), law(3.0f, 0.15f, 0.0f, 1.0f, 0.0f),
+                        law(0, 0, 0, 1, 0), law(0, 0, 0, 1, 0) };
+    cfg[0].spSource = 6; cfg[1].spSource = 0;
+    cfg[0].outMax = cfg[1].outMax = 100.0f;       // raw output = % so the inner SP reads it directly
+    cfg[2].enabled = cfg[3].enabled = false;
+    uint8_t order[4];
+    pidEvalOrder(cfg, order);
+    int posOuter = -1, posInner = -1;
+    for (int n = 0; n < 4; n++) { if (order[n] == 1) posOuter = n; if (order[n] == 0) posInner = n; }
+    CHECK(posOuter >= 0 && posInner > posOuter);
+
+    for (int pass = 0; pass < 2; pass++) {         // 0: pidEvalOrder(), 1: plain index order
+      const uint8_t idx[4] = { 0, 1, 2, 3 };
+      const uint8_t *ord = pass ? idx : order;
+      Fopdt flow(1.0f, 1.0f, 0.0f, 20.0f), temp(1.0f, 20.0f, 2.0f, 20.0f);
+      PidRt rt[4] = {};
+      float virtRaw[4] = { 20.0f, 20.0f, 0, 0 };
+      float pvFlow = 20.0f, pvTemp = 20.0f, iae = 0, settle = -1, e;
+      int sameCycle = 0, cycles = 0;
+      const float sp = 60.0f;
+      for (int k = 0; k < (int)(200.0f / kDt); k++) {
+        float newOut[4] = { virtRaw[0], virtRaw[1], virtRaw[2], virtRaw[3] };
+        float outerNow = -1.0f, innerSp = -1.0f;
+        for (int n = 0; n < 4; n++) {
+          const int i = ord[n];
+          if (!cfg[i].enabled) continue;
+          const float spRaw = (cfg[i].spSource >= 5) ? newOut[cfg[i].spSource - 5] : sp;
+          const float pv    = (i == 0) ? pvFlow : pvTemp;
+          const float u     = pidLawStep(cfg[i], rt[i], pv, spRaw, 0.0f, newOut[i], kDt, e);
+          newOut[i] = cfg[i].outMin + u / 100.0f * (cfg[i].outMax - cfg[i].outMin);
+          if (i == 1) outerNow = newOut[i];
+          if (i == 0) innerSp = spRaw;
+        }
+        cycles++;
+        if (innerSp == outerNow) sameCycle++;
+        for (int i = 0; i < 4; i++) virtRaw[i] = newOut[i];
+        pvFlow = flow.step(newOut[0]);
+        pvTemp = temp.step(pvFlow);
+        iae += fabsf(sp - pvTemp) * kDt;
+        settleTrack(settle, pvTemp - sp, k);
+      }
+      if (pass == 0) {
+        printf("  cascade 20->60 %%: inner SP = outer output of the same cycle in %d/%d cycles, "
+               "settle %.1f s, IAE %.1f %%s\n", sameCycle, cycles, settle, iae);
+        CHECK_EQ(sameCycle, cycles);
+        CHECK_NEAR(pvTemp, sp, 0.05);
+        CHECK(settle > 0 && settle < 120.0f);
+      } else {
+        printf("  cascade, index order: same-cycle in %d/%d cycles, IAE %.1f %%s\n", sameCycle, cycles, iae);
+        CHECK(sameCycle < cycles / 10);             // one-cycle lag whenever the outer output moves
+        // (against a 20 s outer plant that lag costs almost no IAE; the check is on the ordering)
+      }
+    }
+  }
+
+  // ---- derivative on measurement, first-order filter (Kd only, bumpless start at 50 %) ----
+  {
+    const float Kd = 1.0f, dTf = 1.0f;
+    const float alpha = kDt / (dTf + kDt);
+    float e;
+    PidRt rf = {}, ru = {};
+    const PIDState pf = law(0.0f, 0.0f, Kd, 1.0f, dTf), pu = law(0.0f, 0.0f, Kd, 1.0f, 0.0f);
+    CHECK_NEAR(pidLawStep(pf, rf, 40.0f, 40.0f, 0.0f, 50.0f, kDt, e), 50.0, 1e-5);   // bumpless
+    CHECK_NEAR(pidLawStep(pu, ru, 40.0f, 40.0f, 0.0f, 50.0f, kDt, e), 50.0, 1e-5);
+    // SP step alone: no derivative kick
+    CHECK_NEAR(pidLawStep(pf, rf, 40.0f, 70.0f, 0.0f, 0.0f, kDt, e), 50.0, 1e-5);
+    CHECK_NEAR(rf.dState, 0.0, 1e-6);
+    // PV step +10 %: raw derivative -50 %/s for one cycle
+    CHECK_NEAR(pidLawStep(pu, ru, 50.0f, 40.0f, 0.0f, 0.0f, kDt, e), 0.0, 1e-4);         // 50 - 50
+    CHECK_NEAR(pidLawStep(pu, ru, 50.0f, 40.0f, 0.0f, 0.0f, kDt, e), 50.0, 1e-4);
+    float d = 0.0f;
+    for (int k = 0; k < 10; k++) {
+      const float u = pidLawStep(pf, rf, 50.0f, 70.0f, 0.0f, 0.0f, kDt, e);
+      d += alpha * (((k == 0) ? -50.0f : 0.0f) - d);
+      CHECK_NEAR(rf.dState, d, 1e-4);
+      CHECK_NEAR(u, 50.0f + Kd * d, 1e-4);
+    }
+
+    // Measurement noise: the filter cuts the derivative's share of output noise
+    float sumU = 0, sumF = 0;
+    PidRt a = {}, b = {};
+    const PIDState nu = law(0.0f, 0.0f, 0.5f, 1.0f, 0.0f), nf = law(0.0f, 0.0f, 0.5f, 1.0f, 1.0f);
+    uint32_t s = 12345;
+    for (int k = 0; k < 500; k++) {
+      s = s * 1664525u + 1013904223u;
+      const float pv = 50.0f + ((float)(s >> 8) / 16777216.0f - 0.5f);               // +-0.5 %
+      const float u1 = pidLawStep(nu, a, pv, 50.0f, 0.0f, 50.0f, kDt, e) - 50.0f;
+      const float u2 = pidLawStep(nf, b, pv, 50.0f, 0.0f, 50.0f, kDt, e) - 50.0f;
+      if (k > 20) { sumU += u1 * u1; sumF += u2 * u2; }
+    }
+    printf("  derivative noise rms: unfiltered %.3f %%, dTf 1 s %.3f %%\n", sqrtf(sumU / 479), sqrtf(sumF / 479));
+    CHECK(sqrtf(sumF / 479) < 0.35f * sqrtf(sumU / 479));
+  }
+
+  return testResult("aio_pid_test");
+}
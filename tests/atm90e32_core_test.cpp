@@ -0,0 +1,162 @@
+// ATM90E32T driven against a mock register file: begin() setup writes (SagTh,
+// MMode0, PLconst, calibration), the SCK read-back fallback, a readSnapshot()
+// burst decoded end to end, clear-on-read energy, and the pure helpers
+// (s24/u24, mcFromPLconst, ticksToWh, sagThreshold).
+#include "host_test.h"
+#include <string.h>
+#include <ATM90E32Core.h>
+
+using namespace atm90::reg;
+
+// 0x00..0xFF register file. Reads at an SCK above maxHz return corrupted data,
+// like a marginal bus. Energy registers clear on read.
+struct MockChip {
+  uint16_t reg[0x100];
+  uint32_t maxHz;
+  uint32_t hz;
+  uint32_t us;
+  int      frames, transactions, writes;
+};
+
+struct MockBus {
+  MockChip *c;
+
+  void begin() {}
+  void beginTransaction(uint32_t hz) { c->hz = hz; c->transactions++; }
+  void endTransaction() {}
+  uint16_t frame(uint16_t addr, uint16_t val) {
+    c->frames++;
+    c->us += 4;
+    const uint8_t r = (uint8_t)(addr & 0xFF);
+    if (!(addr & 0x8000)) { c->reg[r] = val; c->writes++; return 0; }
+    uint16_t v = c->reg[r];
+    if (r >= APenergyT && r < APenergyT + kEnergyRegs) c->reg[r] = 0;
+    return (c->hz > c->maxHz) ? (uint16_t)(v ^ 0x0100) : v;
+  }
+  void     delayMs(uint32_t ms) { c->us += ms * 1000u; }
+  uint32_t nowUs()              { return c->us; }
+};
+
+static const M90PhaseCal kCal[3] = {
+  { 0x8000, 0x7FF0, 12, -3 }, { 0x8010, 0x7FE0, 0, 0 }, { 0x7FF8, 0x8008, -1, 4 }
+};
+
+static void mockReset(MockChip &c, uint32_t maxHz) {
+  memset(&c, 0, sizeof(c));
+  c.maxHz = maxHz;
+}
+
+// Put a value into an H/LSB register pair the way the chip holds it
+static void put24(MockChip &c, uint16_t h, uint16_t l, int32_t v32) {
+  c.reg[h] = (uint16_t)((uint32_t)v32 >> 16);
+  c.reg[l] = (uint16_t)((uint32_t)v32 & 0xFF00u);
+}
+
+int main() {
+  // ---- pure helpers ----
+  CHECK_NEAR(atm90::u24(23012, 0x8000), 23012.5, 1e-4);
+  CHECK_NEAR(atm90::u24(1, 0x00FF), 1.0, 1e-6);                 // low byte not significant
+  CHECK_NEAR(atm90::s24(0xFFFF, 0x8000), -0.5, 1e-6);
+  CHECK_NEAR(atm90::s24(0x8000, 0x0000), -32768.0, 1e-3);
+  CHECK_NEAR(atm90::s24(0x7FFF, 0xFF00), 32767.99609375, 1e-3);
+  CHECK_NEAR(atm90::s24(0x0000, 0x0100), 1.0 / 256.0, 1e-7);
+
+  CHECK_EQ(atm90::mcFromPLconst(0x0861C468u), 3200u);
+  CHECK_EQ(atm90::mcFromPLconst(0), 0u);
+  CHECK_EQ(atm90::mcFromPLconst(1), 0u);                         // > 10M imp/kWh
+  CHECK_EQ(atm90::mcFromPLconst(0xFFFFFFFFu), 104u);
+  CHECK_NEAR(atm90::ticksToWh(320, 3200), 1.0, 1e-12);           // 320 x 0.01 CF = 1 Wh at MC 3200
+  CHECK_NEAR(atm90::ticksToWh(1ULL << 40, 3200), 3435973836.8, 1e-3);
+  CHECK_NEAR(atm90::ticksToWh(1000, 0), 0.0, 1e-12);
+
+  CHECK_EQ(atm90::sagThreshold(50, 25256), 17431);               // 190 V sag
+  CHECK_EQ(atm90::sagThreshold(60, 25256), 8256);                // 90 V sag
+  CHECK_EQ(atm90::sagThreshold(55, 25256), atm90::sagThreshold(50, 25256));
+
+  // ---- begin(): setup writes land in the register file ----
+  MockChip chip;
+  mockReset(chip, 4000000);
+  ATM90E32T<MockBus> m(MockBus{ &chip }, 2000000);
+  m.begin(60, 1, 25256, kCal);
+  CHECK(!m.spiFallback());
+  CHECK_EQ(m.spiHz(), 2000000u);
+  CHECK_EQ(m.lineHz(), 60);
+  CHECK_EQ(chip.reg[SagTh], atm90::sagThreshold(60, 25256));
+  CHECK_EQ(chip.reg[MMode0], atm90::mmode0(60, 1));
+  CHECK_EQ(chip.reg[FreqHiTh], 6100);
+  CHECK_EQ(chip.reg[FreqLoTh], 5900);
+  CHECK_EQ(chip.reg[PLconstH], kPLconstH);
+  CHECK_EQ(chip.reg[PLconstL], kPLconstL);
+  CHECK_EQ(chip.reg[CfgRegAccEn], kCfgLock);                     // relocked after setup
+  CHECK_EQ(chip.reg[UgainA], kCal[0].Ugain);
+  CHECK_EQ(chip.reg[IgainC], kCal[2].Igain);
+  CHECK_EQ((int16_t)chip.reg[IoffsetA], kCal[0].Ioffset);
+  CHECK_EQ((int16_t)chip.reg[UoffsetC], kCal[2].Uoffset);
+  CHECK_EQ(m.readPLconst(), 0x0861C468u);
+
+  // ---- SCK too fast for the bus: PLconst read-back fails, drop to the safe clock ----
+  {
+    MockChip slow;
+    mockReset(slow, 1000000);
+    ATM90E32T<MockBus> f(MockBus{ &slow }, 8000000);
+    f.begin(50, 1, 25256, kCal);
+    CHECK(f.spiFallback());
+    CHECK_EQ(f.spiHz(), ATM90E32T<MockBus>::kSafeSpiHz);
+    CHECK_EQ(slow.hz, ATM90E32T<MockBus>::kSafeSpiHz);
+    CHECK_EQ(f.readPLconst(), 0x0861C468u);
+    CHECK_EQ(slow.reg[SagTh], atm90::sagThreshold(50, 25256));
+  }
+
+  // ---- readSnapshot(): one transaction, one frame per register, decoded ----
+  chip.reg[UrmsA] = 23012; chip.reg[UrmsALSB] = 0x8000;
+  chip.reg[IrmsA] = 4345;  chip.reg[IrmsALSB] = 0x8000;
+  put24(chip, PmeanA, PmeanALSB, 3125000);                       // 1000 W
+  put24(chip, PmeanT, PmeanTLSB, 3125000 / 4);
+  put24(chip, QmeanA, QmeanALSB, -9375);                         // -3 var
+  chip.reg[PFmeanA] = 1000;
+  chip.reg[PAngleA] = (uint16_t)-12;
+  chip.reg[Freq] = 5998;
+  chip.reg[Temp] = (uint16_t)-5;
+  chip.reg[EMMState0] = 0x4000;
+  chip.reg[CRCErrStatus] = 0x0001;
+
+  MeterSnapshot s;
+  const int tr0 = chip.transactions, fr0 = chip.frames;
+  m.readSnapshot(s);
+  CHECK_EQ(chip.transactions - tr0, 1);
+  CHECK_EQ(chip.frames - fr0, (int)kSnapN);
+  CHECK_EQ(s.read_us, kSnapN * 4);
+  CHECK_EQ(s.t_us, chip.us);
+  CHECK_NEAR(s.Urms_V[0], 230.125, 1e-3);
+  CHECK_NEAR(s.Irms_A[0], 4.3455, 1e-4);
+  CHECK_NEAR(s.P_W[0], 1000.0, 0.1);
+  CHECK_NEAR(s.P_W[3], 1000.0, 0.5);                             // T LSB low byte dropped: up to 255 x 1.28 mW
+  CHECK_NEAR(s.Q_var[0], -3.0, 0.1);
+  CHECK_EQ(s.PFmean[0], 1000);
+  CHECK_EQ(s.PAngle[0], -12);
+  CHECK_EQ(s.Freq_x100, 5998);
+  CHECK_EQ(s.TempC, -5);
+  CHECK_EQ(s.diag.EMMState0, 0x4000);
+  CHECK_EQ(s.diag.CRCErrStatus, 0x0001);
+
+  // ---- energy burst: T,A,B,C order, clear-on-read ----
+  for (int i = 0; i < kEnergyRegs; i++) chip.reg[APenergyT + i] = (uint16_t)(100 + i);
+  uint16_t e[ATM90E32T<MockBus>::kEnergyRegs];
+  m.readEnergyRegs(e);
+  CHECK_EQ(e[0], 100);
+  CHECK_EQ(e[19], 119);
+  CHECK_NEAR(atm90::ticksToWh(e[1], atm90::mcFromPLconst(m.readPLconst())), 101 * 10.0 / 3200.0, 1e-12);
+  m.readEnergyRegs(e);
+  CHECK_EQ(e[0], 0);
+  CHECK_EQ(e[19], 0);
+
+  // ---- interrupt clear and diag ----
+  m.clearIntState(0x0003, 0);
+  CHECK_EQ(chip.reg[EMMIntState0], 0x0003);
+  CHECK_EQ(chip.reg[CfgRegAccEn], kCfgLock);
+  const M90DiagRegs d = m.readDiag();
+  CHECK_EQ(d.EMMState0, 0x4000);
+  CHECK_EQ(d.CRCErrStatus, 0x0001);
+
+  return testResult("atm90e32_core_test");
+}
@@ -0,0 +1,91 @@
+// ATM90E32 snapshot decode against a SYNTHETIC register dump: hand-built for
+// phase A feeding a 1 kW resistive heater at 230 V, phases B/C at no load, in
+// kSnapRegs order. It is not a capture from a module. Its P/Q/S words were
+// derived with the same 0.00032 W/count constant the decoder uses, so the
+// power scale checks only cover the decode plumbing (H:LSB assembly, sign
+// extension, the dropped LSB byte), not the constant itself. The checks that
+// do not depend on the constants are P ~ Urms * Irms * PF on the loaded phase,
+// S ~ Urms * Irms, and T == A + B + C. No captured dump with reference-meter
+// readings is in the tree yet.
+// Also times decodeSnapshot() on the host (reported, not checked).
+#include "host_test.h"
+#include <chrono>
+#include <ATM90E32Core.h>
+
+using namespace atm90::reg;
+
+static const uint16_t kSynth1kW[kSnapN] = {
+  // Urms A,B,C (H, LSB)        230.125 / 229.870 / 230.310 V
+  23012, 0x8000,  22987, 0x0000,  23031, 0x0000,
+  // Irms A,B,C                  4.3455 / 0.012 / 0.011 A
+  4345, 0x8000,   12, 0x0000,     11, 0x0000,
+  // Pmean A,B,C,T: A = 3125000 counts (1000.0 W), B/C ~0, T = (A+B+C)/4
+  0x002F, 0xAF08,  0x0000, 0x0C00,  0xFFFF, 0xF800,  0x000B, 0xECC2,
+  // Qmean A,B,C,T: A = -9375 counts (-3.0 var)
+  0xFFFF, 0xDB61,  0x0000, 0x0000,  0x0000, 0x0000,  0xFFFF, 0xF6D8,
+  // Smean A,B,C,T
+  0x002F, 0xB522,  0x0000, 0x2000,  0x0000, 0x1C00,  0x000B, 0xFC48,
+  // Pfund A,B,C,T (998.0 W on A) and Pharm (2.0 W)
+  0x002F, 0x969E,  0x0000, 0x0000,  0x0000, 0x0000,  0x000B, 0xE5A7,
+  0x0000, 0x186A,  0x0000, 0x0000,  0x0000, 0x0000,  0x0000, 0x061A,
+  // THD+N U A,B,C; I A,B,C (0.01 %)
+  182, 175, 190,  95, 0, 0,
+  // PFmean A,B,C,T (0.001), phase angle A,B,C (0.1 deg)
+  1000, 0, 0, 1000,  3, 0, 0,
+  // Freq (0.01 Hz), Temp (deg C)
+  5001, 31,
+  // EMMState0/1, EMMIntState0/1, CRCErrStatus, LastSPIData
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+};
+
+int main() {
+  MeterSnapshot s;
+  atm90::decodeSnapshot(kSynth1kW, s);
+
+  CHECK_NEAR(s.Urms_V[0], 230.125, 1e-3);
+  CHECK_NEAR(s.Urms_V[1], 229.87,  1e-3);
+  CHECK_NEAR(s.Irms_A[0], 4.3455,  1e-4);
+
+  // 0.00032 W per count of H:LSB -> 20.97 W per H LSB; LSB low byte is not significant
+  CHECK_NEAR(atm90::kPowPhaseLsb, 20.97152, 1e-4);
+  CHECK_NEAR(s.P_W[0], 1000.0, 0.1);
+  CHECK_NEAR(s.Q_var[0], -3.0, 0.1);
+  CHECK_NEAR(s.S_VA[0], 1000.5, 0.1);
+  CHECK_NEAR(s.Pfund_W[0], 998.0, 0.1);
+  CHECK_NEAR(s.Pharm_W[0], 2.0, 0.1);
+  CHECK_NEAR(s.P_W[1], 0.98, 0.01);
+  CHECK_NEAR(s.P_W[2], -0.66, 0.01);
+
+  // independent of the power constants
+  const double ui = (double)s.Urms_V[0] * s.Irms_A[0];
+  CHECK_NEAR(s.P_W[0], ui * s.PFmean[0] / 1000.0, 2.0);
+  CHECK_NEAR(s.S_VA[0], ui, 2.0);
+  CHECK_NEAR(s.P_W[3], s.P_W[0] + s.P_W[1] + s.P_W[2], 0.5);
+  CHECK_NEAR(s.S_VA[3], s.S_VA[0] + s.S_VA[1] + s.S_VA[2], 0.5);
+  CHECK_NEAR(s.Pfund_W[3] + s.Pharm_W[3], s.P_W[3], 0.5);
+
+  CHECK_EQ(s.Freq_x100, 5001);
+  CHECK_EQ(s.TempC, 31);
+  CHECK_EQ(s.THDN_U[0], 182);
+  CHECK_EQ(s.PFmean[3], 1000);
+  CHECK_EQ(s.PAngle[0], 3);
+
+  // Host benchmark: decode cost per 73-register snapshot
+  {
+    const int kIter = 200000;
+    uint16_t regs[kSnapN];
+    for (int i = 0; i < kSnapN; i++) regs[i] = kSynth1kW[i];
+    double sink = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < kIter; k++) {
+      regs[0] = (uint16_t)(23000 + (k & 63));          // defeat hoisting
+      atm90::decodeSnapshot(regs, s);
+      sink += s.Urms_V[0] + s.P_W[3];
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    printf("atm90e32_decode_test: decodeSnapshot %.1f ns/snapshot on the host (%d iterations, sink %.0f)\n",
+           ns / kIter, kIter, sink);
+  }
+
+  return testResult("atm90e32_decode_test");
+}
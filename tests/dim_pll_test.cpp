@@ -0,0 +1,202 @@
+// DIM-420 zero-cross replay: a mains stream drifting 50.3 -> 49.7 Hz with
+// 20 us RMS detector jitter, dropped edges and glitch edges, run through the
+// same PLL + gate-timer logic as the firmware (pllEdge on every edge, one
+// pllGateStep per timer callback). Checks that once locked every true crossing
+// gets exactly one gate, timed from the prediction rather than the raw edge,
+// and that while (re)acquiring the edge-referenced fallback keeps gating: after
+// a noise burst over live mains, and on a channel too jittery to ever lock.
+#include "host_test.h"
+#include <vector>
+#include <algorithm>
+#include <zc_pll.h>
+
+static const uint32_t kLeadUs = 100;   // GATE_ALARM_LEAD_US
+
+struct Rng {
+  uint64_t s;
+  uint32_t next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return (uint32_t)(s >> 32); }
+  double   uni()  { return (next() + 0.5) / 4294967296.0; }
+  double   gauss(){ return sqrt(-2.0 * log(uni())) * cos(6.283185307179586 * uni()); }
+};
+
+struct Stream { std::vector<uint64_t> truth, edges; int dropped, glitches; };
+
+static Stream makeStream(int n, double jitterUs, double dropP, double glitchP, uint64_t seed) {
+  Stream st; st.dropped = st.glitches = 0;
+  Rng r = { seed };
+  double t = 1000000.0;
+  for (int k = 0; k < n; k++) {
+    const double hz = 50.3 - 0.6 * k / n;
+    t += 1e6 / (2.0 * hz);
+    st.truth.push_back((uint64_t)t);
+    if (k > 40 && r.uni() < dropP) st.dropped++;
+    else st.edges.push_back((uint64_t)(t + jitterUs * r.gauss()));
+    if (k > 40 && r.uni() < glitchP) { st.edges.push_back((uint64_t)(t + 2000.0 + 5000.0 * r.uni())); st.glitches++; }
+  }
+  std::sort(st.edges.begin(), st.edges.end());
+  return st;
+}
+
+struct Gate { uint64_t c; };
+
+// Event loop equivalent to zc_isr_common() + gate_alarm_cb()
+// edgeFallback = false models gating only while locked (the timer path alone)
+static std::vector<Gate> run(const std::vector<uint64_t>& edges, uint64_t endUs, uint32_t* rejects,
+                             bool edgeFallback = true, int* lockedEdges = nullptr) {
+  volatile ZcPll p = {};
+  std::vector<Gate> gates;
+  bool armed = false; uint64_t at = 0;
+  size_t i = 0;
+  *rejects = 0;
+  for (;;) {
+    const bool edgeNext = i < edges.size() && (!armed || edges[i] < at);
+    if (edgeNext) {
+      const uint64_t t = edges[i++];
+      if (!pllEdge(p, t)) { (*rejects)++; continue; }
+      if (lockedEdges && p.locked) (*lockedEdges)++;
+      if (armed) continue;
+      if (edgeFallback && pllEdgeGateOk(p)) gates.push_back({ t });                     // acquiring: gate from the edge
+      if (pllGateOk(p, p.nextUs)) { armed = true; at = p.nextUs - kLeadUs; }
+    } else if (armed) {
+      if (at > endUs) break;
+      uint64_t c, next;
+      if (!pllGateStep(p, at, kLeadUs, c, next)) { armed = false; continue; }
+      CHECK(next > at);
+      gates.push_back({ c });
+      at = next;
+    } else {
+      break;
+    }
+  }
+  return gates;
+}
+
+static size_t nearest(const std::vector<uint64_t>& v, uint64_t t) {
+  size_t k = std::lower_bound(v.begin(), v.end(), t) - v.begin();
+  if (k == v.size() || (k > 0 && t - v[k - 1] < v[k] - t)) k--;
+  return k;
+}
+
+// Gates per true crossing from index 'from'; longest run of ungated crossings
+struct Coverage { int missing, doubled, maxGap; };
+static Coverage coverage(const std::vector<uint64_t>& truth, const std::vector<Gate>& gates, size_t from) {
+  std::vector<int> per(truth.size(), 0);
+  for (const Gate& g : gates) per[nearest(truth, g.c)]++;
+  Coverage cv = { 0, 0, 0 };
+  int run = 0;
+  for (size_t k = from; k + 1 < truth.size(); k++) {
+    if (per[k] == 0) { cv.missing++; if (++run > cv.maxGap) cv.maxGap = run; } else run = 0;
+    if (per[k] > 1) cv.doubled++;
+  }
+  return cv;
+}
+
+int main() {
+  const int N = 3000;                                     // 30 s of half-cycles
+  const Stream st = makeStream(N, 20.0, 0.02, 0.02, 0x2545F4914F6CDD1DULL);
+  uint32_t rejects = 0;
+  const std::vector<Gate> gates = run(st.edges, st.truth.back() + 1, &rejects);
+
+  // every crossing after the first 100 (lock + settle) gets exactly one gate
+  std::vector<int> perCrossing(N, 0);
+  double sum2 = 0; double maxErr = 0; int n = 0;
+  for (const Gate& g : gates) {
+    const size_t k = nearest(st.truth, g.c);
+    perCrossing[k]++;
+    if (k < 100) continue;
+    const double e = (double)(int64_t)(g.c - st.truth[k]);
+    sum2 += e * e; n++;
+    if (fabs(e) > maxErr) maxErr = fabs(e);
+  }
+  int missing = 0, doubled = 0;
+  for (int k = 100; k < N - 1; k++) { if (perCrossing[k] == 0) missing++; if (perCrossing[k] > 1) doubled++; }
+  const double rms = sqrt(sum2 / (n ? n : 1));
+
+  // raw-edge triggering for reference: error of each real edge, plus extra/missing gates
+  double rawSum2 = 0; int rawN = 0;
+  for (uint64_t e : st.edges) {
+    const size_t k = nearest(st.truth, e);
+    const double d = (double)(int64_t)(e - st.truth[k]);
+    if (k >= 100 && fabs(d) < 1000) { rawSum2 += d * d; rawN++; }
+  }
+  printf("dim_pll_test: %d crossings, %d dropped, %d glitches, %u rejected\n", N, st.dropped, st.glitches, rejects);
+  printf("  predicted gate: rms %.1f us, max %.1f us, missing %d, doubled %d\n", rms, maxErr, missing, doubled);
+  printf("  raw-edge gate:  rms %.1f us, missing %d, extra %d\n", sqrt(rawSum2 / rawN), st.dropped, st.glitches);
+
+  CHECK(st.dropped > 20);
+  CHECK(st.glitches > 20);
+  CHECK_EQ(missing, 0);                                   // dropped edges still gated
+  CHECK_EQ(doubled, 0);                                   // glitches never fire a gate
+  CHECK_EQ((int)rejects, st.glitches);
+  CHECK(rms < 15.0);                                      // below the 20 us detector jitter
+  CHECK(maxErr < 60.0);
+
+  // Edges stop: the timer coasts PLL_COAST_N half-cycles, then stops
+  {
+    std::vector<uint64_t> cut(st.edges.begin(), st.edges.begin() + 500);
+    const uint64_t lastEdge = cut.back();
+    const std::vector<Gate> g = run(cut, lastEdge + 1000000, &rejects);
+    int after = 0;
+    for (const Gate& x : g) if (x.c > lastEdge + 500) after++;
+    CHECK_EQ(after, PLL_COAST_N);
+  }
+
+  // Lost lock on a burst of noise: gates stop, then resume after relock
+  {
+    std::vector<uint64_t> e(st.edges.begin(), st.edges.begin() + 600);
+    const uint64_t t0 = e.back();
+    Rng r = { 7 };
+    for (int k = 0; k < 40; k++) e.push_back(t0 + 20000 + (uint64_t)(r.uni() * 400000.0));
+    std::sort(e.begin(), e.end());
+    const uint64_t resume = t0 + 500000;
+    for (uint64_t t = resume; t < resume + 2000000; t += 10000) e.push_back(t);
+    const std::vector<Gate> g = run(e, resume + 2000000, &rejects);
+    int inNoise = 0, resumed = 0;
+    for (const Gate& x : g) {
+      if (x.c > t0 + 200000 && x.c < resume) inNoise++;
+      if (x.c > resume + 1000000) resumed++;
+    }
+    CHECK_EQ(inNoise, 0);
+    CHECK(resumed >= 95);
+  }
+
+  // Noise burst over live mains: 60 ms of dense glitch edges unlocks the PLL.
+  // Gating only while locked would go dark until PLL_LOCK_N clean edges have
+  // relocked it; the edge fallback resumes after PLL_ACQ_N plausible intervals.
+  {
+    Stream m = makeStream(800, 20.0, 0.0, 0.0, 0x9E3779B97F4A7C15ULL);
+    const uint64_t b0 = m.truth[400] + 3000;
+    Rng r = { 11 };
+    for (int k = 0; k < 60; k++) m.edges.push_back(b0 + (uint64_t)(r.uni() * 60000.0));
+    std::sort(m.edges.begin(), m.edges.end());
+    const std::vector<Gate> g  = run(m.edges, m.truth.back() + 1, &rejects);
+    const std::vector<Gate> g0 = run(m.edges, m.truth.back() + 1, &rejects, false);
+    const Coverage cv = coverage(m.truth, g, 100), cv0 = coverage(m.truth, g0, 100);
+    const int burstHalves = 6;                            // 60 ms
+    printf("  noise burst %d half-cycles: longest gap %d (locked-only gating %d), missing %d, doubled %d\n",
+           burstHalves, cv.maxGap, cv0.maxGap, cv.missing, cv.doubled);
+    CHECK(cv0.maxGap >= burstHalves + PLL_LOCK_N - 1);   // the blackout this fixes
+    CHECK(cv.maxGap <= burstHalves + PLL_ACQ_N + 1);      // burst + PLL_ACQ_N clean intervals
+    CHECK_EQ(cv.missing, cv.maxGap);                      // only the one gap
+    CHECK_EQ(cv.doubled, 0);
+  }
+
+  // Detector jitter above PLL_LOCK_US: the PLL is unlocked most of the time,
+  // the edge fallback still gates (nearly) every crossing once
+  {
+    const Stream j = makeStream(1000, 400.0, 0.0, 0.0, 0xD1B54A32D192ED03ULL);
+    int locked = 0;
+    const std::vector<Gate> g  = run(j.edges, j.truth.back() + 1, &rejects, true, &locked);
+    const std::vector<Gate> g0 = run(j.edges, j.truth.back() + 1, &rejects, false);
+    const Coverage cv = coverage(j.truth, g, 100), cv0 = coverage(j.truth, g0, 100);
+    printf("  400 us RMS jitter: locked on %d/%d edges, missing %d (locked-only gating %d), doubled %d, longest gap %d\n",
+           locked, (int)j.edges.size(), cv.missing, cv0.missing, cv.doubled, cv.maxGap);
+    CHECK(locked < (int)j.edges.size() / 10);
+    CHECK(cv0.missing > 800);
+    CHECK(cv.missing <= 5);
+    CHECK(cv.maxGap <= PLL_ACQ_N + 1);
+    CHECK_EQ(cv.doubled, 0);
+  }
+
+  return testResult("dim_pll_test");
+}
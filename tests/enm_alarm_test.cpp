@@ -0,0 +1,89 @@
+// ENM-223 alarm engine replay: recorded L1 voltage snapshots (100 ms meter tick)
+// fed through alarmMetricValue()/alarmStep() at several clock origins, including
+// one where the sequence straddles the millis() wrap and one where it straddles
+// the 32-bit micros() wrap that the bus timestamp (MeterSnapshot.t_us) hits.
+#include "host_test.h"
+#include <string.h>
+#include <enm_alarm.h>
+
+// Urms L1 [V] per snapshot: nominal, 1.2 s sag to ~200 V, a sample inside the
+// hysteresis band, a one-sample glitch shorter than onDelay, then recovery.
+static const float kRecL1[] = {
+  230.4f, 230.1f, 229.8f, 230.2f, 230.0f,                   //  0..4   nominal
+  201.3f, 199.8f, 200.4f, 200.9f, 201.7f, 200.2f,           //  5..10  sag
+  199.6f, 200.1f, 201.0f, 200.5f, 199.9f, 200.7f,           // 11..16
+  207.9f,                                                   // 17     in [min, min+hyst): still raised
+  229.7f, 230.3f, 230.1f, 229.9f, 230.4f, 230.0f,           // 18..23 recovery
+  230.2f, 229.8f, 230.1f, 230.3f, 230.0f, 229.9f,           // 24..29
+  230.1f, 204.0f, 230.2f, 229.9f, 230.0f, 230.1f,           // 30..35 31: single-sample glitch
+};
+static const int kRecN = sizeof(kRecL1) / sizeof(kRecL1[0]);
+static const uint32_t kTickMs = 100;
+
+struct Replay { int onAt; int offAt; int changes; };
+
+// Replays kRecL1 with the meter clock starting at t0Ms; returns the sample
+// indices where the alarm went active / inactive.
+static Replay replay(uint32_t t0Ms, bool ack) {
+  const AlarmRule r = { true, (uint8_t)AM_VOLTAGE, 20700, 25300, 200, 500, 1000 };
+  AlarmRuntime rt = { false, false, false, false, 0 };
+  Replay out = { -1, -1, 0 };
+  for (int i = 0; i < kRecN; i++) {
+    MeterSnapshot m;
+    memset(&m, 0, sizeof(m));
+    m.Urms_V[0] = m.Urms_V[1] = m.Urms_V[2] = kRecL1[i];
+    const uint32_t nowMs = t0Ms + (uint32_t)i * kTickMs;
+    m.t_us = nowMs * 1000u;                      // bus clock wraps independently; not used for delays
+    if (alarmStep(r, rt, ack, alarmMetricValue(CH_L1, r.metric, m), nowMs)) {
+      out.changes++;
+      if (rt.active && out.onAt < 0) out.onAt = i;
+      if (!rt.active && out.offAt < 0) out.offAt = i;
+    }
+  }
+  return out;
+}
+
+int main() {
+  // Reference run. Sag starts at sample 5, onDelay 500 ms -> active at sample 10.
+  // Recovery starts at 18, offDelay 1000 ms -> inactive at 28. The glitch at 31
+  // never reaches onDelay.
+  const Replay ref = replay(0, false);
+  CHECK_EQ(ref.onAt, 10);
+  CHECK_EQ(ref.offAt, 28);
+  CHECK_EQ(ref.changes, 2);
+
+  // Same sequence straddling the millis() wrap (edge at -300 ms, release after it).
+  const Replay wrapMs = replay(0xFFFFFFFFu - 799u, false);
+  CHECK_EQ(wrapMs.onAt, ref.onAt);
+  CHECK_EQ(wrapMs.offAt, ref.offAt);
+  CHECK_EQ(wrapMs.changes, ref.changes);
+
+  // Straddling the point where micros() wraps (2^32 us = 4294967.296 ms). The old
+  // code derived nowMs from t_us / 1000 and saw a ~4.29e6 ms jump here, which
+  // released the off-delay instantly; millis() is continuous.
+  const Replay wrapUs = replay(4294967u - 1500u, false);
+  CHECK_EQ(wrapUs.onAt, ref.onAt);
+  CHECK_EQ(wrapUs.offAt, ref.offAt);
+
+  // Old time base for comparison: nowMs = (uint32_t)micros() / 1000 across the
+  // micros wrap breaks the off-delay (documents why alarmsEvaluate takes millis()).
+  {
+    const AlarmRule r = { true, (uint8_t)AM_VOLTAGE, 20700, 25300, 200, 500, 1000 };
+    AlarmRuntime rt = { true, true, false, false, 0 };
+    const uint32_t t0us = 0xFFFFFFFFu - 150000u;     // 150 ms before the wrap
+    MeterSnapshot m;
+    memset(&m, 0, sizeof(m));
+    m.Urms_V[0] = 230.0f;
+    alarmStep(r, rt, false, alarmMetricValue(CH_L1, r.metric, m), t0us / 1000u);
+    alarmStep(r, rt, false, alarmMetricValue(CH_L1, r.metric, m), (uint32_t)(t0us + 200000u) / 1000u);
+    CHECK(!rt.active);                               // cleared after 200 ms instead of 1000 ms
+  }
+
+  // Ack-required: stays latched after recovery until acknowledged.
+  const Replay latched = replay(0xFFFFFFFFu - 799u, true);
+  CHECK_EQ(latched.onAt, ref.onAt);
+  CHECK_EQ(latched.offAt, -1);
+  CHECK_EQ(latched.changes, 1);
+
+  return testResult("enm_alarm_test");
+}
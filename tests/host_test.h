@@ -0,0 +1,22 @@
+// ================================================
+// File: host_test.h
+// Minimal check macros for the host tests (no framework dependency)
+// ================================================
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static int g_fail = 0;
+
+#define CHECK(c) do { if (!(c)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #c); g_fail++; } } while (0)
+#define CHECK_EQ(a, b) do { long long _a = (long long)(a), _b = (long long)(b); \
+  if (_a != _b) { printf("%s:%d: %s == %s failed (%lld vs %lld)\n", __FILE__, __LINE__, #a, #b, _a, _b); g_fail++; } } while (0)
+#define CHECK_NEAR(a, b, tol) do { double _a = (double)(a), _b = (double)(b); \
+  if (fabs(_a - _b) > (tol)) { printf("%s:%d: %s ~ %s failed (%.6g vs %.6g)\n", __FILE__, __LINE__, #a, #b, _a, _b); g_fail++; } } while (0)
+
+static inline int testResult(const char* name) {
+  if (g_fail) { printf("%s: %d failure(s)\n", name, g_fail); return 1; }
+  printf("%s: OK\n", name);
+  return 0;
+}
@@ -0,0 +1,116 @@
+// WLD-521 pulse capture replay: a 2 kHz meter signal with contact bounce on
+// both edges, fed edge by edge through pulseEdge()/pulsePush() as the GPIO ISR
+// does, while the loop() consumer drains every 1 ms except for one 400 ms
+// stall (longer than the 256-entry ring holds at 2 kHz). The same signal also
+// drives a non-counter input, which must neither count nor reject.
+#include "host_test.h"
+#include <vector>
+#include <algorithm>
+#include <pulse_capture.h>
+
+struct Edge { uint32_t t; uint8_t di; bool level; };
+
+static const uint32_t kPeriodUs = 500;          // 2 kHz
+static const uint32_t kGlitchUs = 100;
+static const uint32_t kRunUs    = 3000000;
+static const uint32_t kStallAt  = 1200000, kStallUs = 400000;
+
+// Square wave, 50 % duty; every 7th rising edge and every 11th falling edge
+// bounce once (5 us the wrong way). Returns the number of bounce pulses.
+static int makeSignal(std::vector<Edge> &e, uint8_t di, uint32_t t0, int *pulses) {
+  int bounces = 0; *pulses = 0;
+  for (uint32_t k = 0; (k + 1) * kPeriodUs < kRunUs; k++) {
+    const uint32_t t = t0 + k * kPeriodUs;
+    e.push_back({ t, di, true });
+    (*pulses)++;
+    if (k % 7 == 3) { e.push_back({ t + 5, di, false }); e.push_back({ t + 10, di, true }); bounces++; }
+    const uint32_t f = t + kPeriodUs / 2;
+    e.push_back({ f, di, false });
+    if (k % 11 == 5) { e.push_back({ f + 5, di, true }); e.push_back({ f + 10, di, false }); bounces++; }
+  }
+  return bounces;
+}
+
+struct Consumer {
+  uint32_t count = 0, lastUs = 0, maxPer = 0, minPer = 0xFFFFFFFFu, gaps = 0;
+  bool     have = false, gap = false;
+  void pulse(uint32_t t) {                       // onFlowPulse() period bookkeeping
+    if (have && !gap) {
+      const uint32_t per = t - lastUs;
+      if (per > maxPer) maxPer = per;
+      if (per < minPer) minPer = per;
+    }
+    have = true; gap = false; lastUs = t; count++;
+  }
+};
+
+struct Result { Consumer c[2]; uint32_t rejects[2], counts[2], drops; };
+
+static Result replay(uint32_t t0, bool signalGaps) {
+  std::vector<Edge> e;
+  int pulses = 0;
+  makeSignal(e, 0, t0, &pulses);
+  makeSignal(e, 1, t0 + 37, &pulses);
+  std::stable_sort(e.begin(), e.end(), [t0](const Edge &a, const Edge &b) { return a.t - t0 < b.t - t0; });
+
+  static PulseRing ring;
+  ring.head = ring.tail = 0;
+  volatile PulseIn in[2] = {};
+  in[0].idleSinceUs = in[1].idleSinceUs = t0 - 1000;
+  uint32_t dropsSeen[2] = { 0, 0 };
+  const bool counting[2] = { true, false };   // DI1 water counter, DI2 leak sensor
+
+  Result r = {};
+  auto drain = [&]() {
+    pulseDrain(ring, in, dropsSeen, 2,
+               [&](uint8_t i, uint32_t t) { r.c[i].pulse(t); },
+               [&](uint8_t i) { r.c[i].gaps++; if (signalGaps) r.c[i].gap = true; });
+  };
+  uint32_t nextDrain = t0 + 1000;
+  for (const Edge &x : e) {
+    while ((int32_t)(x.t - nextDrain) >= 0) {
+      drain();
+      const uint32_t rel = nextDrain - t0;
+      nextDrain += (rel >= kStallAt && rel < kStallAt + 1000) ? kStallUs : 1000;
+    }
+    if (pulseEdge(in[x.di], x.level, x.t, kGlitchUs, counting[x.di])) pulsePush(ring, in[x.di], x.di, x.t);
+  }
+  drain();
+  for (int i = 0; i < 2; i++) { r.rejects[i] = in[i].rejects; r.counts[i] = in[i].count; }
+  r.drops = in[0].drops;
+  return r;
+}
+
+int main() {
+  std::vector<Edge> probe;
+  int pulses = 0;
+  const int bounces = makeSignal(probe, 0, 0, &pulses);
+
+  // Clock origins: boot, and straddling the 32-bit time_us_32() wrap mid-stall
+  const uint32_t origins[2] = { 1000000u, 0xFFFFFFFFu - kStallAt - 200000u };
+  for (uint32_t t0 : origins) {
+    const Result r = replay(t0, true);
+    printf("wld_pulse_test t0=%u: %d pulses, %d bounces, counted %u, rejected %u, ring drops %u, "
+           "period %u..%u us\n", t0, pulses, bounces, r.counts[0], r.rejects[0], r.drops,
+           r.c[0].minPer, r.c[0].maxPer);
+
+    CHECK_EQ((int)r.counts[0], pulses);          // ISR count is authoritative across the stall
+    CHECK_EQ((int)r.rejects[0], bounces);        // every bounce rejected, nothing else
+    CHECK(r.drops > 0);                          // the stall did overflow the ring
+    CHECK_EQ(r.c[0].count + r.drops, r.counts[0]);
+    CHECK_EQ(r.c[0].gaps, 1u);
+    CHECK(r.c[0].minPer >= kPeriodUs - 1 && r.c[0].maxPer <= kPeriodUs + 1);   // no hole read as a period
+
+    CHECK_EQ(r.counts[1], 0u);                   // non-counter input: level tracked only
+    CHECK_EQ(r.rejects[1], 0u);
+    CHECK_EQ(r.c[1].count, 0u);
+  }
+
+  // Without the gap signal the estimator would have taken the stall hole as one
+  // period of ~270 ms, dragging the averaged rate far below 2 kHz.
+  const Result old = replay(origins[0], false);
+  printf("  without gap restart: max period %u us\n", old.c[0].maxPer);
+  CHECK(old.c[0].maxPer > 100000);
+
+  return testResult("wld_pulse_test");
+}